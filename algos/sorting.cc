@@ -1,11 +1,14 @@
 #include <cmath>
 #include <cstddef>
+#include <ctime>
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <stack>
 #include <algorithm>
 #include "../test_helpers.h"
 #include "../structures/heap.h"
+#include "../structures/vector.h"
 
 template<class T, class ArrayLike>
 void sort_insertion(ArrayLike& v) {
@@ -166,6 +169,23 @@ void test_sort(TestHelper& th, std::function<void(std::vector<int>&)> my_sort) {
   th.tassert();
 }
 
+// same as test_sort, but sorting Vector storage in place
+void test_sort_in_place(TestHelper& th, std::function<void(Vector<int>&)> my_sort) {
+  th.message("Testing on random Vectors");
+  for(auto i = 0; i < 2000; ++i) {
+    Vector<int> v;
+    v.resize(std::rand() % 1000);
+    std::generate(v.begin(), v.end(), std::rand);
+    std::vector<int> vtest(v.begin(), v.end());
+    std::sort(vtest.begin(), vtest.end());
+    const int* storage = v.data();
+    my_sort(v);
+    th.tassert(std::equal(v.begin(), v.end(), vtest.begin()), true, "Vector equality", true);
+    th.tassert(v.data() == storage, true, "Sorted in place", true);
+  }
+  th.tassert();
+}
+
 int main(int argc, char const *argv[]) {
   TestHelper th;
   std::srand((unsigned int)std::time(0));
@@ -188,6 +208,15 @@ int main(int argc, char const *argv[]) {
   std::cout << "\n[[ Heap Sort ]]" << std::endl << std::endl;
   test_sort(th, sort_heap<int, std::vector<int>>);
 
+  std::cout << "\n[[ Quick Sort (Vector) ]]" << std::endl << std::endl;
+  test_sort_in_place(th, sort_quick<int, Vector<int>>);
+
+  std::cout << "\n[[ Merge Sort (Vector) ]]" << std::endl << std::endl;
+  test_sort_in_place(th, sort_merge<int, Vector<int>>);
+
+  std::cout << "\n[[ Heap Sort (Vector) ]]" << std::endl << std::endl;
+  test_sort_in_place(th, sort_heap<int, Vector<int>>);
+
   th.summary();
   return 0;
 }
@@ -0,0 +1,49 @@
+#ifndef __BENCH_HELPERS__
+#define __BENCH_HELPERS__
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+
+class BenchHelper {
+public:
+  BenchHelper(unsigned int repetitions = 5) : _repetitions(repetitions) { }
+
+  void message(const char *message) const {
+    std::cout << message << "... ";
+  }
+
+  // runs f() several times and reports the best wall-clock time,
+  // which is the least noisy estimate on a shared machine
+  template<typename F>
+  double run(const char *name, F f) const {
+    double best = std::numeric_limits<double>::max();
+    for(unsigned int i = 0; i < _repetitions; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      f();
+      auto end = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::cout << std::setw(40) << std::left << name << " "
+              << std::fixed << std::setprecision(3) << best << " ms" << std::endl;
+    return best;
+  }
+
+  template<typename T>
+  void report(const char *name, const T& value) const {
+    std::cout << std::setw(40) << std::left << name << " " << value << std::endl;
+  }
+
+private:
+  unsigned int _repetitions;
+};
+
+// prevents the optimizer from discarding a computed value
+template<typename T>
+inline void bench_keep(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif
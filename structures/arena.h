@@ -0,0 +1,132 @@
+#ifndef __STRUCTURES_ARENA__
+#define __STRUCTURES_ARENA__
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <type_traits>
+
+// Monotonic (bump pointer) memory resource: allocations are carved out of
+// big chunks and individual deallocation is a no-op; everything is handed
+// back at once by release() or by the destructor
+class MonotonicArena {
+public:
+  explicit MonotonicArena(std::size_t chunk_size = 64 * 1024) :
+  _chunks(nullptr), _current(nullptr), _end(nullptr),
+  _chunk_size(std::max<std::size_t>(chunk_size, 256)), _allocated(0) {
+  }
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  ~MonotonicArena() { // O(chunks)
+    release();
+  }
+
+  void* allocate(std::size_t bytes, std::size_t alignment) { // O(1) amortized
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    char* p = _align(_current, alignment);
+    if(_current == nullptr || p + bytes > _end) {
+      _add_chunk(bytes + alignment);
+      p = _align(_current, alignment);
+    }
+    _current = p + bytes;
+    _allocated += bytes;
+    return p;
+  }
+
+  // frees every chunk, whatever was allocated from the arena is gone;
+  // nothing is destroyed, so only trivially destructible objects (or ones
+  // that were already destroyed) may still be living in there
+  void release() { // O(chunks)
+    while(_chunks != nullptr) {
+      Chunk* next = _chunks->next;
+      ::operator delete(_chunks);
+      _chunks = next;
+    }
+    _current = nullptr;
+    _end = nullptr;
+    _allocated = 0;
+  }
+
+  std::size_t bytes_allocated() const { // O(1)
+    return _allocated;
+  }
+
+private:
+  struct Chunk {
+    Chunk* next;
+  };
+
+  static char* _align(char* p, std::size_t alignment) {
+    std::uintptr_t u = reinterpret_cast<std::uintptr_t>(p);
+    return reinterpret_cast<char*>((u + alignment - 1) & ~(std::uintptr_t)(alignment - 1));
+  }
+
+  void _add_chunk(std::size_t min_bytes) {
+    std::size_t size = std::max(_chunk_size, min_bytes + sizeof(Chunk));
+    Chunk* c = static_cast<Chunk*>(::operator new(size));
+    c->next = _chunks;
+    _chunks = c;
+    _current = reinterpret_cast<char*>(c + 1);
+    _end = reinterpret_cast<char*>(c) + size;
+  }
+
+private:
+  Chunk* _chunks;
+  char* _current;
+  char* _end;
+  std::size_t _chunk_size;
+  std::size_t _allocated;
+};
+
+// standard allocator adaptor over a MonotonicArena, so it can be handed to
+// any of the containers (and rebound to their node types)
+template<typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  ArenaAllocator(MonotonicArena& arena) : _arena(&arena) { }
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>& o) : _arena(o.arena()) { }
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) {
+    // memory is only reclaimed by MonotonicArena::release()
+  }
+
+  MonotonicArena* arena() const {
+    return _arena;
+  }
+
+private:
+  MonotonicArena* _arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return !(a == b);
+}
+
+// allocators whose deallocate() is a no-op; node-based containers use it to
+// skip the per-node traversal on clear() when there is nothing to destroy
+template<class Alloc>
+struct is_monotonic_allocator : std::false_type { };
+
+template<typename T>
+struct is_monotonic_allocator<ArenaAllocator<T>> : std::true_type { };
+
+#endif
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <cstdint>
+#include "arena.h"
+#include "vector.h"
+#include "small_vector.h"
+#include "list.h"
+#include "tree.h"
+#include "map.h"
+#include "../test_helpers.h"
+
+// every key lands in the same chain
+struct CollidingHash {
+  std::size_t operator()(int) const { return 7; }
+};
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Arena construction");
+    MonotonicArena arena(1024);
+    th.tassert();
+    th.tassert(arena.bytes_allocated(), (std::size_t)0, "Nothing allocated");
+
+    th.message("Aligned allocations");
+    bool aligned = true;
+    for(std::size_t align = 1; align <= 64; align *= 2) {
+      void* p = arena.allocate(3, align);
+      aligned = aligned && (reinterpret_cast<std::uintptr_t>(p) % align == 0);
+    }
+    th.tassert(aligned, true, "Every allocation is aligned");
+
+    th.message("Allocation bigger than a chunk");
+    char* big = static_cast<char*>(arena.allocate(10000, 8));
+    big[9999] = 'x';
+    th.tassert();
+
+    th.message("Release");
+    arena.release();
+    th.tassert();
+    th.tassert(arena.bytes_allocated(), (std::size_t)0, "Nothing allocated");
+  }
+
+  {
+    MonotonicArena arena;
+    th.message("Vector with arena allocator");
+    Vector<std::string, ArenaAllocator<std::string>> v{ArenaAllocator<std::string>(arena)};
+    for(int i = 0; i < 100; ++i) {
+      v.push_back(std::to_string(i));
+    }
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)100, "Size is 100");
+    th.tassert(v[42], std::string("42"), "v[42] == \"42\"");
+    th.tassert(arena.bytes_allocated() > 0, true, "Storage comes from the arena");
+
+    th.message("Copy and move keep the arena");
+    auto v2 = v;
+    auto v3 = std::move(v2);
+    th.tassert();
+    th.tassert(v3.get_allocator() == v.get_allocator(), true, "Same arena");
+    th.tassert(v3.to_std_vector() == v.to_std_vector(), true, "STD vectors equal");
+  }
+
+  {
+    MonotonicArena arena;
+    th.message("SmallVector with arena allocator");
+    SmallVector<int, 4, ArenaAllocator<int>> v{ArenaAllocator<int>(arena)};
+    for(int i = 0; i < 4; ++i) {
+      v.push_back(i);
+    }
+    th.tassert(arena.bytes_allocated(), (std::size_t)0, "Inline elements use no arena memory");
+    v.push_back(4);
+    th.tassert(arena.bytes_allocated() > 0, true, "Spilled elements come from the arena");
+  }
+
+  {
+    MonotonicArena arena;
+    th.message("Lists with arena allocator");
+    SinglyLinkedList<int, ArenaAllocator<int>> sl{ArenaAllocator<int>(arena)};
+    DoublyLinkedList<int, ArenaAllocator<int>> dl{ArenaAllocator<int>(arena)};
+    for(int i = 0; i < 100; ++i) {
+      sl.push_front(i);
+      dl.push_back(i);
+    }
+    th.tassert();
+    th.tassert(sl.size(), (std::size_t)100, "Singly size is 100");
+    th.tassert(dl.size(), (std::size_t)100, "Doubly size is 100");
+    th.tassert(sl.front(), 99, "Singly front is 99");
+    th.tassert(dl.back(), 99, "Doubly back is 99");
+    th.tassert(dl.pop_front(), 0, "Doubly pop_front is 0");
+
+    th.message("Clear drops the nodes");
+    sl.clear();
+    dl.clear();
+    th.tassert();
+    th.tassert(sl.empty() && dl.empty(), true, "Both empty");
+    dl.push_back(5);
+    th.tassert(dl.front(), 5, "Usable after clear");
+  }
+
+  {
+    MonotonicArena arena;
+    th.message("Tree with arena allocator");
+    BinarySearchTree<int, ArenaAllocator<int>> t{ArenaAllocator<int>(arena)};
+    for(int i = 0; i < 100; ++i) {
+      t.insert((i * 37) % 100);
+    }
+    th.tassert();
+    th.tassert(t.size(), (std::size_t)100, "Size is 100");
+    th.tassert(t.find(42), true, "42 found");
+    th.tassert(t.remove(42), true, "42 removed");
+    th.tassert(t.find(42), false, "42 not found");
+
+    th.message("Clear without traversal");
+    t.clear();
+    th.tassert();
+    th.tassert(t.empty(), true, "Empty");
+    t.insert(7);
+    th.tassert(t.find(7), true, "Usable after clear");
+  }
+
+  {
+    MonotonicArena arena;
+    typedef std::pair<const std::string, int> item;
+    ArenaAllocator<item> alloc(arena);
+
+    th.message("Chained map with arena allocator");
+    ChainedUnorderedMap<std::string, int, std::hash<std::string>, ArenaAllocator<item>> cm(13, alloc);
+    for(int i = 0; i < 200; ++i) {
+      cm[std::to_string(i)] = i;
+    }
+    th.tassert();
+    th.tassert(cm.size(), (std::size_t)200, "Size is 200");
+    th.tassert(cm.at("123"), 123, "m[\"123\"] == 123");
+    for(int i = 0; i < 150; ++i) {
+      cm.erase(std::to_string(i));
+    }
+    th.tassert(cm.size(), (std::size_t)50, "Size is 50 after erasing");
+
+    th.message("Open addressing map with arena allocator");
+    OpenAddressUnorderedMap<std::string, int, std::hash<std::string>, ArenaAllocator<item>> om(13, alloc);
+    for(int i = 0; i < 200; ++i) {
+      om[std::to_string(i)] = i;
+    }
+    th.tassert();
+    th.tassert(om.size(), (std::size_t)200, "Size is 200");
+    th.tassert(om.at("123"), 123, "m[\"123\"] == 123");
+
+    th.message("Moving maps keeps the arena");
+    auto cm2 = std::move(cm);
+    auto om2 = std::move(om);
+    th.tassert();
+    th.tassert(cm2.get_allocator() == alloc && om2.get_allocator() == alloc, true, "Same arena");
+    th.tassert(cm2.size() + om2.size(), (std::size_t)250, "Sizes preserved");
+  }
+
+  {
+    typedef std::pair<const int, int> item;
+    typedef ChainedUnorderedMap<int, int, CollidingHash, ArenaAllocator<item>> arena_map;
+    MonotonicArena arena2;
+    arena_map m2(13, ArenaAllocator<item>(arena2));
+    m2[-1] = -1;
+    th.message("Move assignment between maps on different arenas");
+    {
+      MonotonicArena arena1;
+      arena_map m1(13, ArenaAllocator<item>(arena1));
+      for(int i = 0; i < 100; ++i) {
+        m1[i] = i;
+      }
+      m2 = std::move(m1);
+    }
+    // arena1 is gone, m2 must not use anything it handed out
+    th.tassert();
+    th.tassert(m2.get_allocator() == ArenaAllocator<item>(arena2), true, "Target keeps its arena");
+    th.tassert(m2.size(), (std::size_t)100, "Size is 100");
+    bool all = true;
+    for(int i = 0; i < 100; ++i) {
+      all = all && m2.find(i) != nullptr && *m2.find(i) == i;
+    }
+    th.tassert(all, true, "Every key is found in the target");
+    th.tassert(m2.contains(-1), false, "Old contents are gone");
+    m2[100] = 100;
+    th.tassert(m2.at(100), 100, "Target is usable");
+  }
+
+  th.summary();
+  return 0;
+}
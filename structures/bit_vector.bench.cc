@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include "bit_vector.h"
+#include "graph.h"
+#include "../bench_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 24;
+
+  // one bit in 200 set, like a sparse adjacency matrix
+  std::vector<bool> stdv(n);
+  BitVector<> bits(n);
+  for(std::size_t i = 0; i < n; i += 200) {
+    stdv[i] = true;
+    bits.set(i);
+  }
+
+  std::cout << "\n[[ scan of " << n << " bits, 1 in 200 set ]]" << std::endl << std::endl;
+  bh.run("std::vector<bool> bit by bit (before)", [&] {
+    std::size_t sum = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      if(stdv[i]) {
+        sum += i;
+      }
+    }
+    bench_keep(sum);
+  });
+  bh.run("BitVector::find_next_set (after)", [&] {
+    std::size_t sum = 0;
+    for(std::size_t i = bits.find_first_set(); i < n; i = bits.find_next_set(i + 1)) {
+      sum += i;
+    }
+    bench_keep(sum);
+  });
+  bh.run("std::count on std::vector<bool>", [&] {
+    bench_keep(std::count(stdv.begin(), stdv.end(), true));
+  });
+  bh.run("BitVector::count", [&] {
+    bench_keep(bits.count());
+  });
+
+  const std::size_t vertices = 4096;
+  AdjacencyMatrixDiGraph g(vertices);
+  for(std::size_t v = 0; v < vertices; ++v) {
+    g.add_edge({ (int)v, (int)((v * 7 + 1) % vertices) });
+    g.add_edge({ (int)v, (int)((v * 13 + 5) % vertices) });
+  }
+  std::cout << "\n[[ AdjacencyMatrixDiGraph with " << vertices << " vertices, 2 edges each ]]" << std::endl << std::endl;
+  bh.run("edges() iteration", [&] {
+    std::size_t sum = 0;
+    for (auto it = g.edges(); !it.end(); ++it) {
+      sum += (*it).second;
+    }
+    bench_keep(sum);
+  });
+  bh.run("edge_count()", [&] {
+    bench_keep(g.edge_count());
+  });
+
+  // adjacent() must only read its own row, however empty the rest of
+  // the matrix is
+  const std::size_t big = 16384;
+  AdjacencyMatrixDiGraph single(big);
+  single.add_edge({ 0, 1 });
+  std::cout << "\n[[ AdjacencyMatrixDiGraph with " << big << " vertices, a single edge ]]" << std::endl << std::endl;
+  bh.run("100 x adjacent(0)", [&] {
+    std::size_t sum = 0;
+    for(int r = 0; r < 100; ++r) {
+      for (auto it = single.adjacent(0); !it.end(); ++it) {
+        sum += (*it).second;
+      }
+    }
+    bench_keep(sum);
+  });
+
+  return 0;
+}
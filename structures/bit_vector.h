@@ -0,0 +1,383 @@
+#ifndef __STRUCTURES_BIT_VECTOR__
+#define __STRUCTURES_BIT_VECTOR__
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+// Dynamic sequence of bits packed in 64-bit words.
+// Unlike std::vector<bool> it hands out plain bools instead of proxy
+// references and exposes whole-word operations: counting, scanning and
+// the bitwise operators go 64 bits per instruction (popcount / ctz).
+// Bits past size() in the last word are always kept at zero, so whole
+// words can be counted and scanned without masking
+template<class Alloc = std::allocator<std::uint64_t>>
+class BitVector {
+public:
+  typedef Alloc allocator_type;
+  typedef std::uint64_t word_type;
+  static const std::size_t word_bits = 64;
+
+  explicit BitVector(std::size_t n = 0, bool value = false, const Alloc& alloc = Alloc()); // O(n/64)
+
+  std::size_t size() const; // O(1)
+  bool empty() const; // O(1)
+  void resize(std::size_t n, bool value = false); // O(n/64)
+  void push_back(bool value); // amortized O(1)
+  void clear(); // O(1)
+
+  bool test(std::size_t i) const; // O(1)
+  bool operator[](std::size_t i) const; // O(1)
+  void set(std::size_t i); // O(1)
+  void set(std::size_t i, bool value); // O(1)
+  void reset(std::size_t i); // O(1)
+  void flip(std::size_t i); // O(1)
+  void fill(bool value); // O(n/64)
+
+  std::size_t count() const; // O(n/64)
+  bool any() const; // O(n/64)
+  bool none() const; // O(n/64)
+
+  // index of the first set (or unset) bit at or after i, size() if none
+  std::size_t find_first_set() const; // O(n/64)
+  std::size_t find_next_set(std::size_t i) const; // O(n/64)
+  // same, but only scans [i, limit) and returns limit if none
+  std::size_t find_next_set(std::size_t i, std::size_t limit) const; // O((limit-i)/64)
+  std::size_t find_next_unset(std::size_t i) const; // O(n/64)
+  // set bits in [0, i)
+  std::size_t rank(std::size_t i) const; // O(i/64)
+  // index of the k-th set bit (counting from 0), size() if there is none
+  std::size_t select(std::size_t k) const; // O(n/64)
+
+  BitVector& operator&=(const BitVector& o); // O(n/64)
+  BitVector& operator|=(const BitVector& o); // O(n/64)
+  BitVector& operator^=(const BitVector& o); // O(n/64)
+  BitVector& and_not(const BitVector& o); // O(n/64)
+  BitVector operator~() const; // O(n/64)
+  bool operator==(const BitVector& o) const; // O(n/64)
+  bool operator!=(const BitVector& o) const; // O(n/64)
+
+  std::size_t word_count() const; // O(1)
+  word_type word(std::size_t w) const; // O(1)
+  std::vector<bool> to_std_vector() const; // O(n)
+  Alloc get_allocator() const; // O(1)
+
+private:
+  static std::size_t _words_for(std::size_t n);
+  void _clear_tail();
+
+private:
+  std::vector<word_type, Alloc> _words;
+  std::size_t _size;
+};
+
+template<class Alloc>
+BitVector<Alloc> operator&(BitVector<Alloc> a, const BitVector<Alloc>& b) { // O(n/64)
+  return a &= b;
+}
+
+template<class Alloc>
+BitVector<Alloc> operator|(BitVector<Alloc> a, const BitVector<Alloc>& b) { // O(n/64)
+  return a |= b;
+}
+
+template<class Alloc>
+BitVector<Alloc> operator^(BitVector<Alloc> a, const BitVector<Alloc>& b) { // O(n/64)
+  return a ^= b;
+}
+
+template<class Alloc>
+BitVector<Alloc>::BitVector(std::size_t n, bool value, const Alloc& alloc) :
+_words(_words_for(n), value ? ~word_type(0) : word_type(0), alloc), _size(n) {
+  _clear_tail();
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::_words_for(std::size_t n) {
+  return (n + word_bits - 1) / word_bits;
+}
+
+// zeroes the unused bits of the last word
+template<class Alloc>
+void BitVector<Alloc>::_clear_tail() {
+  const std::size_t used = _size % word_bits;
+  if(used != 0) {
+    _words.back() &= (word_type(1) << used) - 1;
+  }
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::size() const {
+  return _size;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::empty() const {
+  return size() == 0;
+}
+
+template<class Alloc>
+void BitVector<Alloc>::resize(std::size_t n, bool value) {
+  const std::size_t old_size = _size;
+  _words.resize(_words_for(n), value ? ~word_type(0) : word_type(0));
+  _size = n;
+  if(value && n > old_size && old_size % word_bits != 0) {
+    // the old last word keeps zeroes past old_size
+    _words[old_size / word_bits] |= ~word_type(0) << (old_size % word_bits);
+  }
+  _clear_tail();
+}
+
+template<class Alloc>
+void BitVector<Alloc>::push_back(bool value) {
+  if(_size % word_bits == 0) {
+    _words.push_back(0);
+  }
+  _size++;
+  set(_size - 1, value);
+}
+
+template<class Alloc>
+void BitVector<Alloc>::clear() {
+  _words.clear();
+  _size = 0;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::test(std::size_t i) const {
+  assert(i < size());
+  return (_words[i / word_bits] >> (i % word_bits)) & 1;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::operator[](std::size_t i) const {
+  return test(i);
+}
+
+template<class Alloc>
+void BitVector<Alloc>::set(std::size_t i) {
+  assert(i < size());
+  _words[i / word_bits] |= word_type(1) << (i % word_bits);
+}
+
+template<class Alloc>
+void BitVector<Alloc>::set(std::size_t i, bool value) {
+  if(value) {
+    set(i);
+  } else {
+    reset(i);
+  }
+}
+
+template<class Alloc>
+void BitVector<Alloc>::reset(std::size_t i) {
+  assert(i < size());
+  _words[i / word_bits] &= ~(word_type(1) << (i % word_bits));
+}
+
+template<class Alloc>
+void BitVector<Alloc>::flip(std::size_t i) {
+  assert(i < size());
+  _words[i / word_bits] ^= word_type(1) << (i % word_bits);
+}
+
+template<class Alloc>
+void BitVector<Alloc>::fill(bool value) {
+  for(auto& w : _words) {
+    w = value ? ~word_type(0) : word_type(0);
+  }
+  _clear_tail();
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::count() const {
+  std::size_t c = 0;
+  for(word_type w : _words) {
+    c += __builtin_popcountll(w);
+  }
+  return c;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::any() const {
+  for(word_type w : _words) {
+    if(w != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::none() const {
+  return !any();
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::find_first_set() const {
+  return find_next_set(0);
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::find_next_set(std::size_t i) const {
+  return find_next_set(i, size());
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::find_next_set(std::size_t i, std::size_t limit) const {
+  if(limit > size()) {
+    limit = size();
+  }
+  if(i >= limit) {
+    return limit;
+  }
+  std::size_t w = i / word_bits;
+  // the scan stops at the word holding the last bit before limit
+  const std::size_t last = (limit - 1) / word_bits;
+  // drop the bits before i in the first word
+  word_type bits = _words[w] & (~word_type(0) << (i % word_bits));
+  while(bits == 0) {
+    if(++w > last) {
+      return limit;
+    }
+    bits = _words[w];
+  }
+  // bits of the last word past limit may be set, clamp them
+  std::size_t found = w * word_bits + __builtin_ctzll(bits);
+  return found < limit ? found : limit;
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::find_next_unset(std::size_t i) const {
+  if(i >= size()) {
+    return size();
+  }
+  std::size_t w = i / word_bits;
+  word_type bits = ~_words[w] & (~word_type(0) << (i % word_bits));
+  while(bits == 0) {
+    if(++w == _words.size()) {
+      return size();
+    }
+    bits = ~_words[w];
+  }
+  // the zeroed tail of the last word reads as unset, clamp it
+  std::size_t found = w * word_bits + __builtin_ctzll(bits);
+  return found < size() ? found : size();
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::rank(std::size_t i) const {
+  assert(i <= size());
+  std::size_t r = 0;
+  const std::size_t full = i / word_bits;
+  for(std::size_t w = 0; w < full; ++w) {
+    r += __builtin_popcountll(_words[w]);
+  }
+  if(i % word_bits != 0) {
+    r += __builtin_popcountll(_words[full] & ((word_type(1) << (i % word_bits)) - 1));
+  }
+  return r;
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::select(std::size_t k) const {
+  for(std::size_t w = 0; w < _words.size(); ++w) {
+    word_type bits = _words[w];
+    const std::size_t c = __builtin_popcountll(bits);
+    if(k < c) {
+      // drop the k lowest set bits of this word
+      for(; k > 0; --k) {
+        bits &= bits - 1;
+      }
+      return w * word_bits + __builtin_ctzll(bits);
+    }
+    k -= c;
+  }
+  return size();
+}
+
+template<class Alloc>
+BitVector<Alloc>& BitVector<Alloc>::operator&=(const BitVector& o) {
+  assert(size() == o.size());
+  for(std::size_t w = 0; w < _words.size(); ++w) {
+    _words[w] &= o._words[w];
+  }
+  return *this;
+}
+
+template<class Alloc>
+BitVector<Alloc>& BitVector<Alloc>::operator|=(const BitVector& o) {
+  assert(size() == o.size());
+  for(std::size_t w = 0; w < _words.size(); ++w) {
+    _words[w] |= o._words[w];
+  }
+  return *this;
+}
+
+template<class Alloc>
+BitVector<Alloc>& BitVector<Alloc>::operator^=(const BitVector& o) {
+  assert(size() == o.size());
+  for(std::size_t w = 0; w < _words.size(); ++w) {
+    _words[w] ^= o._words[w];
+  }
+  return *this;
+}
+
+// clears every bit that is set in o
+template<class Alloc>
+BitVector<Alloc>& BitVector<Alloc>::and_not(const BitVector& o) {
+  assert(size() == o.size());
+  for(std::size_t w = 0; w < _words.size(); ++w) {
+    _words[w] &= ~o._words[w];
+  }
+  return *this;
+}
+
+template<class Alloc>
+BitVector<Alloc> BitVector<Alloc>::operator~() const {
+  BitVector ret(*this);
+  for(auto& w : ret._words) {
+    w = ~w;
+  }
+  ret._clear_tail();
+  return ret;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::operator==(const BitVector& o) const {
+  return size() == o.size() && _words == o._words;
+}
+
+template<class Alloc>
+bool BitVector<Alloc>::operator!=(const BitVector& o) const {
+  return !(*this == o);
+}
+
+template<class Alloc>
+std::size_t BitVector<Alloc>::word_count() const {
+  return _words.size();
+}
+
+// bit i of the vector is bit i % 64 of word i / 64
+template<class Alloc>
+typename BitVector<Alloc>::word_type BitVector<Alloc>::word(std::size_t w) const {
+  return _words[w];
+}
+
+template<class Alloc>
+std::vector<bool> BitVector<Alloc>::to_std_vector() const {
+  std::vector<bool> v(size());
+  for(std::size_t i = find_first_set(); i < size(); i = find_next_set(i + 1)) {
+    v[i] = true;
+  }
+  return v;
+}
+
+template<class Alloc>
+Alloc BitVector<Alloc>::get_allocator() const {
+  return _words.get_allocator();
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+#include "bit_vector.h"
+#include "../test_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Default construction");
+    BitVector<> b;
+    th.tassert();
+    th.tassert(b.size(), (std::size_t)0, "Size is 0");
+    th.tassert(b.find_first_set(), (std::size_t)0, "Nothing set");
+  }
+
+  {
+    th.message("Construction with all bits set");
+    BitVector<> b(70, true);
+    th.tassert();
+    th.tassert(b.count(), (std::size_t)70, "70 bits set");
+    th.tassert(b.word_count(), (std::size_t)2, "2 words");
+    th.tassert(b.word(1), (std::uint64_t)0x3f, "Tail of the last word is clear");
+    th.tassert(b.find_next_unset(0), (std::size_t)70, "No unset bit");
+
+    th.message("Complement");
+    BitVector<> c = ~b;
+    th.tassert();
+    th.tassert(c.none(), true, "Nothing set");
+    th.tassert(c.find_next_unset(3), (std::size_t)3, "Bit 3 is unset");
+  }
+
+  {
+    BitVector<> b(200);
+    th.message("set, reset and flip");
+    b.set(3);
+    b.set(64);
+    b.set(130);
+    b.set(199, true);
+    b.flip(5);
+    b.flip(5);
+    b.reset(130);
+    th.tassert();
+    th.tassert(b.test(3) && b[64] && b[199], true, "3, 64 and 199 are set");
+    th.tassert(b[5] || b[130], false, "5 and 130 are clear");
+    th.tassert(b.count(), (std::size_t)3, "3 bits set");
+
+    th.message("find_next_set");
+    th.tassert(b.find_first_set(), (std::size_t)3, "First is 3");
+    th.tassert(b.find_next_set(4), (std::size_t)64, "Next after 3 is 64");
+    th.tassert(b.find_next_set(65), (std::size_t)199, "Next after 64 is 199");
+    th.tassert(b.find_next_set(200), (std::size_t)200, "None after 199");
+
+    th.message("find_next_set with a limit");
+    th.tassert(b.find_next_set(4, 65), (std::size_t)64, "64 is before the limit");
+    th.tassert(b.find_next_set(4, 64), (std::size_t)64, "64 is the limit itself");
+    th.tassert(b.find_next_set(4, 40), (std::size_t)40, "Nothing in [4, 40)");
+    th.tassert(b.find_next_set(65, 150), (std::size_t)150, "199 is past the limit");
+    th.tassert(b.find_next_set(65, 1000), (std::size_t)199, "Limit is clamped to size");
+    th.tassert(b.find_next_set(10, 10), (std::size_t)10, "Empty range");
+
+    th.message("rank and select");
+    th.tassert(b.rank(0), (std::size_t)0, "rank(0) == 0");
+    th.tassert(b.rank(4), (std::size_t)1, "rank(4) == 1");
+    th.tassert(b.rank(64), (std::size_t)1, "rank(64) == 1");
+    th.tassert(b.rank(200), (std::size_t)3, "rank(200) == 3");
+    th.tassert(b.select(0), (std::size_t)3, "select(0) == 3");
+    th.tassert(b.select(2), (std::size_t)199, "select(2) == 199");
+    th.tassert(b.select(3), (std::size_t)200, "select(3) is past the end");
+
+    th.message("Bitwise operators");
+    BitVector<> m(200);
+    m.set(64);
+    m.set(100);
+    th.tassert((b & m).count(), (std::size_t)1, "AND has 1 bit");
+    th.tassert((b | m).count(), (std::size_t)4, "OR has 4 bits");
+    th.tassert((b ^ m).count(), (std::size_t)3, "XOR has 3 bits");
+    BitVector<> d = b;
+    d.and_not(m);
+    th.tassert(d.test(64), false, "and_not clears 64");
+    th.tassert(d.count(), (std::size_t)2, "and_not keeps 2 bits");
+  }
+
+  {
+    BitVector<> b;
+    th.message("push_back and resize");
+    for(int i = 0; i < 100; ++i) {
+      b.push_back(i % 3 == 0);
+    }
+    th.tassert();
+    th.tassert(b.count(), (std::size_t)34, "34 bits set");
+    b.resize(130, true);
+    th.tassert(b.count(), (std::size_t)64, "30 more bits set");
+    th.tassert(b.test(99) && b.test(100) && b.test(129), true, "New bits are set");
+    b.resize(10);
+    th.tassert(b.count(), (std::size_t)4, "4 bits left");
+    b.resize(64);
+    th.tassert(b.count(), (std::size_t)4, "Growing back adds clear bits");
+  }
+
+  std::srand((unsigned int)std::time(0));
+  {
+    const std::size_t n = 3000;
+    BitVector<> b(n);
+    std::vector<bool> stdv(n);
+
+    th.message("Stress test against std::vector<bool>");
+    for(int i = 0; i < 5000; ++i) {
+      std::size_t idx = std::rand() % n;
+      bool value = std::rand() % 2;
+      b.set(idx, value);
+      stdv[idx] = value;
+    }
+    th.tassert();
+    th.tassert(b.to_std_vector() == stdv, true, "Check complete vector");
+
+    bool ranks = true;
+    std::size_t expected = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      ranks = ranks && b.rank(i) == expected;
+      if(stdv[i]) {
+        ranks = ranks && b.select(expected) == i;
+        expected++;
+      }
+    }
+    th.tassert(ranks, true, "rank and select agree with a linear scan");
+  }
+
+  th.summary();
+  return 0;
+}
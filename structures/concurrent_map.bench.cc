@@ -0,0 +1,136 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include "map.h"
+#include "concurrent_map.h"
+#include "../bench_helpers.h"
+
+// keys in [0, n) where key k has probability proportional to 1 / (k+1)^s,
+// drawn by binary search over the cumulative distribution
+class ZipfGenerator {
+public:
+  ZipfGenerator(std::size_t n, double s) : _cdf(n) {
+    double sum = 0;
+    for(std::size_t k = 0; k < n; ++k) {
+      sum += 1.0 / std::pow((double)(k + 1), s);
+      _cdf[k] = sum;
+    }
+    for(auto& c : _cdf) {
+      c /= sum;
+    }
+  }
+
+  template<class Rng>
+  int operator()(Rng& rng) {
+    const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    const auto it = std::lower_bound(_cdf.begin(), _cdf.end(), u);
+    return (int)std::min<std::size_t>(it - _cdf.begin(), _cdf.size() - 1);
+  }
+
+private:
+  std::vector<double> _cdf;
+};
+
+// one key stream per thread, generated before timing
+std::vector<std::vector<int>> make_streams(std::size_t threads, std::size_t ops, std::size_t keys, bool zipf) {
+  std::vector<std::vector<int>> streams(threads);
+  ZipfGenerator z(keys, 0.99);
+  for(std::size_t t = 0; t < threads; ++t) {
+    std::mt19937 rng((unsigned int)(t + 1));
+    std::uniform_int_distribution<int> uniform(0, (int)keys - 1);
+    for(std::size_t i = 0; i < ops / threads; ++i) {
+      // scatter the hot ranks over the key space
+      const int rank = zipf ? z(rng) : uniform(rng);
+      streams[t].push_back((int)((unsigned int)rank * 2654435761u));
+    }
+  }
+  return streams;
+}
+
+// every thread runs its stream, one update every ten operations and a
+// read otherwise
+template<class Op>
+void run_threads(const std::vector<std::vector<int>>& streams, Op op) {
+  std::vector<std::thread> workers;
+  for(std::size_t t = 0; t < streams.size(); ++t) {
+    workers.emplace_back([&streams, &op, t] {
+      const auto& s = streams[t];
+      for(std::size_t i = 0; i < s.size(); ++i) {
+        op(s[i], i % 10 == 0);
+      }
+    });
+  }
+  for(auto& w : workers) {
+    w.join();
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t keys = 1 << 16;
+  const std::size_t ops = 1 << 22;
+  // the thread counts go up to 64, or to argv[1]
+  std::size_t max_threads = 64;
+  if(argc > 1) {
+    max_threads = std::max(1, std::atoi(argv[1]));
+  }
+  // powers of two, plus max_threads itself when it is not one
+  std::vector<std::size_t> thread_counts;
+  for(std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  if(thread_counts.back() != max_threads) {
+    thread_counts.push_back(max_threads);
+  }
+
+  for(bool zipf : {false, true}) {
+    std::cout << "\n[[ " << ops << " operations (90% get, 10% update) on " << keys << " "
+              << (zipf ? "Zipfian (s = 0.99)" : "uniform") << " keys ]]" << std::endl << std::endl;
+    for(std::size_t threads : thread_counts) {
+      const auto streams = make_streams(threads, ops, keys, zipf);
+
+      OpenAddressUnorderedMap<int, int> single;
+      std::mutex m;
+      for(std::size_t k = 0; k < keys; ++k) {
+        single[(int)((unsigned int)k * 2654435761u)] = 0;
+      }
+      std::string mutex_name = "Map + mutex, " + std::to_string(threads) + " threads";
+      bh.run(mutex_name.c_str(), [&] {
+        run_threads(streams, [&](int key, bool write) {
+          std::lock_guard<std::mutex> lock(m);
+          if(write) {
+            ++single[key];
+          } else {
+            const int* v = single.find(key);
+            bench_keep(v);
+          }
+        });
+      });
+
+      ConcurrentUnorderedMap<int, int> sharded;
+      for(std::size_t k = 0; k < keys; ++k) {
+        sharded.insert_or_assign((int)((unsigned int)k * 2654435761u), 0);
+      }
+      std::string sharded_name = "ConcurrentUnorderedMap, " + std::to_string(threads) + " threads";
+      bh.run(sharded_name.c_str(), [&] {
+        run_threads(streams, [&](int key, bool write) {
+          if(write) {
+            sharded.update(key, [](int& v) { ++v; });
+          } else {
+            int v = 0;
+            bench_keep(sharded.get(key, v));
+          }
+        });
+      });
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,216 @@
+#ifndef __STRUCTURES_CONCURRENT_MAP__
+#define __STRUCTURES_CONCURRENT_MAP__
+
+#include <cstddef>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <new>
+#include <shared_mutex>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "map.h"
+
+// Hash map that many threads can read and update at once.
+// The keys are split by hash into shards, every shard being a whole Map
+// (OpenAddressUnorderedMap by default, ChainedUnorderedMap or any other
+// UnorderedMap with find/try_emplace works too) guarded by its own
+// reader-writer lock. Threads working on keys of different shards never
+// wait for each other, and each shard sits on its own cache lines so that
+// taking one lock does not invalidate the line of a neighbouring one.
+//   get / visit / contains  shared lock of the key's shard
+//   update / insert_or_assign / erase
+//                           exclusive lock of the key's shard
+//   for_each_shard          every shard in turn, each under its own lock
+// No reference into the map ever escapes a lock: get copies the value
+// out, visit and update run a function on it while the lock is held. The
+// function must not call back into the same map.
+// size() and to_std_unordered_map() lock one shard at a time, so they
+// are not a snapshot of the whole map while other threads write to it.
+// Readers only call const members of Map, which must not modify it
+// (ChainedUnorderedMap only moves rehash buckets in non-const calls).
+template<typename K, typename T, class Hash = std::hash<K>, class Map = OpenAddressUnorderedMap<K,T,Hash>>
+class ConcurrentUnorderedMap {
+public:
+  typedef K key_type;
+  typedef T mapped_type;
+  typedef Map shard_type;
+
+  explicit ConcurrentUnorderedMap(std::size_t shard_count = 64); // O(shard_count)
+  ConcurrentUnorderedMap(const ConcurrentUnorderedMap&) = delete;
+  ConcurrentUnorderedMap& operator=(const ConcurrentUnorderedMap&) = delete;
+  virtual ~ConcurrentUnorderedMap(); // O(n)
+
+  // copies the value with that key into value; false if there is none
+  bool get(const K& key, T& value) const; // O(1) amortized
+  // calls fn(const T&) on the value with that key; false if there is none
+  template<class F>
+  bool visit(const K& key, F fn) const; // O(1) amortized
+  bool contains(const K& key) const; // O(1) amortized
+
+  // calls fn(T&) on the value with that key, inserting T() first if the
+  // key is absent; returns whether it was inserted. The read-modify-write
+  // is atomic with respect to every other operation on the key
+  template<class F>
+  bool update(const K& key, F fn); // O(1) amortized
+  // returns whether the key was inserted (rather than assigned)
+  template<class M>
+  bool insert_or_assign(const K& key, M&& value); // O(1) amortized
+  // returns whether the key was present
+  bool erase(const K& key); // O(1) amortized
+
+  // calls fn(Map&) on every shard under its exclusive lock
+  template<class F>
+  void for_each_shard(F fn); // O(n)
+  // calls fn(const Map&) on every shard under its shared lock
+  template<class F>
+  void for_each_shard(F fn) const; // O(n)
+
+  std::size_t shard_count() const { return _shard_count; } // O(1)
+  std::size_t size() const; // O(shard_count)
+  bool empty() const { return size() == 0; } // O(shard_count)
+  std::unordered_map<K,T> to_std_unordered_map() const; // O(n)
+
+private:
+  static const std::size_t _cache_line = 64;
+
+  // the lock and the map header of a shard share a cache line, and no
+  // other shard touches it
+  struct alignas(_cache_line) _shard {
+    mutable std::shared_timed_mutex lock;
+    Map map;
+  };
+
+  _shard& shard_for(const K& key) const;
+
+private:
+  std::size_t _shard_count;
+  Hash _hasher;
+  // operator new only guarantees alignof(std::max_align_t) before C++17,
+  // so the shards are placed by hand in an over-allocated buffer
+  std::unique_ptr<char[]> _storage;
+  _shard* _shards;
+};
+
+template<typename K, typename T, class Hash, class Map>
+const std::size_t ConcurrentUnorderedMap<K,T,Hash,Map>::_cache_line;
+
+template<typename K, typename T, class Hash, class Map>
+ConcurrentUnorderedMap<K,T,Hash,Map>::ConcurrentUnorderedMap(std::size_t shard_count)
+    : _shard_count(shard_count > 0 ? shard_count : 1) {
+  std::size_t space = _shard_count * sizeof(_shard) + _cache_line;
+  _storage.reset(new char[space]);
+  void* p = _storage.get();
+  p = std::align(_cache_line, _shard_count * sizeof(_shard), p, space);
+  assert(p != nullptr);
+  _shards = static_cast<_shard*>(p);
+  for(std::size_t i = 0; i < _shard_count; ++i) {
+    new (&_shards[i]) _shard();
+  }
+}
+
+template<typename K, typename T, class Hash, class Map>
+ConcurrentUnorderedMap<K,T,Hash,Map>::~ConcurrentUnorderedMap() {
+  for(std::size_t i = 0; i < _shard_count; ++i) {
+    _shards[i].~_shard();
+  }
+}
+
+// the shards take their own bits of the hash: the maps inside mix the
+// same hash with a different multiplier, so the keys of one shard still
+// spread over all of its buckets and tags
+template<typename K, typename T, class Hash, class Map>
+typename ConcurrentUnorderedMap<K,T,Hash,Map>::_shard& ConcurrentUnorderedMap<K,T,Hash,Map>::shard_for(const K& key) const {
+  const auto h = (std::size_t)_hasher(key) * (std::size_t)0xC2B2AE3D27D4EB4FULL;
+  return _shards[(h >> (sizeof(std::size_t) * 4)) % _shard_count];
+}
+
+template<typename K, typename T, class Hash, class Map>
+bool ConcurrentUnorderedMap<K,T,Hash,Map>::get(const K& key, T& value) const {
+  return visit(key, [&value](const T& v) { value = v; });
+}
+
+template<typename K, typename T, class Hash, class Map>
+template<class F>
+bool ConcurrentUnorderedMap<K,T,Hash,Map>::visit(const K& key, F fn) const {
+  const _shard& s = shard_for(key);
+  std::shared_lock<std::shared_timed_mutex> lock(s.lock);
+  const T* v = s.map.find(key);
+  if(v == nullptr) {
+    return false;
+  }
+  fn(*v);
+  return true;
+}
+
+template<typename K, typename T, class Hash, class Map>
+bool ConcurrentUnorderedMap<K,T,Hash,Map>::contains(const K& key) const {
+  const _shard& s = shard_for(key);
+  std::shared_lock<std::shared_timed_mutex> lock(s.lock);
+  return s.map.contains(key);
+}
+
+template<typename K, typename T, class Hash, class Map>
+template<class F>
+bool ConcurrentUnorderedMap<K,T,Hash,Map>::update(const K& key, F fn) {
+  _shard& s = shard_for(key);
+  std::lock_guard<std::shared_timed_mutex> lock(s.lock);
+  auto r = s.map.try_emplace(key);
+  fn(*r.first);
+  return r.second;
+}
+
+template<typename K, typename T, class Hash, class Map>
+template<class M>
+bool ConcurrentUnorderedMap<K,T,Hash,Map>::insert_or_assign(const K& key, M&& value) {
+  _shard& s = shard_for(key);
+  std::lock_guard<std::shared_timed_mutex> lock(s.lock);
+  return s.map.insert_or_assign(key, std::forward<M>(value)).second;
+}
+
+template<typename K, typename T, class Hash, class Map>
+bool ConcurrentUnorderedMap<K,T,Hash,Map>::erase(const K& key) {
+  _shard& s = shard_for(key);
+  std::lock_guard<std::shared_timed_mutex> lock(s.lock);
+  const auto before = s.map.size();
+  s.map.erase(key);
+  return s.map.size() != before;
+}
+
+template<typename K, typename T, class Hash, class Map>
+template<class F>
+void ConcurrentUnorderedMap<K,T,Hash,Map>::for_each_shard(F fn) {
+  for(std::size_t i = 0; i < _shard_count; ++i) {
+    std::lock_guard<std::shared_timed_mutex> lock(_shards[i].lock);
+    fn(_shards[i].map);
+  }
+}
+
+template<typename K, typename T, class Hash, class Map>
+template<class F>
+void ConcurrentUnorderedMap<K,T,Hash,Map>::for_each_shard(F fn) const {
+  for(std::size_t i = 0; i < _shard_count; ++i) {
+    std::shared_lock<std::shared_timed_mutex> lock(_shards[i].lock);
+    fn(static_cast<const Map&>(_shards[i].map));
+  }
+}
+
+template<typename K, typename T, class Hash, class Map>
+std::size_t ConcurrentUnorderedMap<K,T,Hash,Map>::size() const {
+  std::size_t n = 0;
+  for_each_shard([&n](const Map& m) { n += m.size(); });
+  return n;
+}
+
+template<typename K, typename T, class Hash, class Map>
+std::unordered_map<K,T> ConcurrentUnorderedMap<K,T,Hash,Map>::to_std_unordered_map() const {
+  std::unordered_map<K,T> result;
+  for_each_shard([&result](const Map& m) {
+    auto part = m.to_std_unordered_map();
+    result.insert(part.begin(), part.end());
+  });
+  return result;
+}
+
+#endif
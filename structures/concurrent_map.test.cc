@@ -0,0 +1,136 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <unordered_map>
+#include "concurrent_map.h"
+#include "../test_helpers.h"
+
+template<class ConcurrentMap>
+void test_concurrent_map(TestHelper& th) {
+  {
+    th.message("Construction");
+    ConcurrentMap m(8);
+    th.tassert();
+    th.tassert(m.shard_count(), (std::size_t)8, "8 shards");
+    th.tassert(m.empty(), true, "Map is empty");
+    int v = 0;
+    th.tassert(m.get(1, v), false, "get on an empty map finds nothing");
+    th.message("Destruction");
+  }
+  th.tassert();
+
+  {
+    ConcurrentMap m(4);
+    th.message("update inserts a default value and then modifies it");
+    th.tassert(m.update(7, [](int& v) { v += 5; }), true, "First update inserts");
+    th.tassert(m.update(7, [](int& v) { v *= 3; }), false, "Second update does not");
+    int v = 0;
+    th.tassert(m.get(7, v), true, "get finds the key");
+    th.tassert(v, 15, "Value is (0 + 5) * 3");
+
+    th.message("visit, contains, insert_or_assign and erase");
+    th.tassert(m.visit(7, [&v](const int& x) { v = x + 1; }), true, "visit finds the key");
+    th.tassert(v, 16, "visit saw the value");
+    th.tassert(m.visit(8, [&v](const int&) { v = -1; }), false, "visit on a missing key");
+    th.tassert(v, 16, "Function was not called");
+    th.tassert(m.insert_or_assign(8, 80), true, "insert_or_assign inserts");
+    th.tassert(m.insert_or_assign(8, 81), false, "insert_or_assign assigns");
+    th.tassert(m.contains(8), true, "Key 8 is present");
+    th.tassert(m.erase(8), true, "erase removes key 8");
+    th.tassert(m.erase(8), false, "erase of a missing key");
+    th.tassert(m.contains(8), false, "Key 8 is gone");
+    th.tassert(m.size(), (std::size_t)1, "Size is 1");
+  }
+
+  {
+    ConcurrentMap m(16);
+    th.message("Keys spread over every shard");
+    for(int i = 0; i < 10000; ++i) {
+      m.insert_or_assign(i, i);
+    }
+    std::size_t used = 0, total = 0;
+    m.for_each_shard([&](const typename ConcurrentMap::shard_type& s) {
+      used += !s.empty();
+      total += s.size();
+    });
+    th.tassert();
+    th.tassert(used, (std::size_t)16, "No shard is empty");
+    th.tassert(total, (std::size_t)10000, "Shards hold 10000 keys");
+
+    th.message("for_each_shard can modify the shards");
+    m.for_each_shard([](typename ConcurrentMap::shard_type& s) {
+      s.erase(0);
+      s.erase(1);
+    });
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)9998, "Keys 0 and 1 were erased from their shards");
+    std::unordered_map<int, int> all = m.to_std_unordered_map();
+    th.tassert(all.size(), (std::size_t)9998, "to_std_unordered_map has every key");
+    th.tassert(all[9999], 9999, "all[9999] == 9999");
+  }
+
+  {
+    const int threads = 8;
+    const int per_thread = 20000;
+    const int keys = 1000;
+    ConcurrentMap m(16);
+    th.message("Concurrent updates and reads from 8 threads");
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; ++t) {
+      workers.emplace_back([&m, t, per_thread, keys] {
+        for(int i = 0; i < per_thread; ++i) {
+          const int key = (i * 7 + t) % keys;
+          m.update(key, [](int& v) { ++v; });
+          int v = 0;
+          // a counter is never decremented, so it is at least 1 now
+          if(!m.get(key, v) || v < 1) {
+            std::abort();
+          }
+          if(i % 100 == 0) {
+            m.erase(keys + t);
+            m.insert_or_assign(keys + t, i);
+          }
+        }
+      });
+    }
+    for(auto& w : workers) {
+      w.join();
+    }
+    th.tassert();
+    long long total = 0;
+    for(int k = 0; k < keys; ++k) {
+      int v = 0;
+      m.get(k, v);
+      total += v;
+    }
+    th.tassert(total, (long long)threads * per_thread, "No increment was lost");
+    th.tassert(m.size(), (std::size_t)(keys + threads), "Size is 1008");
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  th.message("ConcurrentUnorderedMap over OpenAddressUnorderedMap");
+  test_concurrent_map<ConcurrentUnorderedMap<int, int>>(th);
+
+  th.message("ConcurrentUnorderedMap over ChainedUnorderedMap");
+  test_concurrent_map<ConcurrentUnorderedMap<int, int, std::hash<int>, ChainedUnorderedMap<int, int>>>(th);
+
+  {
+    th.message("String keys and values");
+    ConcurrentUnorderedMap<std::string, std::string> m;
+    m.update("a", [](std::string& v) { v += "x"; });
+    m.update("a", [](std::string& v) { v += "y"; });
+    std::string v;
+    th.tassert();
+    th.tassert(m.get("a", v), true, "get finds \"a\"");
+    th.tassert(v, std::string("xy"), "Value is \"xy\"");
+    th.tassert(m.shard_count(), (std::size_t)64, "64 shards by default");
+  }
+
+  th.summary();
+  return 0;
+}
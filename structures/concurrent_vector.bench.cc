@@ -0,0 +1,71 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include "vector.h"
+#include "concurrent_vector.h"
+#include "../bench_helpers.h"
+
+// splits n appends evenly across the given number of threads
+template<class Push>
+void run_threads(std::size_t threads, std::size_t n, Push push) {
+  std::vector<std::thread> workers;
+  for(std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([=] {
+      for(std::size_t i = t; i < n; i += threads) {
+        push(i);
+      }
+    });
+  }
+  for(auto& w : workers) {
+    w.join();
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 22;
+  // the thread counts go up to the number of cores, or to argv[1]
+  std::size_t cores = std::max<unsigned int>(1, std::thread::hardware_concurrency());
+  if(argc > 1) {
+    cores = std::max(1, std::atoi(argv[1]));
+  }
+
+  // powers of two, plus the core count itself when it is not one
+  std::vector<std::size_t> thread_counts;
+  for(std::size_t threads = 1; threads <= cores; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  if(thread_counts.back() != cores) {
+    thread_counts.push_back(cores);
+  }
+
+  std::cout << "\n[[ " << n << " appends split across threads ]]" << std::endl << std::endl;
+  for(std::size_t threads : thread_counts) {
+    std::string mutex_name = "Vector + mutex, " + std::to_string(threads) + " threads";
+    bh.run(mutex_name.c_str(), [=] {
+      Vector<std::size_t> v;
+      std::mutex m;
+      run_threads(threads, n, [&](std::size_t i) {
+        std::lock_guard<std::mutex> lock(m);
+        v.push_back(i);
+      });
+      bench_keep(v.size());
+    });
+
+    std::string concurrent_name = "ConcurrentVector, " + std::to_string(threads) + " threads";
+    bh.run(concurrent_name.c_str(), [=] {
+      ConcurrentVector<std::size_t> v;
+      run_threads(threads, n, [&](std::size_t i) {
+        v.push_back(i);
+      });
+      bench_keep(v.size());
+    });
+  }
+
+  return 0;
+}
@@ -0,0 +1,244 @@
+#ifndef __STRUCTURES_CONCURRENT_VECTOR__
+#define __STRUCTURES_CONCURRENT_VECTOR__
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Append-only vector that many threads can push into at once.
+// Elements live in segments of power-of-two sizes (16, 32, 64, ...) that
+// are never reallocated, so the address of an element never changes.
+//   push_back / emplace_back  reserve an index with one atomic increment
+//                             and construct the element in place; a
+//                             missing segment is allocated and published
+//                             with a CAS (the losers give theirs back),
+//                             so appends are lock-free
+//   operator[] / at           wait-free: a couple of bit operations and
+//                             one atomic load of the segment pointer
+// size() counts reserved indices: an element is only safe to read by a
+// thread that knows it was constructed (it pushed it itself, or got the
+// index from the pushing thread through some synchronization such as a
+// join or an atomic with release/acquire ordering).
+// Destruction, clear() and to_std_vector() must not run concurrently with
+// pushes. T's constructors should not throw: a failed construction would
+// leave a reserved slot without an element.
+template<typename T, class Alloc = std::allocator<T>>
+class ConcurrentVector {
+public:
+  typedef Alloc allocator_type;
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+
+  ConcurrentVector(); // O(1)
+  explicit ConcurrentVector(const Alloc& alloc); // O(1)
+  ConcurrentVector(const ConcurrentVector&) = delete;
+  ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+  virtual ~ConcurrentVector(); // O(n)
+
+  std::size_t capacity() const; // O(log n)
+  std::size_t reserve(std::size_t new_capacity); // O(log new_capacity)
+  std::size_t size() const; // O(1)
+  bool empty() const; // O(1)
+
+  T& at(std::size_t i); // O(1), wait-free
+  const T& at(std::size_t i) const; // O(1), wait-free
+  T& operator[](std::size_t i); // O(1), wait-free
+  const T& operator[](std::size_t i) const; // O(1), wait-free
+
+  std::size_t push_back(const T& e); // O(1), lock-free
+  std::size_t push_back(T&& e); // O(1), lock-free
+  template<typename... Args>
+  std::size_t emplace_back(Args&&... args); // O(1), lock-free
+
+  void clear(); // O(n)
+  std::vector<T> to_std_vector() const; // O(n)
+  Alloc get_allocator() const; // O(1)
+
+private:
+  typedef std::allocator_traits<Alloc> _traits;
+
+  static const std::size_t _first_bits = 4;
+  static const std::size_t _first_size = std::size_t(1) << _first_bits;
+  static const std::size_t _max_segments = 64 - _first_bits;
+
+  // segment k holds indices [16 * (2^k - 1), 16 * (2^(k+1) - 1))
+  static std::size_t _segment_of(std::size_t i);
+  static std::size_t _segment_size(std::size_t k);
+  static std::size_t _segment_start(std::size_t k);
+  T* _slot(std::size_t i) const;
+  T* _segment(std::size_t k);
+
+private:
+  Alloc _alloc;
+  std::atomic<T*> _segments[_max_segments];
+  // kept on its own cache line: every push hits it, reads never do
+  alignas(64) std::atomic<std::size_t> _size;
+};
+
+template<typename T, class Alloc>
+ConcurrentVector<T,Alloc>::ConcurrentVector() : ConcurrentVector(Alloc()) {
+}
+
+template<typename T, class Alloc>
+ConcurrentVector<T,Alloc>::ConcurrentVector(const Alloc& alloc) : _alloc(alloc), _size(0) {
+  for(std::size_t k = 0; k < _max_segments; ++k) {
+    _segments[k].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+template<typename T, class Alloc>
+ConcurrentVector<T,Alloc>::~ConcurrentVector() {
+  clear();
+  for(std::size_t k = 0; k < _max_segments; ++k) {
+    T* seg = _segments[k].load(std::memory_order_relaxed);
+    if(seg != nullptr) {
+      _traits::deallocate(_alloc, seg, _segment_size(k));
+    }
+  }
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::_segment_of(std::size_t i) {
+  // i + 16 has its highest bit at position k + 4 for segment k
+  return (63 - __builtin_clzll((unsigned long long)(i + _first_size))) - _first_bits;
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::_segment_size(std::size_t k) {
+  return _first_size << k;
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::_segment_start(std::size_t k) {
+  return (_first_size << k) - _first_size;
+}
+
+template<typename T, class Alloc>
+T* ConcurrentVector<T,Alloc>::_slot(std::size_t i) const {
+  const std::size_t k = _segment_of(i);
+  return _segments[k].load(std::memory_order_acquire) + (i - _segment_start(k));
+}
+
+// returns segment k, allocating it if nobody did yet
+template<typename T, class Alloc>
+T* ConcurrentVector<T,Alloc>::_segment(std::size_t k) {
+  assert(k < _max_segments);
+  T* seg = _segments[k].load(std::memory_order_acquire);
+  if(seg != nullptr) {
+    return seg;
+  }
+  T* fresh = _traits::allocate(_alloc, _segment_size(k));
+  if(_segments[k].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return fresh;
+  }
+  // another thread published it first, seg now holds its segment
+  _traits::deallocate(_alloc, fresh, _segment_size(k));
+  return seg;
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::capacity() const {
+  std::size_t k = 0;
+  while(k < _max_segments && _segments[k].load(std::memory_order_acquire) != nullptr) {
+    ++k;
+  }
+  return _segment_start(k);
+}
+
+// allocates every segment up to new_capacity, so later pushes below it
+// never allocate; safe to call concurrently with pushes
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::reserve(std::size_t new_capacity) {
+  if(new_capacity > 0) {
+    const std::size_t last = _segment_of(new_capacity - 1);
+    for(std::size_t k = 0; k <= last; ++k) {
+      _segment(k);
+    }
+  }
+  return capacity();
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::size() const {
+  return _size.load(std::memory_order_acquire);
+}
+
+template<typename T, class Alloc>
+bool ConcurrentVector<T,Alloc>::empty() const {
+  return size() == 0;
+}
+
+template<typename T, class Alloc>
+T& ConcurrentVector<T,Alloc>::at(std::size_t i) {
+  return *_slot(i);
+}
+
+template<typename T, class Alloc>
+const T& ConcurrentVector<T,Alloc>::at(std::size_t i) const {
+  return *_slot(i);
+}
+
+template<typename T, class Alloc>
+T& ConcurrentVector<T,Alloc>::operator[](std::size_t i) {
+  return *_slot(i);
+}
+
+template<typename T, class Alloc>
+const T& ConcurrentVector<T,Alloc>::operator[](std::size_t i) const {
+  return *_slot(i);
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::push_back(const T& e) {
+  return emplace_back(e);
+}
+
+template<typename T, class Alloc>
+std::size_t ConcurrentVector<T,Alloc>::push_back(T&& e) {
+  return emplace_back(std::move(e));
+}
+
+// returns the index of the new element
+template<typename T, class Alloc>
+template<typename... Args>
+std::size_t ConcurrentVector<T,Alloc>::emplace_back(Args&&... args) {
+  const std::size_t i = _size.fetch_add(1, std::memory_order_acq_rel);
+  const std::size_t k = _segment_of(i);
+  T* seg = _segment(k);
+  _traits::construct(_alloc, seg + (i - _segment_start(k)), std::forward<Args>(args)...);
+  return i;
+}
+
+// destroys every element but keeps the segments for reuse
+template<typename T, class Alloc>
+void ConcurrentVector<T,Alloc>::clear() {
+  const std::size_t n = size();
+  for(std::size_t i = 0; i < n; ++i) {
+    _traits::destroy(_alloc, _slot(i));
+  }
+  _size.store(0, std::memory_order_release);
+}
+
+template<typename T, class Alloc>
+std::vector<T> ConcurrentVector<T,Alloc>::to_std_vector() const {
+  const std::size_t n = size();
+  std::vector<T> v;
+  v.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    v.push_back(*_slot(i));
+  }
+  return v;
+}
+
+template<typename T, class Alloc>
+Alloc ConcurrentVector<T,Alloc>::get_allocator() const {
+  return _alloc;
+}
+
+#endif
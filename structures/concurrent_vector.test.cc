@@ -0,0 +1,97 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include "concurrent_vector.h"
+#include "../test_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Default construction");
+    ConcurrentVector<int> v;
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)0, "Size is 0");
+    th.tassert(v.capacity(), (std::size_t)0, "Capacity is 0");
+    th.message("Destruction");
+  }
+  th.tassert();
+
+  {
+    ConcurrentVector<std::string> v;
+    th.message("push_back returns the index");
+    th.tassert(v.push_back("a"), (std::size_t)0, "First index is 0");
+    th.tassert(v.emplace_back(3, 'b'), (std::size_t)1, "Second index is 1");
+    th.tassert(v[0], std::string("a"), "v[0] == \"a\"");
+    th.tassert(v.at(1), std::string("bbb"), "v[1] == \"bbb\"");
+    th.tassert(v.capacity(), (std::size_t)16, "Capacity is 16");
+
+    th.message("Element addresses never move");
+    const std::string* first = &v[0];
+    for(int i = 0; i < 1000; ++i) {
+      v.push_back(std::to_string(i));
+    }
+    th.tassert();
+    th.tassert(first == &v[0], true, "&v[0] did not change");
+    th.tassert(v[1001], std::string("999"), "v[1001] == \"999\"");
+    th.tassert(v.capacity(), (std::size_t)1008, "Capacity is 16 + 32 + ... + 512");
+
+    th.message("reserve");
+    th.tassert(v.reserve(5000), (std::size_t)8176, "Capacity is 8176");
+
+    th.message("clear");
+    v.clear();
+    th.tassert();
+    th.tassert(v.empty(), true, "Vector is empty");
+    th.tassert(v.capacity(), (std::size_t)8176, "Segments are kept");
+    v.push_back("again");
+    th.tassert(v[0], std::string("again"), "v[0] == \"again\"");
+  }
+
+  {
+    const std::size_t threads = 8;
+    const std::size_t per_thread = 20000;
+    ConcurrentVector<std::size_t> v;
+    th.message("Concurrent pushes from 8 threads");
+    std::vector<std::thread> workers;
+    for(std::size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&v, t, per_thread] {
+        for(std::size_t i = 0; i < per_thread; ++i) {
+          std::size_t idx = v.push_back(t * per_thread + i);
+          // an own element is readable right away
+          if(v[idx] != t * per_thread + i) {
+            std::abort();
+          }
+        }
+      });
+    }
+    for(auto& w : workers) {
+      w.join();
+    }
+    th.tassert();
+    th.tassert(v.size(), threads * per_thread, "Size is 160000");
+
+    std::vector<std::size_t> all = v.to_std_vector();
+    std::sort(all.begin(), all.end());
+    bool complete = true;
+    for(std::size_t i = 0; i < all.size(); ++i) {
+      complete = complete && all[i] == i;
+    }
+    th.tassert(complete, true, "Every pushed value is present exactly once");
+
+    th.message("Per-thread order is kept");
+    std::vector<std::size_t> last(threads, 0);
+    bool ordered = true;
+    for(std::size_t i = 0; i < v.size(); ++i) {
+      std::size_t t = v[i] / per_thread;
+      ordered = ordered && (last[t] == 0 || v[i] > last[t]);
+      last[t] = v[i];
+    }
+    th.tassert(ordered, true, "Elements of each thread are in push order");
+  }
+
+  th.summary();
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstddef>
+#include <unordered_map>
+#include <unistd.h>
+#include "map.h"
+#include "frozen_map.h"
+#include "../bench_helpers.h"
+
+template<typename Map>
+void bench_lookups(BenchHelper& bh, const std::string& name, const Map& m,
+                   const std::vector<int>& hits, const std::vector<int>& misses) {
+  bh.run((name + " hit").c_str(), [&] {
+    long long sum = 0;
+    for(auto k : hits) {
+      sum += *m.find(k);
+    }
+    bench_keep(sum);
+  });
+  bh.run((name + " miss").c_str(), [&] {
+    std::size_t found = 0;
+    for(auto k : misses) {
+      found += m.find(k) != nullptr;
+    }
+    bench_keep(found);
+  });
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 20;
+  const std::string path = "/tmp/frozen_map_bench_" + std::to_string(::getpid());
+
+  std::vector<std::pair<int, int>> items;
+  std::vector<int> hits, misses;
+  for(std::size_t i = 0; i < n; ++i) {
+    items.push_back(std::make_pair((int)(i * 2654435761u), (int)i));
+    hits.push_back((int)(((i * 7) % n) * 2654435761u));
+    misses.push_back((int)(i * 2654435761u) ^ 1);
+  }
+
+  std::cout << "\n[[ building from " << n << " int entries ]]" << std::endl << std::endl;
+  bh.run("OpenAddressUnorderedMap range constructor", [&] {
+    OpenAddressUnorderedMap<int, int> m(items.begin(), items.end());
+    bench_keep(m.size());
+  });
+  bh.run("FrozenMap range constructor", [&] {
+    FrozenMap<int, int> m(items.begin(), items.end());
+    bench_keep(m.size());
+  });
+
+  OpenAddressUnorderedMap<int, int> open(items.begin(), items.end());
+  CuckooUnorderedMap<int, int> cuckoo(items.begin(), items.end());
+  FrozenMap<int, int> frozen(items.begin(), items.end());
+
+  std::cout << "\n[[ " << n << " int lookups ]]" << std::endl << std::endl;
+  bench_lookups(bh, "OpenAddressUnorderedMap", open, hits, misses);
+  bench_lookups(bh, "CuckooUnorderedMap", cuckoo, hits, misses);
+  bench_lookups(bh, "FrozenMap", frozen, hits, misses);
+
+  std::cout << "\n[[ bytes per element, " << n << " int keys ]]" << std::endl << std::endl;
+  // buckets of (int, int) plus a control byte each, see map.bench.cc
+  bh.report("OpenAddressUnorderedMap", (double)open.bucket_count() * (2 * sizeof(int) + 1) / n);
+  bh.report("FrozenMap", (double)(frozen.bucket_count() * sizeof(std::uint32_t) + n * 2 * sizeof(int)) / n);
+
+  frozen.save(path);
+  std::cout << "\n[[ startup: a table of " << n << " entries ready for lookups ]]" << std::endl << std::endl;
+  bh.run("OpenAddressUnorderedMap rebuilt (before)", [&] {
+    OpenAddressUnorderedMap<int, int> m(items.begin(), items.end());
+    bench_keep(*m.find(hits[0]));
+  });
+  bh.run("FrozenMap::open (after)", [&] {
+    FrozenMap<int, int> m = FrozenMap<int, int>::open(path);
+    bench_keep(*m.find(hits[0]));
+  });
+  std::remove(path.c_str());
+
+  return 0;
+}
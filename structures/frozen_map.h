@@ -0,0 +1,522 @@
+#ifndef __STRUCTURES_FROZEN_MAP__
+#define __STRUCTURES_FROZEN_MAP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "map.h"
+
+// Read-only map over a key set fixed at construction, built with a
+// minimal perfect hash (CHD: compress, hash and displace).
+// The keys are split by hash into buckets of ~_keys_per_bucket keys and
+// every bucket gets a seed such that hashing its keys with that seed
+// sends each of them to a different slot of a table of exactly size()
+// entries, none of them taken by another bucket. A lookup hashes the key
+// once, reads the seed of its bucket (a small array, two bytes per
+// key) and probes exactly one entry, whose key tells whether the key
+// is really in the map. There are no empty slots and no tombstones.
+// Buckets are placed from the largest to the smallest, trying seeds in
+// order; the buckets with a single key that are left over when the table
+// is almost full skip the search and store the free slot they take in
+// their seed directly.
+// save() writes the map as a flat file (header, seeds, entries) and
+// open() maps such a file back read-only, with nothing to rebuild and
+// every process sharing its pages. That needs trivially copyable keys
+// and values, and the same Hash (and platform) that built the file
+template<typename K, typename T, class Hash = std::hash<K>>
+class FrozenMap {
+public:
+  typedef K key_type;
+  typedef T mapped_type;
+
+  FrozenMap(); // O(1)
+  // of repeated keys the first one wins; throws std::invalid_argument if
+  // two different keys have the same hash, which no seed can separate
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  FrozenMap(InputIt first, InputIt last); // O(n) expected
+  FrozenMap(std::initializer_list<std::pair<const K,T>> l); // O(n) expected
+  explicit FrozenMap(const UnorderedMap<K,T>& m); // O(n) expected
+  FrozenMap(const FrozenMap& other); // O(n)
+  FrozenMap(FrozenMap&& rvr); // O(1)
+  FrozenMap& operator=(const FrozenMap& other); // O(n)
+  FrozenMap& operator=(FrozenMap&& other); // O(1)
+  virtual ~FrozenMap(); // O(1)
+
+  // maps a file written by save(); throws std::system_error if it cannot
+  // be opened or mapped and std::runtime_error if it is not a FrozenMap
+  // file of these key and value types
+  static FrozenMap open(const std::string& path); // O(1)
+  // throws std::system_error if the file cannot be written
+  void save(const std::string& path) const; // O(n)
+
+  const T& at(const K& key) const; // O(1)
+  // the value with that key, nullptr if none
+  const T* find(const K& key) const; // O(1)
+  bool contains(const K& key) const; // O(1)
+  // heterogeneous lookups, for a transparent Hash such as StringHash
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  const T* find(const Q& key) const; // O(1)
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  bool contains(const Q& key) const; // O(1)
+
+  std::size_t size() const { return _size; } // O(1)
+  bool empty() const { return size() == 0; } // O(1)
+  std::size_t bucket_count() const { return _bucket_count; } // O(1)
+  // whether the map lives in a file mapped by open()
+  bool mapped() const { return _map_base != nullptr; } // O(1)
+
+  std::unordered_map<K,T> to_std_unordered_map() const; // O(n)
+
+private:
+  struct _entry {
+    K key;
+    T value;
+  };
+
+  struct _Header {
+    std::uint64_t magic;
+    std::uint64_t key_size;
+    std::uint64_t value_size;
+    std::uint64_t entry_size;
+    std::uint64_t size;
+    std::uint64_t bucket_count;
+  };
+
+  static const std::size_t _keys_per_bucket = 2;
+  // a seed with this bit set is the slot of a single-key bucket
+  static const std::uint32_t _direct = 0x80000000u;
+  // seeds tried for a bucket before giving up
+  static const std::uint32_t _max_seed = 1u << 24;
+  static const std::uint64_t _magic = 0x31504d4e5a4f5246ULL; // "FROZNMP1"
+  static const std::size_t _header_bytes = 64;
+
+  template<class Q>
+  std::size_t hash_of(const Q& key) const { return _mix_hash(_hasher(key)); }
+  std::size_t slot_of(std::size_t hash, std::uint32_t seed) const;
+  template<class Q>
+  const T* find_value(const Q& key) const;
+  void build(std::vector<std::pair<K,T>>& items);
+  void point_to_owned();
+  static std::size_t entries_offset(std::size_t bucket_count);
+  void unmap();
+
+private:
+  Hash _hasher;
+  std::size_t _size;
+  std::size_t _bucket_count;
+  // either the owned vectors or a mapped file
+  const std::uint32_t* _seeds;
+  const _entry* _entries;
+  std::vector<std::uint32_t> _own_seeds;
+  std::vector<_entry> _own_entries;
+  void* _map_base;
+  std::size_t _map_bytes;
+};
+
+template<typename K, typename T, class Hash>
+const std::size_t FrozenMap<K,T,Hash>::_keys_per_bucket;
+
+template<typename K, typename T, class Hash>
+const std::uint32_t FrozenMap<K,T,Hash>::_direct;
+
+template<typename K, typename T, class Hash>
+const std::uint32_t FrozenMap<K,T,Hash>::_max_seed;
+
+template<typename K, typename T, class Hash>
+const std::uint64_t FrozenMap<K,T,Hash>::_magic;
+
+template<typename K, typename T, class Hash>
+const std::size_t FrozenMap<K,T,Hash>::_header_bytes;
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>::FrozenMap() :
+_size(0), _bucket_count(0), _seeds(nullptr), _entries(nullptr), _map_base(nullptr), _map_bytes(0) {
+}
+
+template<typename K, typename T, class Hash>
+template<class InputIt, class>
+FrozenMap<K,T,Hash>::FrozenMap(InputIt first, InputIt last) : FrozenMap() {
+  std::vector<std::pair<K,T>> items(first, last);
+  build(items);
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>::FrozenMap(std::initializer_list<std::pair<const K,T>> l) : FrozenMap(l.begin(), l.end()) {
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>::FrozenMap(const UnorderedMap<K,T>& m) : FrozenMap() {
+  auto all = m.to_std_unordered_map();
+  std::vector<std::pair<K,T>> items(all.begin(), all.end());
+  build(items);
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>::FrozenMap(const FrozenMap& other) :
+_hasher(other._hasher),
+_size(other._size),
+_bucket_count(other._bucket_count),
+_own_seeds(other._seeds, other._seeds + other._bucket_count),
+_own_entries(other._entries, other._entries + other._size),
+_map_base(nullptr),
+_map_bytes(0) {
+  point_to_owned();
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>::FrozenMap(FrozenMap&& rvr) :
+_hasher(rvr._hasher),
+_size(rvr._size),
+_bucket_count(rvr._bucket_count),
+_seeds(rvr._seeds),
+_entries(rvr._entries),
+_own_seeds(std::move(rvr._own_seeds)),
+_own_entries(std::move(rvr._own_entries)),
+_map_base(rvr._map_base),
+_map_bytes(rvr._map_bytes) {
+  // moving a vector keeps its buffer, the pointers stay valid
+  rvr._size = 0;
+  rvr._bucket_count = 0;
+  rvr._seeds = nullptr;
+  rvr._entries = nullptr;
+  rvr._map_base = nullptr;
+  rvr._map_bytes = 0;
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>& FrozenMap<K,T,Hash>::operator=(const FrozenMap& other) {
+  if(this != &other) {
+    *this = FrozenMap(other);
+  }
+  return *this;
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>& FrozenMap<K,T,Hash>::operator=(FrozenMap&& other) {
+  if(this != &other) {
+    unmap();
+    _hasher = other._hasher;
+    _size = other._size;
+    _bucket_count = other._bucket_count;
+    _seeds = other._seeds;
+    _entries = other._entries;
+    _own_seeds = std::move(other._own_seeds);
+    _own_entries = std::move(other._own_entries);
+    _map_base = other._map_base;
+    _map_bytes = other._map_bytes;
+    other._size = 0;
+    other._bucket_count = 0;
+    other._seeds = nullptr;
+    other._entries = nullptr;
+    other._map_base = nullptr;
+    other._map_bytes = 0;
+  }
+  return *this;
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash>::~FrozenMap() {
+  unmap();
+}
+
+template<typename K, typename T, class Hash>
+void FrozenMap<K,T,Hash>::unmap() {
+  if(_map_base != nullptr) {
+    ::munmap(_map_base, _map_bytes);
+    _map_base = nullptr;
+    _map_bytes = 0;
+  }
+}
+
+template<typename K, typename T, class Hash>
+void FrozenMap<K,T,Hash>::point_to_owned() {
+  _seeds = _own_seeds.data();
+  _entries = _own_entries.data();
+}
+
+// a seed picks one of many hash functions of the (already mixed) key
+// hash; direct seeds name the slot themselves
+template<typename K, typename T, class Hash>
+std::size_t FrozenMap<K,T,Hash>::slot_of(std::size_t hash, std::uint32_t seed) const {
+  if(seed & _direct) {
+    return seed & ~_direct;
+  }
+  return _mix_hash(hash ^ ((std::size_t)(seed + 1) * (std::size_t)0xC2B2AE3D27D4EB4FULL)) % _size;
+}
+
+template<typename K, typename T, class Hash>
+void FrozenMap<K,T,Hash>::build(std::vector<std::pair<K,T>>& items) {
+  if(items.empty()) {
+    return;
+  }
+  if(items.size() >= _direct) {
+    throw std::length_error("FrozenMap: too many keys");
+  }
+  const std::size_t buckets = (items.size() + _keys_per_bucket - 1) / _keys_per_bucket;
+
+  // the keys of every bucket, in input order (counting sort by bucket)
+  std::vector<std::size_t> hashes(items.size());
+  std::vector<std::size_t> start(buckets + 1, 0);
+  for(std::size_t i = 0; i < items.size(); ++i) {
+    hashes[i] = hash_of(std::get<0>(items[i]));
+    start[hashes[i] % buckets + 1]++;
+  }
+  for(std::size_t b = 0; b < buckets; ++b) {
+    start[b + 1] += start[b];
+  }
+  std::vector<std::size_t> members(items.size());
+  {
+    std::vector<std::size_t> next(start.begin(), start.end() - 1);
+    for(std::size_t i = 0; i < items.size(); ++i) {
+      members[next[hashes[i] % buckets]++] = i;
+    }
+  }
+
+  // equal keys have equal hashes and so share a bucket: only the first
+  // one is kept. Different keys with equal hashes can never be told apart
+  std::vector<std::size_t> sizes(buckets, 0);
+  std::size_t unique = 0;
+  for(std::size_t b = 0; b < buckets; ++b) {
+    for(std::size_t j = start[b]; j < start[b + 1]; ++j) {
+      const auto i = members[j];
+      bool repeated = false;
+      for(std::size_t k = start[b]; k < start[b] + sizes[b] && !repeated; ++k) {
+        if(hashes[members[k]] == hashes[i]) {
+          if(!(std::get<0>(items[members[k]]) == std::get<0>(items[i]))) {
+            throw std::invalid_argument("FrozenMap: different keys with the same hash");
+          }
+          repeated = true;
+        }
+      }
+      if(!repeated) {
+        members[start[b] + sizes[b]++] = i;
+      }
+    }
+    unique += sizes[b];
+  }
+
+  _size = unique;
+  _bucket_count = buckets;
+  _own_seeds.assign(buckets, 0);
+
+  // largest buckets first, while most slots are still free
+  std::vector<std::size_t> order(buckets);
+  for(std::size_t b = 0; b < buckets; ++b) {
+    order[b] = b;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+  std::vector<bool> taken(_size, false);
+  std::vector<std::size_t> slot_of_item(items.size(), _size);
+  std::vector<std::size_t> slots;
+  std::size_t next_free = 0;
+  for(auto b : order) {
+    if(sizes[b] == 0) {
+      break;
+    }
+    if(sizes[b] == 1) {
+      // every bigger bucket is placed: hand out the free slots in order
+      while(taken[next_free]) {
+        ++next_free;
+      }
+      taken[next_free] = true;
+      _own_seeds[b] = _direct | (std::uint32_t)next_free;
+      slot_of_item[members[start[b]]] = next_free;
+      continue;
+    }
+    std::uint32_t seed = 0;
+    for(; seed < _max_seed; ++seed) {
+      slots.clear();
+      bool fits = true;
+      for(std::size_t j = start[b]; j < start[b] + sizes[b] && fits; ++j) {
+        const auto s = slot_of(hashes[members[j]], seed);
+        fits = !taken[s] && std::find(slots.begin(), slots.end(), s) == slots.end();
+        slots.push_back(s);
+      }
+      if(fits) {
+        break;
+      }
+    }
+    if(seed == _max_seed) {
+      throw std::runtime_error("FrozenMap: no seed places a bucket");
+    }
+    _own_seeds[b] = seed;
+    for(std::size_t k = 0; k < sizes[b]; ++k) {
+      taken[slots[k]] = true;
+      slot_of_item[members[start[b] + k]] = slots[k];
+    }
+  }
+
+  // entries in slot order
+  std::vector<std::size_t> item_of_slot(_size);
+  for(std::size_t i = 0; i < items.size(); ++i) {
+    if(slot_of_item[i] < _size) {
+      item_of_slot[slot_of_item[i]] = i;
+    }
+  }
+  _own_entries.clear();
+  _own_entries.reserve(_size);
+  for(auto i : item_of_slot) {
+    _own_entries.push_back(_entry{std::move(std::get<0>(items[i])), std::move(std::get<1>(items[i]))});
+  }
+  point_to_owned();
+}
+
+template<typename K, typename T, class Hash>
+template<class Q>
+const T* FrozenMap<K,T,Hash>::find_value(const Q& key) const {
+  if(_size == 0) {
+    return nullptr;
+  }
+  const auto hash = hash_of(key);
+  const _entry& e = _entries[slot_of(hash, _seeds[hash % _bucket_count])];
+  return key == e.key ? &e.value : nullptr;
+}
+
+template<typename K, typename T, class Hash>
+const T& FrozenMap<K,T,Hash>::at(const K& key) const {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+template<typename K, typename T, class Hash>
+const T* FrozenMap<K,T,Hash>::find(const K& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash>
+bool FrozenMap<K,T,Hash>::contains(const K& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash>
+template<class Q, class H, class>
+const T* FrozenMap<K,T,Hash>::find(const Q& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash>
+template<class Q, class H, class>
+bool FrozenMap<K,T,Hash>::contains(const Q& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash>
+std::unordered_map<K,T> FrozenMap<K,T,Hash>::to_std_unordered_map() const {
+  std::unordered_map<K,T> m;
+  for(std::size_t i = 0; i < _size; ++i) {
+    m[_entries[i].key] = _entries[i].value;
+  }
+  return m;
+}
+
+// the seeds follow the header and the entries start at the next multiple
+// of 64 bytes, which keeps them aligned in a page-aligned mapping
+template<typename K, typename T, class Hash>
+std::size_t FrozenMap<K,T,Hash>::entries_offset(std::size_t bucket_count) {
+  return (_header_bytes + bucket_count * sizeof(std::uint32_t) + 63) / 64 * 64;
+}
+
+template<typename K, typename T, class Hash>
+void FrozenMap<K,T,Hash>::save(const std::string& path) const {
+  static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<T>::value,
+                "FrozenMap files need trivially copyable keys and values");
+  static_assert(alignof(_entry) <= 64, "Entries are stored 64-byte aligned");
+
+  std::vector<char> bytes(entries_offset(_bucket_count) + _size * sizeof(_entry), 0);
+  _Header h = {_magic, sizeof(K), sizeof(T), sizeof(_entry), _size, _bucket_count};
+  std::memcpy(bytes.data(), &h, sizeof(h));
+  if(_bucket_count > 0) {
+    std::memcpy(bytes.data() + _header_bytes, _seeds, _bucket_count * sizeof(std::uint32_t));
+  }
+  if(_size > 0) {
+    std::memcpy(bytes.data() + entries_offset(_bucket_count), _entries, _size * sizeof(_entry));
+  }
+
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+  }
+  for(std::size_t written = 0; written < bytes.size(); ) {
+    auto n = ::write(fd, bytes.data() + written, bytes.size() - written);
+    if(n < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "cannot write " + path);
+    }
+    written += (std::size_t)n;
+  }
+  ::close(fd);
+}
+
+template<typename K, typename T, class Hash>
+FrozenMap<K,T,Hash> FrozenMap<K,T,Hash>::open(const std::string& path) {
+  static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<T>::value,
+                "FrozenMap files need trivially copyable keys and values");
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+  }
+  struct stat st;
+  if(::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error(err, std::generic_category(), "cannot stat " + path);
+  }
+  const std::size_t file_bytes = (std::size_t)st.st_size;
+  if(file_bytes < _header_bytes) {
+    ::close(fd);
+    throw std::runtime_error(path + " is not a FrozenMap file of these types");
+  }
+  void* base = ::mmap(nullptr, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+  int err = errno;
+  // the mapping keeps the file alive
+  ::close(fd);
+  if(base == MAP_FAILED) {
+    throw std::system_error(err, std::generic_category(), "cannot map " + path);
+  }
+
+  _Header h;
+  std::memcpy(&h, base, sizeof(h));
+  if(h.magic != _magic || h.key_size != sizeof(K) || h.value_size != sizeof(T) ||
+     h.entry_size != sizeof(_entry) || (h.size == 0) != (h.bucket_count == 0) ||
+     entries_offset(h.bucket_count) + h.size * sizeof(_entry) != file_bytes) {
+    ::munmap(base, file_bytes);
+    throw std::runtime_error(path + " is not a FrozenMap file of these types");
+  }
+
+  FrozenMap m;
+  m._size = h.size;
+  m._bucket_count = h.bucket_count;
+  m._seeds = reinterpret_cast<const std::uint32_t*>(static_cast<const char*>(base) + _header_bytes);
+  m._entries = reinterpret_cast<const _entry*>(static_cast<const char*>(base) + entries_offset(h.bucket_count));
+  m._map_base = base;
+  m._map_bytes = file_bytes;
+  return m;
+}
+
+#endif
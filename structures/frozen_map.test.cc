@@ -0,0 +1,137 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include <stdexcept>
+#include <unistd.h>
+#include "frozen_map.h"
+#include "../test_helpers.h"
+
+// every key has the same hash
+struct ConstantHash {
+  std::size_t operator()(int) const { return 7; }
+};
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+  const std::string path = "/tmp/frozen_map_test_" + std::to_string(::getpid());
+
+  {
+    th.message("Default construction");
+    FrozenMap<int, int> m;
+    th.tassert();
+    th.tassert(m.empty(), true, "Map is empty");
+    th.tassert(m.find(1) == nullptr, true, "find(1) is nullptr");
+  }
+
+  {
+    th.message("Initializer list construction");
+    FrozenMap<std::string, int> m = {{"one", 1}, {"two", 2}, {"three", 3}, {"one", 11}};
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)3, "Size is 3");
+    th.tassert(m.at("two"), 2, "m.at(\"two\") == 2");
+    th.tassert(m.at("one"), 1, "First of a repeated key wins");
+    th.tassert(m.contains("four"), false, "Does not contain \"four\"");
+    bool thrown = false;
+    try {
+      m.at("four");
+    } catch(std::out_of_range&) {
+      thrown = true;
+    }
+    th.tassert(thrown, true, "at(\"four\") throws");
+  }
+
+  {
+    const int n = 100000;
+    OpenAddressUnorderedMap<int, int> source;
+    for(int i = 0; i < n; ++i) {
+      source[i * 7919] = i;
+    }
+    th.message("Construction from an UnorderedMap");
+    FrozenMap<int, int> m(source);
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)n, "Size is 100000");
+    th.tassert(m.to_std_unordered_map() == source.to_std_unordered_map(), true, "Equal maps");
+    bool all = true;
+    for(int i = 0; i < n; ++i) {
+      const int* v = m.find(i * 7919);
+      all = all && v != nullptr && *v == i;
+    }
+    th.tassert(all, true, "Every key is found");
+    bool none = true;
+    for(int i = 0; i < n; ++i) {
+      none = none && !m.contains(i * 7919 + 1);
+    }
+    th.tassert(none, true, "No other key is found");
+    th.tassert(m.bucket_count() <= (std::size_t)n / 2 + 1, true, "About 2 keys per bucket");
+
+    th.message("Save and map the flat file");
+    m.save(path);
+    FrozenMap<int, int> mapped = FrozenMap<int, int>::open(path);
+    th.tassert();
+    th.tassert(mapped.mapped(), true, "Map lives in the mapped file");
+    th.tassert(mapped.size(), (std::size_t)n, "Size is 100000");
+    all = true;
+    for(int i = 0; i < n; ++i) {
+      all = all && mapped.at(i * 7919) == i;
+    }
+    th.tassert(all, true, "Every key is found in the mapped file");
+    th.tassert(mapped.contains(1), false, "Does not contain 1");
+
+    th.message("Copies of a mapped map own their data");
+    FrozenMap<int, int> copy = mapped;
+    FrozenMap<int, int> moved = std::move(mapped);
+    th.tassert();
+    th.tassert(copy.mapped(), false, "Copy is not mapped");
+    th.tassert(moved.mapped(), true, "Moved-to map keeps the mapping");
+    th.tassert(copy.at(7919 * 5) + moved.at(7919 * 6), 11, "Both find their keys");
+  }
+
+  {
+    th.message("Files of other types are rejected");
+    FrozenMap<std::int64_t, std::int64_t> m = {{1, 1}};
+    m.save(path);
+    bool thrown = false;
+    try {
+      FrozenMap<int, int>::open(path);
+    } catch(std::runtime_error&) {
+      thrown = true;
+    }
+    th.tassert();
+    th.tassert(thrown, true, "open() throws");
+    FrozenMap<std::int64_t, std::int64_t> empty;
+    empty.save(path);
+    th.tassert(FrozenMap<std::int64_t, std::int64_t>::open(path).empty(), true, "An empty map round-trips");
+  }
+  std::remove(path.c_str());
+
+  {
+    th.message("Keys with equal hashes cannot be frozen");
+    std::vector<std::pair<int, int>> items = {{1, 1}, {2, 2}};
+    bool thrown = false;
+    try {
+      FrozenMap<int, int, ConstantHash> m(items.begin(), items.end());
+    } catch(std::invalid_argument&) {
+      thrown = true;
+    }
+    th.tassert();
+    th.tassert(thrown, true, "Construction throws");
+  }
+
+  {
+    th.message("Heterogeneous lookup with a transparent hash");
+    std::vector<std::pair<std::string, int>> items;
+    for(int i = 0; i < 1000; ++i) {
+      items.push_back(std::make_pair("symbol_" + std::to_string(i), i));
+    }
+    FrozenMap<std::string, int, StringHash> m(items.begin(), items.end());
+    th.tassert();
+    th.tassert(*m.find("symbol_999"), 999, "find(const char*) finds \"symbol_999\"");
+    th.tassert(m.contains("symbol_1000"), false, "Does not contain \"symbol_1000\"");
+  }
+
+  th.summary();
+  return 0;
+}
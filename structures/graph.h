@@ -8,6 +8,7 @@
 #include <numeric>
 #include <unordered_set>
 #include <unordered_map>
+#include "bit_vector.h"
 
 // TODO: Improve iterators meta-compatibility
 template<typename _VT = int>
@@ -198,18 +199,16 @@ public:
   void add_edge(edge_type e) {
     assert(e.first < _nvertices);
     assert(e.second < _nvertices);
-    _vertices[_idx(e.first, e.second)] = true;
+    _vertices.set(_idx(e.first, e.second));
   }
   void remove_edge(edge_type e) {
     assert(e.first < _nvertices);
     assert(e.second < _nvertices);
-    _vertices[_idx(e.first, e.second)] = false;
+    _vertices.reset(_idx(e.first, e.second));
   }
   std::size_t edge_count() const {
-    // TODO: improve speed by saving edge count
-    std::size_t count = 0;
-    for (auto edge_it = edges(); !edge_it.end(); ++edge_it, ++count);
-    return count;
+    // one popcount per 64 cells of the matrix
+    return _vertices.count();
   }
 
   bool empty() const {
@@ -217,7 +216,7 @@ public:
   }
 
 private:
-  typedef std::vector<bool> list_type;
+  typedef BitVector<> list_type;
   std::size_t _nvertices;
   list_type _vertices;
 
@@ -230,9 +229,10 @@ public:
   public:
     AMDEdgeIterator(
       const list_type& v,
+      std::size_t nv,
       std::size_t current,
       std::size_t end
-    ) : _nv(sqrt(v.size())), _v(v), _current(current), _end(end) {
+    ) : _nv(nv), _v(v), _current(current), _end(end) {
       skip_empty();
     }
 
@@ -257,20 +257,20 @@ public:
     std::size_t _end;
 
     void skip_empty() {
-      while (!end() && !_v[_current]) {
-        ++_current;
-      }
+      // whole words of absent edges are skipped at once, and the scan
+      // never reads past _end, so adjacent() only touches its own row
+      _current = _v.find_next_set(_current, _end);
     }
   };
 
 public:
   AMDEdgeIterator edges() const {
-    return AMDEdgeIterator(_vertices, 0, _idx(_nvertices, 0));
+    return AMDEdgeIterator(_vertices, _nvertices, 0, _idx(_nvertices, 0));
   }
 
   AMDEdgeIterator adjacent(vertex_type n) const {
     assert(n < vertex_count());
-    return AMDEdgeIterator(_vertices, _idx(n, 0), _idx(n + 1, 0));
+    return AMDEdgeIterator(_vertices, _nvertices, _idx(n, 0), _idx(n + 1, 0));
   }
 };
 
@@ -28,6 +28,34 @@ int main(int argc, char const *argv[]) {
       std::cout << "(" << (*it).first << "," << (*it).second << ") ";
     }
     std::cout << std::endl;
+
+    th.message("Adjacency matrix edge count");
+    th.tassert(g.edge_count(), (std::size_t)7, "7 edges");
+    g.remove_edge({ 2, 8 });
+    th.tassert(g.edge_count(), (std::size_t)6, "6 edges after removing (2,8)");
+
+    th.message("Adjacency matrix neighbours");
+    std::string adjacent;
+    for (auto it = g.adjacent(2); !it.end(); ++it) {
+      adjacent += std::to_string((*it).second);
+    }
+    th.tassert(adjacent, std::string("39"), "2 -> 3, 9");
+    th.tassert(g.adjacent(9).end(), true, "9 has no neighbours");
+  }
+
+  {
+    th.message("Adjacency matrix neighbours stop at the end of the row");
+    AdjacencyMatrixDiGraph g(100);
+    g.add_edge({ 3, 97 });
+    g.add_edge({ 4, 0 });
+    g.add_edge({ 4, 50 });
+    g.add_edge({ 5, 5 });
+    std::string adjacent;
+    for (auto it = g.adjacent(3); !it.end(); ++it) {
+      adjacent += std::to_string((*it).first) + ">" + std::to_string((*it).second) + " ";
+    }
+    th.tassert(adjacent, std::string("3>97 "), "3 -> 97 only, not row 4");
+    th.tassert(g.adjacent(2).end(), true, "2 has no neighbours even though 3 has");
   }
 
   {
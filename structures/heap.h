@@ -23,8 +23,11 @@ public:
   virtual std::size_t size() const;
   virtual bool empty() const;
 
-  static void make_heap(std::vector<T>& v, std::size_t last);
-  static T pop_top(std::vector<T>& v, std::size_t last);
+  // work in place on any random access container of T (std::vector, Vector)
+  template<class ArrayLike>
+  static void make_heap(ArrayLike& v, std::size_t last);
+  template<class ArrayLike>
+  static T pop_top(ArrayLike& v, std::size_t last);
 
 protected:
   static std::size_t _root();
@@ -33,8 +36,10 @@ protected:
   static std::size_t _right(std::size_t i);
   static bool _is_leaf(std::size_t i);
 
-  static std::size_t _bubble_down(std::vector<T>& v, std::size_t i, std::size_t last);
-  static std::size_t _bubble_up(std::vector<T>& v, std::size_t i);
+  template<class ArrayLike>
+  static std::size_t _bubble_down(ArrayLike& v, std::size_t i, std::size_t last);
+  template<class ArrayLike>
+  static std::size_t _bubble_up(ArrayLike& v, std::size_t i);
 
 protected:
   std::vector<T> _v;
@@ -95,7 +100,8 @@ T Heap<T,Comp>::pop_top() {
 }
 
 template<typename T, class Comp>
-T Heap<T,Comp>::pop_top(std::vector<T>& v, std::size_t last) {
+template<class ArrayLike>
+T Heap<T,Comp>::pop_top(ArrayLike& v, std::size_t last) {
   T ret = std::move(v[_root()]);
   std::swap(v[_root()], v[last]);
 
@@ -107,7 +113,8 @@ T Heap<T,Comp>::pop_top(std::vector<T>& v, std::size_t last) {
 }
 
 template<typename T, class Comp>
-std::size_t Heap<T,Comp>::_bubble_down(std::vector<T>& v, std::size_t i, std::size_t last) {
+template<class ArrayLike>
+std::size_t Heap<T,Comp>::_bubble_down(ArrayLike& v, std::size_t i, std::size_t last) {
   static Comp _comp;
   while(i < last) {
     const std::size_t left = _left(i);
@@ -133,7 +140,8 @@ std::size_t Heap<T,Comp>::_bubble_down(std::vector<T>& v, std::size_t i, std::si
 }
 
 template<typename T, class Comp>
-std::size_t Heap<T,Comp>::_bubble_up(std::vector<T>& v, std::size_t i) {
+template<class ArrayLike>
+std::size_t Heap<T,Comp>::_bubble_up(ArrayLike& v, std::size_t i) {
   static Comp _comp;
   while (i > _root()) {
     const std::size_t parent = _parent(i);
@@ -149,7 +157,8 @@ std::size_t Heap<T,Comp>::_bubble_up(std::vector<T>& v, std::size_t i) {
 }
 
 template<typename T, class Comp>
-void Heap<T,Comp>::make_heap(std::vector<T>& v, std::size_t last) {
+template<class ArrayLike>
+void Heap<T,Comp>::make_heap(ArrayLike& v, std::size_t last) {
   for (std::size_t i = std::ceil(last / 2.0); i > 0; --i) {
     _bubble_down(v, i - 1, last);
   }
@@ -4,7 +4,10 @@
 #include <cstddef>
 #include <cassert>
 #include <memory>
+#include <utility>
+#include <type_traits>
 #include <list>
+#include "arena.h"
 
 // List interface
 template<typename T>
@@ -38,10 +41,13 @@ public:
 };
 
 // Singly-linked List implementation (without sentinels)
-template<typename T>
+template<typename T, class Alloc = std::allocator<T>>
 class SinglyLinkedList : public List<T> {
 public:
+  typedef Alloc allocator_type;
+
   SinglyLinkedList(); // O(1)
+  explicit SinglyLinkedList(const Alloc& alloc); // O(1)
   SinglyLinkedList(const SinglyLinkedList& o); // O(n)
   SinglyLinkedList(SinglyLinkedList&& o); // O(1)
   ~SinglyLinkedList(); // O(n)
@@ -78,30 +84,43 @@ private:
     Node* next;
   };
 
+  typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> _node_alloc_type;
+  typedef std::allocator_traits<_node_alloc_type> _node_traits;
+
+  _node_alloc_type _node_alloc;
   Node* _head;
   std::size_t _size;
 
   Node* get_node_at(std::size_t i) const;
+  template<typename... Args>
+  Node* _new_node(Args&&... args);
+  void _delete_node(Node* n);
 };
 
-template<typename T>
-SinglyLinkedList<T>::Node::Node(const T& v, Node* n) : data(v), next(n) {
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::Node::Node(const T& v, Node* n) : data(v), next(n) {
 }
 
-template<typename T>
-SinglyLinkedList<T>::Node::Node(T&& prv, Node* n) : data(std::move(prv)), next(n) {
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::Node::Node(T&& prv, Node* n) : data(std::move(prv)), next(n) {
 }
 
-template<typename T>
-SinglyLinkedList<T>::SinglyLinkedList() : _head(nullptr), _size(0) {
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::SinglyLinkedList() : _node_alloc(), _head(nullptr), _size(0) {
 }
 
-template<typename T>
-SinglyLinkedList<T>::SinglyLinkedList(const SinglyLinkedList& o) : _head(nullptr), _size(0) {
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::SinglyLinkedList(const Alloc& alloc) : _node_alloc(alloc), _head(nullptr), _size(0) {
+}
+
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::SinglyLinkedList(const SinglyLinkedList& o) :
+_node_alloc(_node_traits::select_on_container_copy_construction(o._node_alloc)),
+_head(nullptr), _size(0) {
   Node* oit = o._head;
   Node** current = &_head;
   while(oit != nullptr) {
-    *current = new Node(oit->data);
+    *current = _new_node(oit->data);
     _size++;
     // next pointer of current will be updated in the following cycle
     current = &((*current)->next);
@@ -109,62 +128,62 @@ SinglyLinkedList<T>::SinglyLinkedList(const SinglyLinkedList& o) : _head(nullptr
   }
 }
 
-template<typename T>
-SinglyLinkedList<T>::SinglyLinkedList(SinglyLinkedList&& o) : _head(o._head), _size(o._size) {
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::SinglyLinkedList(SinglyLinkedList&& o) : _node_alloc(o._node_alloc), _head(o._head), _size(o._size) {
   o._head = nullptr;
   o._size = 0;
 }
 
-template<typename T>
-bool SinglyLinkedList<T>::empty() const {
+template<typename T, class Alloc>
+bool SinglyLinkedList<T,Alloc>::empty() const {
   return _head == nullptr;
 }
 
-template<typename T>
-std::size_t SinglyLinkedList<T>::size() const {
+template<typename T, class Alloc>
+std::size_t SinglyLinkedList<T,Alloc>::size() const {
   return _size;
 }
 
-template<typename T>
-SinglyLinkedList<T>::~SinglyLinkedList() {
+template<typename T, class Alloc>
+SinglyLinkedList<T,Alloc>::~SinglyLinkedList() {
   clear();
 }
 
-template<typename T>
-T& SinglyLinkedList<T>::value_at(std::size_t i) {
+template<typename T, class Alloc>
+T& SinglyLinkedList<T,Alloc>::value_at(std::size_t i) {
   assert(i >= 0 && i < size());
   return get_node_at(i)->data;
 }
 
-template<typename T>
-const T& SinglyLinkedList<T>::value_at(std::size_t i) const {
+template<typename T, class Alloc>
+const T& SinglyLinkedList<T,Alloc>::value_at(std::size_t i) const {
   assert(i >= 0 && i < size());
   return get_node_at(i)->data;
 }
 
-template<typename T>
-T& SinglyLinkedList<T>::front() {
+template<typename T, class Alloc>
+T& SinglyLinkedList<T,Alloc>::front() {
   return value_at(0);
 }
 
-template<typename T>
-T& SinglyLinkedList<T>::back() {
+template<typename T, class Alloc>
+T& SinglyLinkedList<T,Alloc>::back() {
   return value_at(size() - 1);
 }
 
-template<typename T>
-const T& SinglyLinkedList<T>::front() const {
+template<typename T, class Alloc>
+const T& SinglyLinkedList<T,Alloc>::front() const {
   return value_at(0);
 }
 
-template<typename T>
-const T& SinglyLinkedList<T>::back() const {
+template<typename T, class Alloc>
+const T& SinglyLinkedList<T,Alloc>::back() const {
   return value_at(size() - 1);
 }
 
-template<typename T>
-typename SinglyLinkedList<T>::Node*
-SinglyLinkedList<T>::get_node_at(std::size_t i) const {
+template<typename T, class Alloc>
+typename SinglyLinkedList<T,Alloc>::Node*
+SinglyLinkedList<T,Alloc>::get_node_at(std::size_t i) const {
   assert(i >= 0 && i < size());
   Node* current = _head;
   while(i > 0) {
@@ -174,93 +193,116 @@ SinglyLinkedList<T>::get_node_at(std::size_t i) const {
   return current;
 }
 
-template<typename T>
-void SinglyLinkedList<T>::clear() {
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::clear() {
+  if(is_monotonic_allocator<_node_alloc_type>::value &&
+     std::is_trivially_destructible<T>::value) {
+    // nodes are neither destroyed nor deallocated one by one,
+    // their memory goes away with the arena
+    _head = nullptr;
+    _size = 0;
+    return;
+  }
   while(!empty()) {
     pop_front();
   }
 }
 
-template<typename T>
-void SinglyLinkedList<T>::insert_at(std::size_t i, const T& v) {
+template<typename T, class Alloc>
+template<typename... Args>
+typename SinglyLinkedList<T,Alloc>::Node*
+SinglyLinkedList<T,Alloc>::_new_node(Args&&... args) {
+  Node* n = _node_traits::allocate(_node_alloc, 1);
+  _node_traits::construct(_node_alloc, n, std::forward<Args>(args)...);
+  return n;
+}
+
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::_delete_node(Node* n) {
+  _node_traits::destroy(_node_alloc, n);
+  _node_traits::deallocate(_node_alloc, n, 1);
+}
+
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::insert_at(std::size_t i, const T& v) {
   assert(i >= 0 && i <= size());
   if(i == 0) {
-    _head = new Node(v, _head);
+    _head = _new_node(v, _head);
   } else {
     // from the assert and first condition we know that here size() > 0
     Node* before_at = get_node_at(i - 1);
-    before_at->next = new Node(v, before_at->next);
+    before_at->next = _new_node(v, before_at->next);
   }
   _size++;
 }
 
 // find out how to de-duplicate code regarding lvalues and rvalue references
-template<typename T>
-void SinglyLinkedList<T>::insert_at(std::size_t i, T&& v) {
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::insert_at(std::size_t i, T&& v) {
   assert(i >= 0 && i <= size());
   if(i == 0) {
-    _head = new Node(v, _head);
+    _head = _new_node(std::move(v), _head);
   } else {
     // from the assert and first condition we know that here size() > 0
     Node* before_at = get_node_at(i - 1);
-    before_at->next = new Node(std::move(v), before_at->next);
+    before_at->next = _new_node(std::move(v), before_at->next);
   }
   _size++;
 }
 
-template<typename T>
-T SinglyLinkedList<T>::remove_at(std::size_t i) {
+template<typename T, class Alloc>
+T SinglyLinkedList<T,Alloc>::remove_at(std::size_t i) {
   assert(i >= 0 && i < size());
   if(i == 0) {
     Node* old_head = _head;
     T ret = std::move(old_head->data);
     _head = _head->next;
-    delete old_head;
+    _delete_node(old_head);
     _size--;
     return ret;
   } else {
     // there are at least 2 nodes
     Node* before_last = get_node_at(size() - 2);
     T ret = std::move(before_last->next->data);
-    delete before_last->next;
+    _delete_node(before_last->next);
     before_last->next = nullptr;
     _size--;
     return ret;
   }
 }
 
-template<typename T>
-void SinglyLinkedList<T>::push_back(const T& v) {
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::push_back(const T& v) {
   return insert_at(size(), v);
 }
 
-template<typename T>
-void SinglyLinkedList<T>::push_back(T&& v) {
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::push_back(T&& v) {
   return insert_at(size(), v);
 }
 
-template<typename T>
-void SinglyLinkedList<T>::push_front(const T& v) {
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::push_front(const T& v) {
   return insert_at(0, v);
 }
 
-template<typename T>
-void SinglyLinkedList<T>::push_front(T&& v) {
+template<typename T, class Alloc>
+void SinglyLinkedList<T,Alloc>::push_front(T&& v) {
   return insert_at(0, v);
 }
 
-template<typename T>
-T SinglyLinkedList<T>::pop_front() {
+template<typename T, class Alloc>
+T SinglyLinkedList<T,Alloc>::pop_front() {
   return remove_at(0);
 }
 
-template<typename T>
-T SinglyLinkedList<T>::pop_back() {
+template<typename T, class Alloc>
+T SinglyLinkedList<T,Alloc>::pop_back() {
   return remove_at(size() - 1);
 }
 
-template<typename T>
-std::list<T> SinglyLinkedList<T>::to_std_list() const {
+template<typename T, class Alloc>
+std::list<T> SinglyLinkedList<T,Alloc>::to_std_list() const {
   std::list<T> ret;
   Node* current{_head};
   while(current != nullptr) {
@@ -271,10 +313,13 @@ std::list<T> SinglyLinkedList<T>::to_std_list() const {
 }
 
 // Doubly-linked List implementation (without sentinels)
-template<typename T>
+template<typename T, class Alloc = std::allocator<T>>
 class DoublyLinkedList : public List<T> {
 public:
+  typedef Alloc allocator_type;
+
   DoublyLinkedList(); // O(1)
+  explicit DoublyLinkedList(const Alloc& alloc); // O(1)
   DoublyLinkedList(const DoublyLinkedList& o); // O(n)
   DoublyLinkedList(DoublyLinkedList&& o); // O(1)
   ~DoublyLinkedList(); // O(n)
@@ -314,40 +359,53 @@ private:
     Node* next;
   };
 
+  typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> _node_alloc_type;
+  typedef std::allocator_traits<_node_alloc_type> _node_traits;
+
+  _node_alloc_type _node_alloc;
   Node* _head;
   Node* _tail;
   std::size_t _size;
 
   Node* get_node_at(std::size_t i) const;
   void push_all(const DoublyLinkedList& o);
+  template<typename... Args>
+  Node* _new_node(Args&&... args);
+  void _delete_node(Node* n);
 };
 
-template<typename T>
-DoublyLinkedList<T>::Node::Node(const T& v, Node* n, Node* p) : data(v), prev(p), next(n) {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::Node::Node(const T& v, Node* n, Node* p) : data(v), prev(p), next(n) {
 }
 
-template<typename T>
-DoublyLinkedList<T>::Node::Node(T&& prv, Node* n, Node* p) : data(std::move(prv)), prev(p), next(n) {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::Node::Node(T&& prv, Node* n, Node* p) : data(std::move(prv)), prev(p), next(n) {
 }
 
-template<typename T>
-DoublyLinkedList<T>::DoublyLinkedList() : _head(nullptr), _tail(nullptr), _size(0) {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::DoublyLinkedList() : _node_alloc(), _head(nullptr), _tail(nullptr), _size(0) {
 }
 
-template<typename T>
-DoublyLinkedList<T>::DoublyLinkedList(const DoublyLinkedList& o) : _head(nullptr), _tail(nullptr), _size(0) {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::DoublyLinkedList(const Alloc& alloc) : _node_alloc(alloc), _head(nullptr), _tail(nullptr), _size(0) {
+}
+
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::DoublyLinkedList(const DoublyLinkedList& o) :
+_node_alloc(_node_traits::select_on_container_copy_construction(o._node_alloc)),
+_head(nullptr), _tail(nullptr), _size(0) {
   push_all(o);
 }
 
-template<typename T>
-DoublyLinkedList<T>::DoublyLinkedList(DoublyLinkedList&& o) : _head(o._head), _tail(o._tail), _size(o._size) {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::DoublyLinkedList(DoublyLinkedList&& o) : _node_alloc(o._node_alloc), _head(o._head), _tail(o._tail), _size(o._size) {
   o._head = nullptr;
   o._tail = nullptr;
   o._size = 0;
 }
 
-template<typename T>
-DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(const DoublyLinkedList& l) {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>& DoublyLinkedList<T,Alloc>::operator=(const DoublyLinkedList& l) {
   if(this != &l) {
     clear();
     push_all(l);
@@ -355,13 +413,13 @@ DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(const DoublyLinkedList& l) {
   return *this;
 }
 
-template<typename T>
-void DoublyLinkedList<T>::push_all(const DoublyLinkedList& o) {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::push_all(const DoublyLinkedList& o) {
   Node* oit = o._head;
   Node** current = &_head;
   Node* last = nullptr;
   while(oit != nullptr) {
-    *current = new Node(oit->data, nullptr, last);
+    *current = _new_node(oit->data, nullptr, last);
     last = *current;
     _size++;
     // next pointer of current will be updated in the following cycle
@@ -371,56 +429,56 @@ void DoublyLinkedList<T>::push_all(const DoublyLinkedList& o) {
   _tail = last;
 }
 
-template<typename T>
-bool DoublyLinkedList<T>::empty() const {
+template<typename T, class Alloc>
+bool DoublyLinkedList<T,Alloc>::empty() const {
   return _head == nullptr;
 }
 
-template<typename T>
-std::size_t DoublyLinkedList<T>::size() const {
+template<typename T, class Alloc>
+std::size_t DoublyLinkedList<T,Alloc>::size() const {
   return _size;
 }
 
-template<typename T>
-DoublyLinkedList<T>::~DoublyLinkedList() {
+template<typename T, class Alloc>
+DoublyLinkedList<T,Alloc>::~DoublyLinkedList() {
   clear();
 }
 
-template<typename T>
-T& DoublyLinkedList<T>::value_at(std::size_t i) {
+template<typename T, class Alloc>
+T& DoublyLinkedList<T,Alloc>::value_at(std::size_t i) {
   assert(i >= 0 && i < size());
   return get_node_at(i)->data;
 }
 
-template<typename T>
-const T& DoublyLinkedList<T>::value_at(std::size_t i) const {
+template<typename T, class Alloc>
+const T& DoublyLinkedList<T,Alloc>::value_at(std::size_t i) const {
   assert(i >= 0 && i < size());
   return get_node_at(i)->data;
 }
 
-template<typename T>
-T& DoublyLinkedList<T>::front() {
+template<typename T, class Alloc>
+T& DoublyLinkedList<T,Alloc>::front() {
   return value_at(0);
 }
 
-template<typename T>
-T& DoublyLinkedList<T>::back() {
+template<typename T, class Alloc>
+T& DoublyLinkedList<T,Alloc>::back() {
   return value_at(size() - 1);
 }
 
-template<typename T>
-const T& DoublyLinkedList<T>::front() const {
+template<typename T, class Alloc>
+const T& DoublyLinkedList<T,Alloc>::front() const {
   return value_at(0);
 }
 
-template<typename T>
-const T& DoublyLinkedList<T>::back() const {
+template<typename T, class Alloc>
+const T& DoublyLinkedList<T,Alloc>::back() const {
   return value_at(size() - 1);
 }
 
-template<typename T>
-typename DoublyLinkedList<T>::Node*
-DoublyLinkedList<T>::get_node_at(std::size_t i) const {
+template<typename T, class Alloc>
+typename DoublyLinkedList<T,Alloc>::Node*
+DoublyLinkedList<T,Alloc>::get_node_at(std::size_t i) const {
   assert(i >= 0 && i < size());
 
   if(i == size() - 1) {
@@ -437,80 +495,104 @@ DoublyLinkedList<T>::get_node_at(std::size_t i) const {
   return current;
 }
 
-template<typename T>
-void DoublyLinkedList<T>::clear() {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::clear() {
+  if(is_monotonic_allocator<_node_alloc_type>::value &&
+     std::is_trivially_destructible<T>::value) {
+    // nodes are neither destroyed nor deallocated one by one,
+    // their memory goes away with the arena
+    _head = nullptr;
+    _tail = nullptr;
+    _size = 0;
+    return;
+  }
   while(!empty()) {
     pop_front();
   }
 }
 
-template<typename T>
-void DoublyLinkedList<T>::insert_at(std::size_t i, const T& v) {
+template<typename T, class Alloc>
+template<typename... Args>
+typename DoublyLinkedList<T,Alloc>::Node*
+DoublyLinkedList<T,Alloc>::_new_node(Args&&... args) {
+  Node* n = _node_traits::allocate(_node_alloc, 1);
+  _node_traits::construct(_node_alloc, n, std::forward<Args>(args)...);
+  return n;
+}
+
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::_delete_node(Node* n) {
+  _node_traits::destroy(_node_alloc, n);
+  _node_traits::deallocate(_node_alloc, n, 1);
+}
+
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::insert_at(std::size_t i, const T& v) {
   assert(i >= 0 && i <= size());
 
   if(size() == 0) {
     // we have to update both head and tail
-    _head = new Node(v);
+    _head = _new_node(v);
     _tail = _head;
   } else if(i == 0) {
     // at least 1 element and inserting at head, only head needs to be updated
     Node* old_head = _head;
-    _head = new Node(v, old_head);
+    _head = _new_node(v, old_head);
     old_head->prev = _head;
   } else if(i == size()) {
     // at least 1 element and inserting after tail, only tail needs to be updated
     Node* old_tail = _tail;
-    _tail = new Node(v, nullptr, old_tail);
+    _tail = _new_node(v, nullptr, old_tail);
     old_tail->next = _tail;
   } else {
     // at least 2 elements and not inserting at head nor after tail
     // element at i exists and has at least one element before
     Node* node_at = get_node_at(i);
     Node* before = node_at->prev;
-    before->next = new Node(v, node_at, before);
+    before->next = _new_node(v, node_at, before);
     node_at->prev = before->next;
   }
   _size++;
 }
 
 // find out how to de-duplicate code regarding lvalues and rvalue references
-template<typename T>
-void DoublyLinkedList<T>::insert_at(std::size_t i, T&& v) {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::insert_at(std::size_t i, T&& v) {
   assert(i >= 0 && i <= size());
 
   if(size() == 0) {
     // we have to update both head and tail
-    _head = new Node(std::move(v));
+    _head = _new_node(std::move(v));
     _tail = _head;
   } else if(i == 0) {
     // at least 1 element and inserting at head, only head needs to be updated
     Node* old_head = _head;
-    _head = new Node(std::move(v), old_head);
+    _head = _new_node(std::move(v), old_head);
     old_head->prev = _head;
   } else if(i == size()) {
     // at least 1 element and inserting after tail, only tail needs to be updated
     Node* old_tail = _tail;
-    _tail = new Node(std::move(v), nullptr, old_tail);
+    _tail = _new_node(std::move(v), nullptr, old_tail);
     old_tail->next = _tail;
   } else {
     // at least 2 elements and not inserting at head nor after tail
     // element at i exists and has at least one element before
     Node* node_at = get_node_at(i);
     Node* before = node_at->prev;
-    before->next = new Node(std::move(v), node_at, before);
+    before->next = _new_node(std::move(v), node_at, before);
     node_at->prev = before->next;
   }
   _size++;
 }
 
-template<typename T>
-T DoublyLinkedList<T>::remove_at(std::size_t i) {
+template<typename T, class Alloc>
+T DoublyLinkedList<T,Alloc>::remove_at(std::size_t i) {
   assert(i >= 0 && i < size());
 
   if(size() == 1) {
     // we have to update both head and tail
     T ret{std::move(_head->data)};
-    delete _head;
+    _delete_node(_head);
     _head = nullptr;
     _tail = nullptr;
     _size--;
@@ -519,7 +601,7 @@ T DoublyLinkedList<T>::remove_at(std::size_t i) {
     // at least 2 elements and removing head, head and next need to be updated
     T ret{std::move(_head->data)};
     Node* new_head = _head->next;
-    delete _head;
+    _delete_node(_head);
     new_head->prev = nullptr;
     _head = new_head;
     _size--;
@@ -528,7 +610,7 @@ T DoublyLinkedList<T>::remove_at(std::size_t i) {
     // at least 2 elements and removing tail, tail and prev need to be updated
     T ret{std::move(_tail->data)};
     Node* new_tail = _tail->prev;
-    delete _tail;
+    _delete_node(_tail);
     new_tail->next = nullptr;
     _tail = new_tail;
     _size--;
@@ -539,7 +621,7 @@ T DoublyLinkedList<T>::remove_at(std::size_t i) {
     Node* before = node_at->prev;
     Node* after = node_at->next;
     T ret{std::move(node_at->data)};
-    delete node_at;
+    _delete_node(node_at);
     before->next = after;
     after->prev = before;
     _size--;
@@ -547,38 +629,38 @@ T DoublyLinkedList<T>::remove_at(std::size_t i) {
   }
 }
 
-template<typename T>
-void DoublyLinkedList<T>::push_back(const T& v) {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::push_back(const T& v) {
   return insert_at(size(), v);
 }
 
-template<typename T>
-void DoublyLinkedList<T>::push_back(T&& v) {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::push_back(T&& v) {
   return insert_at(size(), v);
 }
 
-template<typename T>
-void DoublyLinkedList<T>::push_front(const T& v) {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::push_front(const T& v) {
   return insert_at(0, v);
 }
 
-template<typename T>
-void DoublyLinkedList<T>::push_front(T&& v) {
+template<typename T, class Alloc>
+void DoublyLinkedList<T,Alloc>::push_front(T&& v) {
   return insert_at(0, v);
 }
 
-template<typename T>
-T DoublyLinkedList<T>::pop_front() {
+template<typename T, class Alloc>
+T DoublyLinkedList<T,Alloc>::pop_front() {
   return remove_at(0);
 }
 
-template<typename T>
-T DoublyLinkedList<T>::pop_back() {
+template<typename T, class Alloc>
+T DoublyLinkedList<T,Alloc>::pop_back() {
   return remove_at(size() - 1);
 }
 
-template<typename T>
-std::list<T> DoublyLinkedList<T>::to_std_list() const {
+template<typename T, class Alloc>
+std::list<T> DoublyLinkedList<T,Alloc>::to_std_list() const {
   std::list<T> ret;
   Node* current{_head};
   while(current != nullptr) {
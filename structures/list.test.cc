@@ -5,7 +5,7 @@
 #include "list.h"
 #include "../test_helpers.h"
 
-template<template<typename> class L>
+template<template<typename...> class L>
 void test_list(TestHelper& th) {
   th.message("* Testing on primitive objects");
   {
@@ -0,0 +1,392 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdlib>
+#include "map.h"
+#include "../bench_helpers.h"
+
+// bytes and blocks currently allocated through any CountingAllocator
+std::size_t counted_bytes = 0;
+std::size_t counted_blocks = 0;
+
+// std::allocator that keeps the counters up to date, so that the memory
+// used by a container (with all its rebound allocators) can be measured
+template<typename T>
+struct CountingAllocator {
+  typedef T value_type;
+
+  CountingAllocator() { }
+  template<typename U>
+  CountingAllocator(const CountingAllocator<U>&) { }
+
+  T* allocate(std::size_t n) {
+    counted_bytes += n * sizeof(T);
+    counted_blocks++;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) {
+    counted_bytes -= n * sizeof(T);
+    counted_blocks--;
+    std::allocator<T>().deallocate(p, n);
+  }
+};
+
+template<typename T, typename U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) { return false; }
+
+// bytes per element of a map holding n int keys, counting 16 bytes of
+// malloc header for every block
+template<typename Map>
+void bench_memory(BenchHelper& bh, const char* name, std::size_t n) {
+  Map m;
+  for(std::size_t i = 0; i < n; ++i) {
+    m[(int)(i * 2654435761u)] = (int)i;
+  }
+  bh.report(name, (double)(counted_bytes + 16 * counted_blocks) / n);
+}
+
+template<typename Map, typename K>
+bool map_contains(const Map& m, const K& key) {
+  return m.contains(key);
+}
+
+template<typename K, typename T>
+bool map_contains(const std::unordered_map<K,T>& m, const K& key) {
+  return m.count(key) != 0;
+}
+
+// looks up every key of hits (all present) and misses (all absent)
+template<typename Map, typename K>
+void bench_lookups(BenchHelper& bh, const char* hit_name, const char* miss_name,
+                   Map& m, const std::vector<K>& hits, const std::vector<K>& misses) {
+  bh.run(hit_name, [&] {
+    long long sum = 0;
+    for(const auto& k : hits) {
+      sum += m.at(k);
+    }
+    bench_keep(sum);
+  });
+  bh.run(miss_name, [&] {
+    std::size_t found = 0;
+    for(const auto& k : misses) {
+      found += map_contains(m, k);
+    }
+    bench_keep(found);
+  });
+}
+
+
+// a table that keeps `live` keys while the oldest key is erased and a
+// new one inserted, over and over
+template<typename Map>
+void bench_churn(BenchHelper& bh, const char* name, const char* lookup_name, std::size_t live, std::size_t ops) {
+  Map m;
+  for(std::size_t i = 0; i < live; ++i) {
+    m[(int)i] = (int)i;
+  }
+  std::size_t next = live;
+  bh.run(name, [&] {
+    for(std::size_t i = 0; i < ops; ++i, ++next) {
+      m.erase((int)(next - live));
+      m[(int)next] = (int)next;
+    }
+    bench_keep(m.size());
+  });
+  // lookups on the table the churn left behind
+  bh.run(lookup_name, [&] {
+    long long sum = 0;
+    for(std::size_t i = next - live; i < next; ++i) {
+      sum += m.at((int)i);
+    }
+    bench_keep(sum);
+  });
+}
+
+// times every single insert of n keys and reports the tail of the
+// distribution, where stop-the-world rehashes show up
+template<typename Map>
+void bench_insert_latency(BenchHelper& bh, const char* name, std::size_t n) {
+  Map m;
+  std::vector<double> latencies;
+  latencies.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    m[(int)(i * 2654435761u)] = (int)i;
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << name << std::endl;
+  bh.report("  p50 (us)", latencies[n / 2]);
+  bh.report("  p99 (us)", latencies[n - n / 100]);
+  bh.report("  p99.9 (us)", latencies[n - n / 1000]);
+  bh.report("  max (us)", latencies.back());
+}
+
+// times every single lookup of keys (all present, in random order) and
+// reports the tail of the distribution, where long probes show up
+template<typename Map>
+void bench_lookup_latency(BenchHelper& bh, const char* name, const Map& m, const std::vector<int>& keys) {
+  std::vector<double> latencies;
+  latencies.reserve(keys.size());
+  long long sum = 0;
+  for(const auto& k : keys) {
+    auto start = std::chrono::steady_clock::now();
+    sum += *m.find(k);
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  bench_keep(sum);
+  const std::size_t n = latencies.size();
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << name << " (load factor " << m.load_factor() << ")" << std::endl;
+  bh.report("  p50 (ns)", latencies[n / 2]);
+  bh.report("  p99 (ns)", latencies[n - n / 100]);
+  bh.report("  p99.9 (ns)", latencies[n - n / 1000]);
+  bh.report("  max (ns)", latencies.back());
+}
+
+// fills a map with known entries: one by one from the default size,
+// one by one after reserve(), and with the range constructor
+template<typename Map>
+void bench_load(BenchHelper& bh, const std::string& name, const std::vector<std::pair<int, int>>& load) {
+  bh.run((name + " operator[] (before)").c_str(), [&] {
+    Map m;
+    for(const auto& item : load) {
+      m[item.first] = item.second;
+    }
+    bench_keep(m.size());
+  });
+  bh.run((name + " reserve + operator[]").c_str(), [&] {
+    Map m;
+    m.reserve(load.size());
+    for(const auto& item : load) {
+      m[item.first] = item.second;
+    }
+    bench_keep(m.size());
+  });
+  bh.run((name + " range constructor").c_str(), [&] {
+    Map m(load.begin(), load.end());
+    bench_keep(m.size());
+  });
+}
+
+// probes a map of n int keys, sized to be much larger than the last-level
+// cache, with keys in random order (half of them present) in batches of
+// batch keys, as a hash join does: a loop of find() against find_batch()
+template<typename Map>
+void bench_find_batch(BenchHelper& bh, const std::string& name, std::size_t n, std::size_t batch) {
+  Map m;
+  m.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    m[(int)(i * 2654435761u)] = (int)i;
+  }
+  std::vector<int> probes;
+  for(std::size_t i = 0; i < n / 4; ++i) {
+    probes.push_back((int)(i * 8 * 2654435761u));
+    probes.push_back((int)(i * 8 * 2654435761u) ^ 1);
+  }
+  std::shuffle(probes.begin(), probes.end(), std::mt19937(42));
+
+  std::vector<std::vector<int>> batches;
+  for(std::size_t i = 0; i < probes.size(); i += batch) {
+    batches.emplace_back(probes.begin() + i, probes.begin() + std::min(probes.size(), i + batch));
+  }
+  std::vector<const int*> out;
+  bh.run((name + " find (before)").c_str(), [&] {
+    long long sum = 0;
+    for(const auto& keys : batches) {
+      out.resize(keys.size());
+      for(std::size_t i = 0; i < keys.size(); ++i) {
+        out[i] = static_cast<const Map&>(m).find(keys[i]);
+      }
+      for(auto v : out) {
+        sum += v != nullptr ? *v : 0;
+      }
+    }
+    bench_keep(sum);
+  });
+  bh.run((name + " find_batch (after)").c_str(), [&] {
+    long long sum = 0;
+    for(const auto& keys : batches) {
+      static_cast<const Map&>(m).find_batch(keys, out);
+      for(auto v : out) {
+        sum += v != nullptr ? *v : 0;
+      }
+    }
+    bench_keep(sum);
+  });
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 20;
+
+  std::vector<int> hits, misses;
+  for(std::size_t i = 0; i < n; ++i) {
+    hits.push_back((int)(i * 2654435761u));
+    misses.push_back((int)(i * 2654435761u) ^ 1);
+  }
+
+  std::unordered_map<int, int> stdm;
+  ChainedUnorderedMap<int, int> chained;
+  OpenAddressUnorderedMap<int, int> open;
+  RobinHoodUnorderedMap<int, int> robin;
+  CuckooUnorderedMap<int, int> cuckoo;
+  for(std::size_t i = 0; i < n; ++i) {
+    stdm[hits[i]] = (int)i;
+    chained[hits[i]] = (int)i;
+    open[hits[i]] = (int)i;
+    robin[hits[i]] = (int)i;
+    cuckoo[hits[i]] = (int)i;
+  }
+
+  std::cout << "\n[[ " << n << " int lookups ]]" << std::endl << std::endl;
+  bench_lookups(bh, "std::unordered_map hit", "std::unordered_map miss", stdm, hits, misses);
+  bench_lookups(bh, "ChainedUnorderedMap hit", "ChainedUnorderedMap miss", chained, hits, misses);
+  bench_lookups(bh, "OpenAddressUnorderedMap hit", "OpenAddressUnorderedMap miss", open, hits, misses);
+  bench_lookups(bh, "RobinHoodUnorderedMap hit", "RobinHoodUnorderedMap miss", robin, hits, misses);
+  bench_lookups(bh, "CuckooUnorderedMap hit", "CuckooUnorderedMap miss", cuckoo, hits, misses);
+
+  const std::size_t ns = n / 4;
+  std::vector<std::string> shits, smisses;
+  for(std::size_t i = 0; i < ns; ++i) {
+    shits.push_back("session/key/" + std::to_string(i * 2654435761u));
+    smisses.push_back("session/miss/" + std::to_string(i * 2654435761u));
+  }
+
+  std::unordered_map<std::string, int> sstdm;
+  OpenAddressUnorderedMap<std::string, int, StringHash> sopen;
+  for(std::size_t i = 0; i < ns; ++i) {
+    sstdm[shits[i]] = (int)i;
+    sopen[shits[i]] = (int)i;
+  }
+
+  std::cout << "\n[[ " << ns << " string lookups ]]" << std::endl << std::endl;
+  bench_lookups(bh, "std::unordered_map hit", "std::unordered_map miss", sstdm, shits, smisses);
+  bench_lookups(bh, "OpenAddressUnorderedMap hit", "OpenAddressUnorderedMap miss", sopen, shits, smisses);
+
+  std::cout << "\n[[ " << ns << " string misses ]]" << std::endl << std::endl;
+  bh.run("at() and catch (before)", [&] {
+    std::size_t found = 0;
+    for(const auto& k : smisses) {
+      try {
+        found += sopen.at(k);
+      } catch(std::out_of_range&) {
+      }
+    }
+    bench_keep(found);
+  });
+  bh.run("contains() (after)", [&] {
+    std::size_t found = 0;
+    for(const auto& k : smisses) {
+      found += sopen.contains(k);
+    }
+    bench_keep(found);
+  });
+
+  std::cout << "\n[[ " << ns << " lookups by const char* ]]" << std::endl << std::endl;
+  bh.run("find(std::string(key)) (before)", [&] {
+    long long sum = 0;
+    for(const auto& k : shits) {
+      sum += *sopen.find(std::string(k.c_str()));
+    }
+    bench_keep(sum);
+  });
+  bh.run("transparent find(key) (after)", [&] {
+    long long sum = 0;
+    for(const auto& k : shits) {
+      sum += *sopen.find(k.c_str());
+    }
+    bench_keep(sum);
+  });
+
+  const std::size_t live = n / 4;
+  const std::size_t ops = 4 * n;
+  std::cout << "\n[[ churn: " << ops << " erase+insert on " << live << " live int keys ]]" << std::endl << std::endl;
+  bench_churn<std::unordered_map<int, int>>(bh, "std::unordered_map churn", "std::unordered_map lookups after", live, ops);
+  bench_churn<ChainedUnorderedMap<int, int>>(bh, "ChainedUnorderedMap churn", "ChainedUnorderedMap lookups after", live, ops);
+  bench_churn<OpenAddressUnorderedMap<int, int>>(bh, "OpenAddressUnorderedMap churn", "OpenAddressUnorderedMap lookups after", live, ops);
+  bench_churn<RobinHoodUnorderedMap<int, int>>(bh, "RobinHoodUnorderedMap churn", "RobinHoodUnorderedMap lookups after", live, ops);
+
+  typedef CountingAllocator<std::pair<const int, int>> counting;
+  std::cout << "\n[[ bytes per element, " << n << " int keys ]]" << std::endl << std::endl;
+  bench_memory<std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, counting>>(bh, "std::unordered_map", n);
+  bench_memory<ChainedUnorderedMap<int, int, std::hash<int>, counting>>(bh, "ChainedUnorderedMap", n);
+  bench_memory<OpenAddressUnorderedMap<int, int, std::hash<int>, counting>>(bh, "OpenAddressUnorderedMap", n);
+  bench_memory<RobinHoodUnorderedMap<int, int, std::hash<int>, counting>>(bh, "RobinHoodUnorderedMap", n);
+  bench_memory<CuckooUnorderedMap<int, int, std::hash<int>, counting>>(bh, "CuckooUnorderedMap", n);
+
+  // every table as full as it gets: n keys after reserve(n)
+  std::vector<int> shuffled(hits);
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+  ChainedUnorderedMap<int, int> full_chained;
+  OpenAddressUnorderedMap<int, int> full_open;
+  RobinHoodUnorderedMap<int, int> full_robin;
+  CuckooUnorderedMap<int, int> full_cuckoo;
+  full_chained.reserve(n);
+  full_open.reserve(n);
+  full_robin.reserve(n);
+  full_cuckoo.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    full_chained[hits[i]] = (int)i;
+    full_open[hits[i]] = (int)i;
+    full_robin[hits[i]] = (int)i;
+    full_cuckoo[hits[i]] = (int)i;
+  }
+  std::cout << "\n[[ latency of each of " << n << " int lookups ]]" << std::endl << std::endl;
+  bench_lookup_latency(bh, "ChainedUnorderedMap", full_chained, shuffled);
+  bench_lookup_latency(bh, "OpenAddressUnorderedMap", full_open, shuffled);
+  bench_lookup_latency(bh, "RobinHoodUnorderedMap", full_robin, shuffled);
+  bench_lookup_latency(bh, "CuckooUnorderedMap", full_cuckoo, shuffled);
+
+  const std::size_t nb = 4 * n;
+  std::vector<std::pair<int, int>> load;
+  for(std::size_t i = 0; i < nb; ++i) {
+    load.push_back(std::make_pair((int)(i * 2654435761u), (int)i));
+  }
+  std::cout << "\n[[ loading " << nb << " known int entries ]]" << std::endl << std::endl;
+  bench_load<ChainedUnorderedMap<int, int>>(bh, "ChainedUnorderedMap", load);
+  bench_load<OpenAddressUnorderedMap<int, int>>(bh, "OpenAddressUnorderedMap", load);
+  bench_load<RobinHoodUnorderedMap<int, int>>(bh, "RobinHoodUnorderedMap", load);
+  bench_load<CuckooUnorderedMap<int, int>>(bh, "CuckooUnorderedMap", load);
+
+  const std::size_t nl = 4 * n;
+  std::cout << "\n[[ latency of each of " << nl << " int inserts ]]" << std::endl << std::endl;
+  bench_insert_latency<std::unordered_map<int, int>>(bh, "std::unordered_map (rehash at once)", nl);
+  bench_insert_latency<ChainedUnorderedMap<int, int>>(bh, "ChainedUnorderedMap (incremental rehash)", nl);
+
+  using stats_alloc = std::allocator<std::pair<const int, int>>;
+  ChainedUnorderedMap<int, int, std::hash<int>, stats_alloc, MapStats> stats_chained;
+  OpenAddressUnorderedMap<int, int, std::hash<int>, stats_alloc, MapStats> stats_open;
+  for(std::size_t i = 0; i < n; ++i) {
+    stats_chained[hits[i]] = (int)i;
+    stats_open[hits[i]] = (int)i;
+  }
+  std::cout << "\n[[ " << n << " int lookups, without and with MapStats ]]" << std::endl << std::endl;
+  bench_lookups(bh, "ChainedUnorderedMap hit", "ChainedUnorderedMap miss", chained, hits, misses);
+  bench_lookups(bh, "ChainedUnorderedMap + MapStats hit", "ChainedUnorderedMap + MapStats miss", stats_chained, hits, misses);
+  bench_lookups(bh, "OpenAddressUnorderedMap hit", "OpenAddressUnorderedMap miss", open, hits, misses);
+  bench_lookups(bh, "OpenAddressUnorderedMap + MapStats hit", "OpenAddressUnorderedMap + MapStats miss", stats_open, hits, misses);
+
+  // 16M int entries take about 200MB in OpenAddressUnorderedMap and
+  // more in ChainedUnorderedMap, past any last-level cache; argv[1]
+  // overrides the count
+  std::size_t nj = 1 << 24;
+  if(argc > 1) {
+    nj = (std::size_t)std::atol(argv[1]);
+  }
+  std::cout << "\n[[ " << nj / 2 << " int lookups in batches of 1024 on " << nj << " int entries ]]" << std::endl << std::endl;
+  bench_find_batch<ChainedUnorderedMap<int, int>>(bh, "ChainedUnorderedMap", nj, 1024);
+  bench_find_batch<OpenAddressUnorderedMap<int, int>>(bh, "OpenAddressUnorderedMap", nj, 1024);
+
+  return 0;
+}
@@ -2,14 +2,27 @@
 #define __STRUCTURES_MAP__
 
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
+#include <algorithm>
 #include <memory>
 #include <functional>
-#include <list>
+#include <new>
+#include <type_traits>
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
 #include <initializer_list>
+#include <string>
+#include <cstring>
+#include <tuple>
+#include <iterator>
+#include <atomic>
+#include <chrono>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+#include "simd.h"
 
 // unordered map interface
 template<typename K, typename T>
@@ -25,6 +38,10 @@ public:
 
   virtual void erase(const K& key) = 0;
 
+  virtual T* find(const K& key) = 0;
+  virtual const T* find(const K& key) const = 0;
+  virtual bool contains(const K& key) const = 0;
+
   virtual std::size_t size() const = 0;
   virtual bool empty() const = 0;
 
@@ -33,18 +50,347 @@ public:
   using item_type = std::pair<const K,T>;
 };
 
+// open addressing maps probe neighbouring buckets, so the user hash
+// is multiplied by a large odd constant (Fibonacci hashing) to make
+// every bit of the result depend on all of its bits: std::hash<int> is
+// the identity and would put consecutive keys in consecutive buckets.
+// The high half is folded onto the low one so that the home bucket
+// (hash % bucket_count()) depends on all of them too
+inline std::size_t _mix_hash(std::size_t hash) {
+  const auto h = hash * (std::size_t)0x9E3779B97F4A7C15ULL;
+  return h ^ (h >> (sizeof(std::size_t) * 4));
+}
+
+// Transparent hash for std::string keys: a const char* (or, in C++17, a
+// std::string_view) hashes exactly like the std::string with the same
+// characters, so a map using it can be searched with them (find,
+// contains) without building a std::string. FNV-1a over the bytes
+struct StringHash {
+  using is_transparent = void;
+
+  std::size_t operator()(const std::string& s) const { return hash_bytes(s.data(), s.size()); }
+  std::size_t operator()(const char* s) const { return hash_bytes(s, std::strlen(s)); }
+#if __cplusplus >= 201703L
+  std::size_t operator()(std::string_view s) const { return hash_bytes(s.data(), s.size()); }
+#endif
+
+  static std::size_t hash_bytes(const char* p, std::size_t n) {
+    std::uint64_t h = 0xCBF29CE484222325ULL;
+    for(std::size_t i = 0; i < n; ++i) {
+      h = (h ^ (unsigned char)p[i]) * 0x100000001B3ULL;
+    }
+    return (std::size_t)h;
+  }
+};
+
+// buckets a map needs so that n elements stay within max_load_factor;
+// one spare bucket absorbs the rounding of the float load factor
+inline std::size_t _buckets_for(std::size_t n, float max_load_factor) {
+  return (std::size_t)(n / (double)max_load_factor) + 1;
+}
+
+// reorders a batch of (key, value) pairs by the bucket bucket_of(key)
+// puts them in, so that inserting them walks the table front to back
+// instead of jumping around it. The order only has to be good enough for
+// the cache: a stable counting sort on the range of _batch_ranges
+// buckets a pair falls in is linear, where a full sort would cost more
+// than the misses it saves. Repeated keys keep their order
+const std::size_t _batch_ranges = 4096;
+
+template<class Item, class Bucket>
+void _sort_by_bucket(std::vector<Item>& batch, std::size_t bucket_count, Bucket bucket_of) {
+  const std::size_t ranges = std::min(bucket_count, _batch_ranges);
+  std::vector<std::uint32_t> range(batch.size());
+  std::vector<std::size_t> start(ranges + 1, 0);
+  for(std::size_t i = 0; i < batch.size(); ++i) {
+    range[i] = (std::uint32_t)(bucket_of(std::get<0>(batch[i])) * ranges / bucket_count);
+    start[range[i] + 1]++;
+  }
+  for(std::size_t r = 0; r < ranges; ++r) {
+    start[r + 1] += start[r];
+  }
+  std::vector<std::size_t> order(batch.size());
+  for(std::size_t i = 0; i < batch.size(); ++i) {
+    order[start[range[i]]++] = i;
+  }
+  std::vector<Item> sorted;
+  sorted.reserve(batch.size());
+  for(auto i : order) {
+    sorted.push_back(std::move(batch[i]));
+  }
+  batch.swap(sorted);
+}
+
+// statistics policies, the last template parameter of ChainedUnorderedMap
+// and OpenAddressUnorderedMap. The map calls these hooks:
+//   record_probe(n)         a lookup looked at n places before it stopped:
+//                           the groups of control bytes it probed for
+//                           OpenAddressUnorderedMap, the keys it compared
+//                           in the chain for ChainedUnorderedMap
+//   record_rehash()         a rehash started
+//   record_rehash_time(ns)  a rehash, or one step of an incremental one,
+//                           took ns nanoseconds, timed with Stats::now()
+//   record_table(size, buckets, tombstones)  after every change to them
+// NoMapStats, the default, does nothing: its hooks are empty inline
+// functions and it has no data, so a map without stats compiles to the
+// same code and the same size as one that never had the hooks
+struct NoMapStats {
+  static std::uint64_t now() { return 0; }
+  void record_probe(std::size_t) { }
+  void record_rehash() { }
+  void record_rehash_time(std::uint64_t) { }
+  void record_table(std::size_t, std::size_t, std::size_t) { }
+};
+
+// bins of the probe length histogram: bin 0 counts lookups of length 0,
+// bin i those of length in [2^(i-1), 2^i), the last one everything longer
+const std::size_t map_stats_bins = 16;
+
+// what MapStats has counted so far, see MapStats::snapshot()
+struct MapStatsSnapshot {
+  std::uint64_t probe_lengths[map_stats_bins];
+  std::uint64_t lookups;
+  // the sum of every probe length, over lookups it is the mean one
+  std::uint64_t probe_total;
+  std::uint64_t rehash_count;
+  std::uint64_t rehash_ns;
+  std::size_t size;
+  std::size_t bucket_count;
+  // erased buckets still on the probe sequences, always 0 without open addressing
+  std::size_t tombstones;
+  float load_factor;
+};
+
+// statistics policy that counts into relaxed atomics. The map updates
+// them from whichever thread uses it, and any other thread, a metrics
+// exporter say, can call snapshot() at any time, even while the map is
+// being modified; sampling it periodically gives the load factor over
+// time. Each counter is exact, but a snapshot taken during an operation
+// may see some counters before it and others after it.
+// Copies of a map copy its statistics. Assigning to a map keeps the ones
+// it had, so they survive the rehashes that are implemented as one
+class MapStats {
+public:
+  MapStats() { }
+  MapStats(const MapStats& other) { copy_from(other); }
+  MapStats& operator=(const MapStats& other) { copy_from(other); return *this; }
+
+  static std::uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void record_probe(std::size_t n) {
+    const std::size_t bin = n == 0 ? 0 : std::min<std::size_t>(64 - __builtin_clzll(n), map_stats_bins - 1);
+    _probe_lengths[bin].fetch_add(1, std::memory_order_relaxed);
+    _probe_total.fetch_add(n, std::memory_order_relaxed);
+  }
+  void record_rehash() { _rehash_count.fetch_add(1, std::memory_order_relaxed); }
+  void record_rehash_time(std::uint64_t ns) { _rehash_ns.fetch_add(ns, std::memory_order_relaxed); }
+  void record_table(std::size_t size, std::size_t buckets, std::size_t tombstones) {
+    _size.store(size, std::memory_order_relaxed);
+    _bucket_count.store(buckets, std::memory_order_relaxed);
+    _tombstones.store(tombstones, std::memory_order_relaxed);
+  }
+
+  MapStatsSnapshot snapshot() const; // O(map_stats_bins)
+
+private:
+  void copy_from(const MapStats& other);
+
+private:
+  std::atomic<std::uint64_t> _probe_lengths[map_stats_bins] = {};
+  std::atomic<std::uint64_t> _probe_total{0};
+  std::atomic<std::uint64_t> _rehash_count{0};
+  std::atomic<std::uint64_t> _rehash_ns{0};
+  std::atomic<std::size_t> _size{0};
+  std::atomic<std::size_t> _bucket_count{0};
+  std::atomic<std::size_t> _tombstones{0};
+};
+
+inline MapStatsSnapshot MapStats::snapshot() const {
+  MapStatsSnapshot s;
+  s.lookups = 0;
+  for(std::size_t i = 0; i < map_stats_bins; ++i) {
+    s.probe_lengths[i] = _probe_lengths[i].load(std::memory_order_relaxed);
+    s.lookups += s.probe_lengths[i];
+  }
+  s.probe_total = _probe_total.load(std::memory_order_relaxed);
+  s.rehash_count = _rehash_count.load(std::memory_order_relaxed);
+  s.rehash_ns = _rehash_ns.load(std::memory_order_relaxed);
+  s.size = _size.load(std::memory_order_relaxed);
+  s.bucket_count = _bucket_count.load(std::memory_order_relaxed);
+  s.tombstones = _tombstones.load(std::memory_order_relaxed);
+  s.load_factor = s.bucket_count > 0 ? (float)s.size / s.bucket_count : 0.0f;
+  return s;
+}
+
+inline void MapStats::copy_from(const MapStats& other) {
+  for(std::size_t i = 0; i < map_stats_bins; ++i) {
+    _probe_lengths[i].store(other._probe_lengths[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  _probe_total.store(other._probe_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  _rehash_count.store(other._rehash_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  _rehash_ns.store(other._rehash_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  record_table(other._size.load(std::memory_order_relaxed), other._bucket_count.load(std::memory_order_relaxed),
+               other._tombstones.load(std::memory_order_relaxed));
+}
+
+// keys per group of find_batch(). A lookup in a table much larger than the
+// cache stalls on a memory miss for its bucket, and a loop of find()
+// waits for them one after the other. find_batch() hashes a group of
+// keys and prefetches all their home buckets first, then resolves them:
+// by the time the first one is probed the misses of the whole group are
+// in flight together. A group must fit in the core's outstanding misses
+const std::size_t _batch_group = 16;
+
+// fixed-size node pool for the chains of ChainedUnorderedMap: nodes are
+// carved out of slabs of _slab_size nodes and freed ones are kept in an
+// intrusive free list, so a node costs neither an allocator call nor an
+// allocator header. Slabs are given back all at once by release() or
+// the destructor
+template<typename Node, class Alloc>
+class _SlabPool {
+public:
+  explicit _SlabPool(const Alloc& alloc); // O(1)
+  _SlabPool(const _SlabPool&) = delete;
+  _SlabPool(_SlabPool&& o); // O(1)
+  _SlabPool& operator=(const _SlabPool&) = delete;
+  _SlabPool& operator=(_SlabPool&& o); // O(slabs)
+  ~_SlabPool(); // O(slabs)
+
+  template<class... Args>
+  Node* create(Args&&... args); // O(1) amortized
+  void destroy(Node* n); // O(1)
+  // frees every slab, all nodes must have been destroyed
+  void release(); // O(slabs)
+
+private:
+  struct _free_node {
+    _free_node* next;
+  };
+  static_assert(sizeof(Node) >= sizeof(_free_node), "A free node must fit in a node");
+
+  using _traits = std::allocator_traits<Alloc>;
+  using _slab_alloc_type = typename _traits::template rebind_alloc<Node*>;
+
+  static const std::size_t _slab_size = 256;
+
+private:
+  Alloc _alloc;
+  std::vector<Node*, _slab_alloc_type> _slabs;
+  _free_node* _free;
+  // unused part of the newest slab
+  Node* _next;
+  Node* _end;
+};
+
+template<typename Node, class Alloc>
+const std::size_t _SlabPool<Node,Alloc>::_slab_size;
+
+template<typename Node, class Alloc>
+_SlabPool<Node,Alloc>::_SlabPool(const Alloc& alloc) :
+_alloc(alloc), _slabs(_slab_alloc_type(alloc)), _free(nullptr), _next(nullptr), _end(nullptr) {
+}
+
+template<typename Node, class Alloc>
+_SlabPool<Node,Alloc>::_SlabPool(_SlabPool&& o) :
+_alloc(o._alloc), _slabs(std::move(o._slabs)), _free(o._free), _next(o._next), _end(o._end) {
+  o._slabs.clear();
+  o._free = nullptr;
+  o._next = o._end = nullptr;
+}
+
+template<typename Node, class Alloc>
+_SlabPool<Node,Alloc>& _SlabPool<Node,Alloc>::operator=(_SlabPool&& o) {
+  if(this != &o) {
+    // slabs are given back through _alloc, so they can only be taken
+    // over from a pool whose allocator compares equal; the map moves
+    // nodes one by one otherwise
+    assert(_alloc == o._alloc);
+    release();
+    _slabs = std::move(o._slabs);
+    _free = o._free;
+    _next = o._next;
+    _end = o._end;
+    o._slabs.clear();
+    o._free = nullptr;
+    o._next = o._end = nullptr;
+  }
+  return *this;
+}
+
+template<typename Node, class Alloc>
+_SlabPool<Node,Alloc>::~_SlabPool() {
+  release();
+}
+
+template<typename Node, class Alloc>
+template<class... Args>
+Node* _SlabPool<Node,Alloc>::create(Args&&... args) {
+  Node* n;
+  if(_free != nullptr) {
+    n = reinterpret_cast<Node*>(_free);
+    _free = _free->next;
+  } else {
+    if(_next == _end) {
+      _slabs.push_back(_traits::allocate(_alloc, _slab_size));
+      _next = _slabs.back();
+      _end = _next + _slab_size;
+    }
+    n = _next++;
+  }
+  _traits::construct(_alloc, n, std::forward<Args>(args)...);
+  return n;
+}
+
+template<typename Node, class Alloc>
+void _SlabPool<Node,Alloc>::destroy(Node* n) {
+  _traits::destroy(_alloc, n);
+  _free = ::new(static_cast<void*>(n)) _free_node{_free};
+}
+
+template<typename Node, class Alloc>
+void _SlabPool<Node,Alloc>::release() {
+  for(auto slab : _slabs) {
+    _traits::deallocate(_alloc, slab, _slab_size);
+  }
+  _slabs.clear();
+  _free = nullptr;
+  _next = _end = nullptr;
+}
+
 // unordered map with chained buckets
-template<typename K, typename T, class Hash = std::hash<K>>
+// Every bucket stores its first element inline, in the bucket array, and
+// only the elements that collide with it go to a singly linked chain of
+// nodes taken from a _SlabPool. A lookup in a bucket with a single
+// element (the common case at our load factors) reads nothing but the
+// bucket, and an empty bucket is two words plus room for one element
+// instead of a whole list object.
+// Rehashing is incremental, like Redis' dict: when the table has to grow
+// or shrink a second table is allocated and every later non-const
+// operation moves a few buckets of the old table into it. Chained nodes
+// are relinked into the new table, no element in them is copied or even
+// moved. Until the old table is drained lookups check both tables. No
+// single operation ever pays for rehashing the whole map.
+// References to elements are invalidated by rehashing and by erasing
+// another element of the same bucket
+template<typename K, typename T, class Hash = std::hash<K>, class Alloc = std::allocator<std::pair<const K,T>>, class Stats = NoMapStats>
 class ChainedUnorderedMap : public UnorderedMap<K,T> {
 public:
   using item_type = typename UnorderedMap<K,T>::item_type;
+  using allocator_type = Alloc;
 
-  ChainedUnorderedMap(const std::size_t bucket_size = 13); // O(bucket_size)
+  ChainedUnorderedMap(const std::size_t bucket_size = 13, const Alloc& alloc = Alloc()); // O(bucket_size)
   ChainedUnorderedMap(const ChainedUnorderedMap& other); // O(max(other.size()))
   ChainedUnorderedMap(ChainedUnorderedMap&& rvr); // O(1)
-  ChainedUnorderedMap(std::initializer_list<item_type> l); // O(|l|)
+  ChainedUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc = Alloc()); // O(|l|)
+  // the (key, value) pairs of [first, last), in a table sized for all
+  // of them up front; see insert(first, last)
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  ChainedUnorderedMap(InputIt first, InputIt last, const Alloc& alloc = Alloc()); // O(|last - first|)
   ChainedUnorderedMap& operator=(const ChainedUnorderedMap& other); // O(max(size(), other.size()))
   ChainedUnorderedMap& operator=(ChainedUnorderedMap&& other); // O(size()) to deallocate
+  ~ChainedUnorderedMap(); // O(size())
 
   T& at(const K& key); // O(|n|) worst case, O(1) amortized
   const T& at(const K& key) const; // O(|n|) worst case, O(1) amortized
@@ -54,196 +400,739 @@ public:
 
   void erase(const K& key); // O(|n|) worst case, O(1) amortized
 
+  // lookups that do not throw: the value with that key, nullptr if none
+  T* find(const K& key); // O(|n|) worst case, O(1) amortized
+  const T* find(const K& key) const; // O(|n|) worst case, O(1) amortized
+  bool contains(const K& key) const; // O(|n|) worst case, O(1) amortized
+  // heterogeneous lookups, for a transparent Hash (one with an
+  // is_transparent member type such as StringHash): the key is hashed as
+  // it is and compared to the stored keys with ==, no K is ever built
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  T* find(const Q& key); // O(|n|) worst case, O(1) amortized
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  const T* find(const Q& key) const; // O(|n|) worst case, O(1) amortized
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  bool contains(const Q& key) const; // O(|n|) worst case, O(1) amortized
+  // out[i] = find(keys[i]) for every key, out is resized to keys.size().
+  // Faster than a loop of find() on tables that do not fit in the cache,
+  // the keys are looked up in groups whose buckets are prefetched together
+  void find_batch(const std::vector<K>& keys, std::vector<T*>& out); // O(|keys| * |n|) worst case, O(|keys|) amortized
+  void find_batch(const std::vector<K>& keys, std::vector<const T*>& out) const; // O(|keys| * |n|) worst case, O(|keys|) amortized
+
+  // inserts T(args...) under key unless the key is present; returns the
+  // value with that key and whether it was inserted. The key is only
+  // copied (or moved) into the map when it is inserted
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(const K& key, Args&&... args); // O(|n|) worst case, O(1) amortized
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(K&& key, Args&&... args); // O(|n|) worst case, O(1) amortized
+  // like try_emplace(key, value), but a present value is assigned value
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(const K& key, M&& value); // O(|n|) worst case, O(1) amortized
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(K&& key, M&& value); // O(|n|) worst case, O(1) amortized
+
+  // makes room for n elements: no insert rehashes before size() reaches n
+  void reserve(std::size_t n); // O(max(size(), n))
+  // inserts the (key, value) pairs of [first, last) whose key is not in
+  // the map yet; of repeated keys the first one wins, as with
+  // std::unordered_map::insert. The table grows at most once for the whole
+  // batch, and the batch is sorted by bucket before it goes in
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  void insert(InputIt first, InputIt last); // O(|last - first|)
+
   std::size_t size() const { return _size; } // O(1)
   bool empty() const { return size() == 0; } // O(1)
 
+  // while rehashing, these describe the table being filled
   std::size_t bucket_count() const { return _v.size(); } // bucket_count() should be kept O(size)
   float load_factor() const { return bucket_count() > 0 ? (float)size() / bucket_count() : 0.0f; }
   float min_load_factor() const { return _min_load_factor; }
   float max_load_factor() const { return _max_load_factor; }
+  bool rehashing() const { return !_old.empty(); } // O(1)
+  // the statistics policy, see MapStats; it can be read from any thread
+  const Stats& stats() const { return _stats; } // O(1)
 
   std::unordered_map<K,T> to_std_unordered_map() const;
+  Alloc get_allocator() const { return _alloc; }
 
 private:
-  std::size_t get_bucket_for(const K& key) const;
+  using _item_type = std::pair<K,T>;
+  using _item_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<_item_type>;
+
+  struct _node_type {
+    template<class... Args>
+    _node_type(_node_type* next, Args&&... args) : next(next), item(std::forward<Args>(args)...) { }
+
+    _node_type* next;
+    _item_type item;
+  };
+
+  // a bucket that has a chain is always full
+  struct _bucket_type {
+    _item_type& item() { return *reinterpret_cast<_item_type*>(&storage); }
+    const _item_type& item() const { return *reinterpret_cast<const _item_type*>(&storage); }
+
+    _node_type* next;
+    bool full;
+    // the first element, only constructed while full
+    typename std::aligned_storage<sizeof(_item_type), alignof(_item_type)>::type storage;
+  };
+
+  using _node_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<_node_type>;
+  using _bucket_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<_bucket_type>;
+  // buckets are trivial, a new table is value-initialized (zeroed) and
+  // the tables are never copied as such
+  using _table_type = std::vector<_bucket_type, _bucket_alloc_type>;
+
+  // non-empty old buckets moved per operation, and how many empty ones
+  // may be skipped for each of them
+  static const std::size_t _rehash_step = 4;
+  static const std::size_t _rehash_empty_visits = 10;
+
+  template<class Q>
+  std::size_t get_bucket_for(const Q& key) const;
+  template<class Q>
+  std::size_t get_old_bucket_for(const Q& key) const;
+  template<class Q>
+  static _item_type* find_in(_bucket_type& bucket, const Q& key, std::size_t& compared);
+  template<class Q>
+  _item_type* find_item(const Q& key) const;
+  template<class Q>
+  _item_type* find_item(const Q& key, std::size_t bucket) const;
+  template<class V>
+  void find_batch_into(const std::vector<K>& keys, V** out) const;
+  template<class Q>
+  T* find_value(const Q& key);
+  template<class Q>
+  const T* find_value(const Q& key) const;
+  template<class KK, class... Args>
+  std::pair<T*, bool> emplace_key(KK&& key, Args&&... args);
+  template<class... Args>
+  _item_type& insert_into(_bucket_type& bucket, Args&&... args);
+  bool erase_from(_bucket_type& bucket, const K& key, std::size_t& compared);
+  void relink(_node_type* n);
+  void move_bucket(_bucket_type& bucket);
+  void destroy_table(_table_type& table);
+  template<class F>
+  void for_each_item(F f) const;
+  template<class... Args>
+  void construct_item(_item_type* p, Args&&... args);
+  void destroy_item(_item_type* p);
   void rehash(std::size_t new_size);
+  void rehash_step();
+  void finish_rehash();
+  void reset_to_one_bucket();
+  void record_table() { _stats.record_table(size(), bucket_count(), 0); }
+  _table_type empty_table(std::size_t bucket_size = 0) const { return _table_type(bucket_size, _bucket_alloc_type(_alloc)); }
 
 private:
-  using _item_type = std::pair<K,T>;
-
   float _min_load_factor = 0.15;
   float _max_load_factor = 0.75;
   Hash _hasher;
-
-  // TODO: I'm using std::list and vector because I don't want to (yet)
-  // implement iterators for my own types
-  std::vector<std::list<_item_type>> _v;
+  Alloc _alloc;
+  // lookups are const but still counted
+  mutable Stats _stats;
+
+  _table_type _v;
+  // the table being drained while rehashing, empty otherwise; its
+  // buckets before _rehash_pos have already been moved to _v
+  _table_type _old;
+  std::size_t _rehash_pos;
   std::size_t _size;
+  _SlabPool<_node_type, _node_alloc_type> _pool;
 };
 
-template<typename K, typename T, class Hash>
-ChainedUnorderedMap<K,T,Hash>::ChainedUnorderedMap(const std::size_t bucket_size) : _v(std::max<std::size_t>(bucket_size, 1)), _size(0) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+const std::size_t ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::_rehash_step;
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+const std::size_t ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::_rehash_empty_visits;
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::ChainedUnorderedMap(const std::size_t bucket_size, const Alloc& alloc) :
+_alloc(alloc),
+_v(empty_table(std::max<std::size_t>(bucket_size, 1))),
+_old(empty_table()),
+_rehash_pos(0),
+_size(0),
+_pool(_node_alloc_type(alloc)) {
+  record_table();
 }
 
-template<typename K, typename T, class Hash>
-std::size_t ChainedUnorderedMap<K,T,Hash>::get_bucket_for(const K& key) const {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+std::size_t ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::get_bucket_for(const Q& key) const {
   return _hasher(key) % bucket_count();
 }
 
-template<typename K, typename T, class Hash>
-ChainedUnorderedMap<K,T,Hash>::ChainedUnorderedMap(const ChainedUnorderedMap& other) : _v(other._v), _size(other._size) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+std::size_t ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::get_old_bucket_for(const Q& key) const {
+  return _hasher(key) % _old.size();
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::ChainedUnorderedMap(const ChainedUnorderedMap& other) :
+_alloc(other._alloc),
+_stats(other._stats),
+_v(empty_table(other.bucket_count())),
+_old(empty_table()),
+_rehash_pos(0),
+_size(other._size),
+_pool(_node_alloc_type(other._alloc)) {
+  other.for_each_item([&](const _item_type& item) {
+    insert_into(_v[get_bucket_for(std::get<0>(item))], item);
+  });
 }
 
-template<typename K, typename T, class Hash>
-ChainedUnorderedMap<K,T,Hash>::ChainedUnorderedMap(ChainedUnorderedMap&& rvr) : _v(std::move(rvr._v)), _size(rvr._size) {
-  rvr._v.resize(1);
-  rvr._size = 0;
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::ChainedUnorderedMap(ChainedUnorderedMap&& rvr) :
+_alloc(rvr._alloc),
+_stats(rvr._stats),
+_v(std::move(rvr._v)),
+_old(std::move(rvr._old)),
+_rehash_pos(rvr._rehash_pos),
+_size(rvr._size),
+_pool(std::move(rvr._pool)) {
+  rvr.reset_to_one_bucket();
 }
 
-template<typename K, typename T, class Hash>
-ChainedUnorderedMap<K,T,Hash>::ChainedUnorderedMap(std::initializer_list<item_type> l) : _v(1), _size(0) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::ChainedUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc) :
+ChainedUnorderedMap(1, alloc) {
+  reserve(l.size());
   for(auto& item : l) {
     operator[](std::get<0>(item)) = std::get<1>(item);
   }
 }
 
-template<typename K, typename T, class Hash>
-ChainedUnorderedMap<K,T,Hash>& ChainedUnorderedMap<K,T,Hash>::operator=(const ChainedUnorderedMap& other) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class InputIt, class>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::ChainedUnorderedMap(InputIt first, InputIt last, const Alloc& alloc) :
+ChainedUnorderedMap(1, alloc) {
+  insert(first, last);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::operator=(const ChainedUnorderedMap& other) {
   if(this != &other) {
-    _v = other._v;
-    _size = other._size;
+    *this = ChainedUnorderedMap(other);
   }
   return *this;
 }
 
-template<typename K, typename T, class Hash>
-ChainedUnorderedMap<K,T,Hash>& ChainedUnorderedMap<K,T,Hash>::operator=(ChainedUnorderedMap&& other) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::operator=(ChainedUnorderedMap&& other) {
   if(this != &other) {
-    _v = std::move(other._v);
-    _size = other._size;
-    other._v.resize(1);
-    other._size = 0;
+    destroy_table(_v);
+    destroy_table(_old);
+    if(_alloc != other._alloc) {
+      // tables and nodes from another allocator cannot change hands,
+      // fall back to moving element by element
+      _v = empty_table(other.bucket_count());
+      _old = empty_table();
+      _rehash_pos = 0;
+      for(auto* table : { &other._v, &other._old }) {
+        for(auto& bucket : *table) {
+          if(bucket.full) {
+            insert_into(_v[get_bucket_for(std::get<0>(bucket.item()))], std::move(bucket.item()));
+            for(auto n = bucket.next; n != nullptr; n = n->next) {
+              insert_into(_v[get_bucket_for(std::get<0>(n->item))], std::move(n->item));
+            }
+          }
+        }
+      }
+      _size = other._size;
+      other.destroy_table(other._v);
+      other.destroy_table(other._old);
+    } else {
+      _v = std::move(other._v);
+      _old = std::move(other._old);
+      _rehash_pos = other._rehash_pos;
+      _size = other._size;
+      _pool = std::move(other._pool);
+    }
+    other.reset_to_one_bucket();
+    record_table();
   }
   return *this;
 }
 
-template<typename K, typename T, class Hash>
-T& ChainedUnorderedMap<K,T,Hash>::at(const K& key) {
-  std::list<_item_type>& list = _v[get_bucket_for(key)];
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::~ChainedUnorderedMap() {
+  destroy_table(_v);
+  destroy_table(_old);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::reset_to_one_bucket() {
+  _v = empty_table(1);
+  _old = empty_table();
+  _rehash_pos = 0;
+  _size = 0;
+  record_table();
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class... Args>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::construct_item(_item_type* p, Args&&... args) {
+  _item_alloc_type alloc(_alloc);
+  std::allocator_traits<_item_alloc_type>::construct(alloc, p, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::destroy_item(_item_type* p) {
+  _item_alloc_type alloc(_alloc);
+  std::allocator_traits<_item_alloc_type>::destroy(alloc, p);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+typename ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::_item_type* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_in(_bucket_type& bucket, const Q& key, std::size_t& compared) {
+  if(!bucket.full) {
+    return nullptr;
+  }
   // pair handling is awful in C++11/14, I hope this becomes mainstream soon
   // https://skebanga.github.io/structured-bindings/
-  for(auto& key_value : list) {
-    if(key == std::get<0>(key_value)) {
-      return std::get<1>(key_value);
+  compared++;
+  if(key == std::get<0>(bucket.item())) {
+    return &bucket.item();
+  }
+  for(auto n = bucket.next; n != nullptr; n = n->next) {
+    compared++;
+    if(key == std::get<0>(n->item)) {
+      return &n->item;
     }
   }
-  // if we get here, no element is assigned to that key
-  throw std::out_of_range("key not present");
+  return nullptr;
+}
+
+// the item with that key in either table, nullptr if there is none
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+typename ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::_item_type* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_item(const Q& key) const {
+  return find_item(key, get_bucket_for(key));
 }
 
-template<typename K, typename T, class Hash>
-T& ChainedUnorderedMap<K,T,Hash>::operator[](const K& key) {
-  // use operator[](K&& key)
-  // TODO: is it ok to do this? this could make an extra copy
-  // and require K to be copy-constructible (which I think we always do)
-  // I don't like duplicating code just to add/remove std::move
-  return operator[](K(key));
+// bucket is the bucket of key in the newest table
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+typename ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::_item_type* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_item(const Q& key, std::size_t bucket) const {
+  // the lookup itself does not modify anything, the caller decides
+  // whether the item may be modified
+  auto self = const_cast<ChainedUnorderedMap*>(this);
+  std::size_t compared = 0;
+  auto item = find_in(self->_v[bucket], key, compared);
+  if(item == nullptr && rehashing()) {
+    item = find_in(self->_old[get_old_bucket_for(key)], key, compared);
+  }
+  _stats.record_probe(compared);
+  return item;
 }
 
-template<typename K, typename T, class Hash>
-T& ChainedUnorderedMap<K,T,Hash>::operator[](K&& key) {
-  std::list<_item_type>* list = &_v[get_bucket_for(key)];
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+T* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_value(const Q& key) {
+  if(rehashing()) {
+    rehash_step();
+  }
+  auto item = find_item(key);
+  return item != nullptr ? &std::get<1>(*item) : nullptr;
+}
 
-  // pair handling is awful in C++11/14, I hope this becomes mainstream soon
-  // https://skebanga.github.io/structured-bindings/
-  for(auto& key_value : *list) {
-    if(key == std::get<0>(key_value)) {
-      return std::get<1>(key_value);
-    }
+// const lookups never move buckets
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+const T* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_value(const Q& key) const {
+  auto item = find_item(key);
+  return item != nullptr ? &std::get<1>(*item) : nullptr;
+}
+
+// inserts (key, T(args...)) unless key is present
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class KK, class... Args>
+std::pair<T*, bool> ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::emplace_key(KK&& key, Args&&... args) {
+  auto value = find_value(key);
+  if(value != nullptr) {
+    return std::make_pair(value, false);
   }
 
   // if we get here, no element is assigned to that key
   // check if we need to rehash
-  if(load_factor() > max_load_factor()) {
+  if(!rehashing() && load_factor() > max_load_factor()) {
     rehash(std::max<std::size_t>(bucket_count() * 2, 1));
-    list = &_v[get_bucket_for(key)];
   }
 
-  // we create a default one and return it, so that it can be modified
-  list->push_back(std::make_pair(std::move(key), T()));
+  // new elements always go to the newest table
+  _bucket_type& bucket = _v[get_bucket_for(key)];
+  auto& item = insert_into(bucket, std::piecewise_construct,
+                           std::forward_as_tuple(std::forward<KK>(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
   _size++;
-  return std::get<1>(list->back());
+  record_table();
+  return std::make_pair(&std::get<1>(item), true);
 }
 
-template<typename K, typename T, class Hash>
-const T& ChainedUnorderedMap<K,T,Hash>::at(const K& key) const {
-  const std::list<_item_type>& list = _v[get_bucket_for(key)];
-  // pair handling is awful in C++11/14, I hope this becomes mainstream soon
-  // https://skebanga.github.io/structured-bindings/
-  for(const auto& key_value : list) {
-    if(key == std::get<0>(key_value)) {
-      return (const T&)std::get<1>(key_value);
+// the key must not be in the map yet
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class... Args>
+typename ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::_item_type& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::insert_into(_bucket_type& bucket, Args&&... args) {
+  if(!bucket.full) {
+    construct_item(&bucket.item(), std::forward<Args>(args)...);
+    bucket.full = true;
+    return bucket.item();
+  }
+  bucket.next = _pool.create(bucket.next, std::forward<Args>(args)...);
+  return bucket.next->item;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+bool ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::erase_from(_bucket_type& bucket, const K& key, std::size_t& compared) {
+  if(!bucket.full) {
+    return false;
+  }
+  compared++;
+  if(key == std::get<0>(bucket.item())) {
+    if(bucket.next != nullptr) {
+      // the first chained element takes the inline place
+      auto n = bucket.next;
+      bucket.item() = std::move(n->item);
+      bucket.next = n->next;
+      _pool.destroy(n);
+    } else {
+      destroy_item(&bucket.item());
+      bucket.full = false;
     }
+    return true;
   }
-  // if we get here, no element is assigned to that key
-  throw std::out_of_range("key not present");
+  for(auto link = &bucket.next; *link != nullptr; link = &(*link)->next) {
+    compared++;
+    if(key == std::get<0>((*link)->item)) {
+      auto n = *link;
+      *link = n->next;
+      _pool.destroy(n);
+      return true;
+    }
+  }
+  return false;
 }
 
-template<typename K, typename T, class Hash>
-void ChainedUnorderedMap<K,T,Hash>::erase(const K& key) {
-  std::list<_item_type>& list = _v[get_bucket_for(key)];
-  // pair handling is awful in C++11/14, I hope this becomes mainstream soon
-  // https://skebanga.github.io/structured-bindings/
-  for(auto it = list.begin(); it != list.end(); ++it) {
-    if(key == std::get<0>(*it)) {
-      list.erase(it);
-      _size--;
-
-      // check if we need to rehash
-      if(load_factor() < min_load_factor()) {
-        rehash(std::max<std::size_t>(bucket_count() / 2, 1));
-      }
-      return;
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find(const K& key) {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+const T* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find(const K& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+bool ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::contains(const K& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q, class H, class>
+T* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find(const Q& key) {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q, class H, class>
+const T* ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find(const Q& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q, class H, class>
+bool ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::contains(const Q& key) const {
+  return find_value(key) != nullptr;
+}
+
+// like find(), the non-const batch moves some buckets of a pending rehash
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_batch(const std::vector<K>& keys, std::vector<T*>& out) {
+  if(rehashing()) {
+    rehash_step();
+  }
+  out.resize(keys.size());
+  find_batch_into(keys, out.data());
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_batch(const std::vector<K>& keys, std::vector<const T*>& out) const {
+  out.resize(keys.size());
+  find_batch_into(keys, out.data());
+}
+
+// the first element of a bucket is stored in it, so prefetching the
+// bucket brings in the whole lookup unless the key is further down a
+// chain. While rehashing only the newest table is prefetched
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class V>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::find_batch_into(const std::vector<K>& keys, V** out) const {
+  std::size_t buckets[_batch_group];
+  for(std::size_t start = 0; start < keys.size(); start += _batch_group) {
+    const auto end = std::min(keys.size(), start + _batch_group);
+    for(auto i = start; i < end; ++i) {
+      buckets[i - start] = get_bucket_for(keys[i]);
+      __builtin_prefetch(&_v[buckets[i - start]]);
+    }
+    for(auto i = start; i < end; ++i) {
+      auto item = find_item(keys[i], buckets[i - start]);
+      out[i] = item != nullptr ? &std::get<1>(*item) : nullptr;
+    }
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class... Args>
+std::pair<T*, bool> ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::try_emplace(const K& key, Args&&... args) {
+  return emplace_key(key, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class... Args>
+std::pair<T*, bool> ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::try_emplace(K&& key, Args&&... args) {
+  return emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class M>
+std::pair<T*, bool> ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::insert_or_assign(const K& key, M&& value) {
+  // emplace_key only uses value when it inserts
+  auto result = emplace_key(key, std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class M>
+std::pair<T*, bool> ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::insert_or_assign(K&& key, M&& value) {
+  auto result = emplace_key(std::move(key), std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
+
+// a pending incremental rehash is completed too, so that the bucket of
+// a key stays put until size() reaches n
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::reserve(std::size_t n) {
+  const auto needed = _buckets_for(n, max_load_factor());
+  if(needed > bucket_count()) {
+    rehash(needed);
+  }
+  finish_rehash();
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class InputIt, class>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::insert(InputIt first, InputIt last) {
+  std::vector<_item_type> batch(first, last);
+  reserve(size() + batch.size());
+  _sort_by_bucket(batch, bucket_count(), [this](const K& key) { return get_bucket_for(key); });
+  for(auto& item : batch) {
+    emplace_key(std::move(std::get<0>(item)), std::move(std::get<1>(item)));
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::at(const K& key) {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+const T& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::at(const K& key) const {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+// the key is only copied if it has to be inserted
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::operator[](const K& key) {
+  return *emplace_key(key).first;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T& ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::operator[](K&& key) {
+  return *emplace_key(std::move(key)).first;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::erase(const K& key) {
+  if(rehashing()) {
+    rehash_step();
+  }
+
+  std::size_t compared = 0;
+  const bool erased = erase_from(_v[get_bucket_for(key)], key, compared) ||
+                      (rehashing() && erase_from(_old[get_old_bucket_for(key)], key, compared));
+  _stats.record_probe(compared);
+  if(erased) {
+    _size--;
+
+    // check if we need to rehash
+    if(!rehashing() && load_factor() < min_load_factor()) {
+      rehash(std::max<std::size_t>(bucket_count() / 2, 1));
     }
+    record_table();
   }
   // if we get here, no element is assigned to that key
   // we mimic the behaviour of std::unordered_map::erase and do nothing
 }
 
-template<typename K, typename T, class Hash>
-void ChainedUnorderedMap<K,T,Hash>::rehash(std::size_t new_size) {
-  ChainedUnorderedMap<K,T,Hash> tmp_map(new_size);
-  for(auto& bucket : _v) {
-    while(!bucket.empty()) {
-      auto item = bucket.front();
-      tmp_map[std::move(std::get<0>(item))] = std::move(std::get<1>(item));
-      bucket.pop_front();
+// starts moving every element to a table of new_size buckets, the
+// move itself happens a few buckets at a time in rehash_step()
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::rehash(std::size_t new_size) {
+  finish_rehash();
+  _stats.record_rehash();
+  const auto start = Stats::now();
+  _old = std::move(_v);
+  _v = empty_table(new_size);
+  _rehash_pos = 0;
+  _stats.record_rehash_time(Stats::now() - start);
+  rehash_step();
+  record_table();
+}
+
+// moves up to _rehash_step non-empty buckets of the old table
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::rehash_step() {
+  const auto start = Stats::now();
+  std::size_t moved = 0;
+  std::size_t empty_visits = 0;
+  while(_rehash_pos < _old.size() && moved < _rehash_step && empty_visits < _rehash_step * _rehash_empty_visits) {
+    _bucket_type& bucket = _old[_rehash_pos++];
+    if(!bucket.full) {
+      empty_visits++;
+      continue;
     }
+    move_bucket(bucket);
+    moved++;
   }
-  *this = std::move(tmp_map);
+
+  if(_rehash_pos == _old.size()) {
+    // release the old table
+    _old = empty_table();
+    _rehash_pos = 0;
+  }
+  _stats.record_rehash_time(Stats::now() - start);
 }
 
-template<typename K, typename T, class Hash>
-std::unordered_map<K,T> ChainedUnorderedMap<K,T,Hash>::to_std_unordered_map() const {
-  std::unordered_map<K,T> m;
-  for(const auto& bucket : _v) {
-    for(const auto& item : bucket) {
-      m[std::get<0>(item)] = std::get<1>(item);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::finish_rehash() {
+  while(rehashing()) {
+    rehash_step();
+  }
+}
+
+// chained nodes are relinked as they are, only the inline element
+// (and a node that becomes the inline element of its new bucket) moves
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::move_bucket(_bucket_type& bucket) {
+  for(auto n = bucket.next; n != nullptr; ) {
+    auto next = n->next;
+    relink(n);
+    n = next;
+  }
+  bucket.next = nullptr;
+
+  auto& item = bucket.item();
+  insert_into(_v[get_bucket_for(std::get<0>(item))], std::move(item));
+  destroy_item(&item);
+  bucket.full = false;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::relink(_node_type* n) {
+  _bucket_type& target = _v[get_bucket_for(std::get<0>(n->item))];
+  if(!target.full) {
+    construct_item(&target.item(), std::move(n->item));
+    target.full = true;
+    _pool.destroy(n);
+  } else {
+    n->next = target.next;
+    target.next = n;
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::destroy_table(_table_type& table) {
+  for(auto& bucket : table) {
+    if(bucket.full) {
+      for(auto n = bucket.next; n != nullptr; ) {
+        auto next = n->next;
+        _pool.destroy(n);
+        n = next;
+      }
+      destroy_item(&bucket.item());
+      bucket.next = nullptr;
+      bucket.full = false;
+    }
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class F>
+void ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::for_each_item(F f) const {
+  for(const auto* table : { &_v, &_old }) {
+    for(const auto& bucket : *table) {
+      if(bucket.full) {
+        f(bucket.item());
+        for(auto n = bucket.next; n != nullptr; n = n->next) {
+          f(n->item);
+        }
+      }
     }
   }
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+std::unordered_map<K,T> ChainedUnorderedMap<K,T,Hash,Alloc,Stats>::to_std_unordered_map() const {
+  std::unordered_map<K,T> m;
+  for_each_item([&](const _item_type& item) {
+    m[std::get<0>(item)] = std::get<1>(item);
+  });
   return m;
 }
 
 // unordered map with open addressing
-template<typename K, typename T, class Hash = std::hash<K>>
+// Every bucket has a control byte, kept in a separate array: a
+// 7-bit tag of the hash when the bucket is full, or one of the
+// negative markers empty/deleted. Lookups probe a group of 16 control
+// bytes at a time with a single SIMD compare and only compare full keys
+// on the buckets whose tag matched; they stop at the first group that
+// still has an empty bucket. The control bytes of a whole group share a
+// cache line, so a lookup usually misses the cache once for the group and
+// once for the matching bucket
+template<typename K, typename T, class Hash = std::hash<K>, class Alloc = std::allocator<std::pair<const K,T>>, class Stats = NoMapStats>
 class OpenAddressUnorderedMap : public UnorderedMap<K,T> {
 public:
   using item_type = typename UnorderedMap<K,T>::item_type;
+  using allocator_type = Alloc;
 
-  OpenAddressUnorderedMap(const std::size_t bucket_size = 13); // O(bucket_size)
+  OpenAddressUnorderedMap(const std::size_t bucket_size = 13, const Alloc& alloc = Alloc()); // O(bucket_size)
   OpenAddressUnorderedMap(const OpenAddressUnorderedMap& other); // O(max(other.size()))
   OpenAddressUnorderedMap(OpenAddressUnorderedMap&& rvr); // O(1)
-  OpenAddressUnorderedMap(std::initializer_list<item_type> l); // O(|l|)
+  OpenAddressUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc = Alloc()); // O(|l|)
+  // the (key, value) pairs of [first, last), in a table sized for all
+  // of them up front; see insert(first, last)
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  OpenAddressUnorderedMap(InputIt first, InputIt last, const Alloc& alloc = Alloc()); // O(|last - first|)
   OpenAddressUnorderedMap& operator=(const OpenAddressUnorderedMap& other); // O(max(size(), other.size()))
   OpenAddressUnorderedMap& operator=(OpenAddressUnorderedMap&& other); // O(size()) to deallocate
 
@@ -255,6 +1144,47 @@ public:
 
   void erase(const K& key); // O(|n|) worst case, O(1) amortized
 
+  // lookups that do not throw: the value with that key, nullptr if none
+  T* find(const K& key); // O(|n|) worst case, O(1) amortized
+  const T* find(const K& key) const; // O(|n|) worst case, O(1) amortized
+  bool contains(const K& key) const; // O(|n|) worst case, O(1) amortized
+  // heterogeneous lookups, for a transparent Hash (one with an
+  // is_transparent member type such as StringHash): the key is hashed as
+  // it is and compared to the stored keys with ==, no K is ever built
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  T* find(const Q& key); // O(|n|) worst case, O(1) amortized
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  const T* find(const Q& key) const; // O(|n|) worst case, O(1) amortized
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  bool contains(const Q& key) const; // O(|n|) worst case, O(1) amortized
+  // out[i] = find(keys[i]) for every key, out is resized to keys.size().
+  // Faster than a loop of find() on tables that do not fit in the cache,
+  // the keys are looked up in groups whose buckets are prefetched together
+  void find_batch(const std::vector<K>& keys, std::vector<T*>& out); // O(|keys| * |n|) worst case, O(|keys|) amortized
+  void find_batch(const std::vector<K>& keys, std::vector<const T*>& out) const; // O(|keys| * |n|) worst case, O(|keys|) amortized
+
+  // inserts T(args...) under key unless the key is present; returns the
+  // value with that key and whether it was inserted. The key is only
+  // copied (or moved) into the map when it is inserted
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(const K& key, Args&&... args); // O(|n|) worst case, O(1) amortized
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(K&& key, Args&&... args); // O(|n|) worst case, O(1) amortized
+  // like try_emplace(key, value), but a present value is assigned value
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(const K& key, M&& value); // O(|n|) worst case, O(1) amortized
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(K&& key, M&& value); // O(|n|) worst case, O(1) amortized
+
+  // makes room for n elements: no insert rehashes before size() reaches n
+  void reserve(std::size_t n); // O(max(size(), n))
+  // inserts the (key, value) pairs of [first, last) whose key is not in
+  // the map yet; of repeated keys the first one wins, as with
+  // std::unordered_map::insert. The table grows at most once for the whole
+  // batch, and the batch is sorted by bucket before it goes in
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  void insert(InputIt first, InputIt last); // O(|last - first|)
+
   std::size_t size() const { return _size; } // O(1)
   bool empty() const { return size() == 0; } // O(1)
 
@@ -262,218 +1192,1578 @@ public:
   float load_factor() const { return bucket_count() > 0 ? (float)size() / bucket_count() : 0.0f; }
   float min_load_factor() const { return _min_load_factor; }
   float max_load_factor() const { return _max_load_factor; }
+  // erased buckets that still lengthen probes until the next rehash
+  std::size_t deleted_count() const { return _deleted_count; } // O(1)
+  // the statistics policy, see MapStats; it can be read from any thread
+  const Stats& stats() const { return _stats; } // O(1)
 
   std::unordered_map<K,T> to_std_unordered_map() const;
+  Alloc get_allocator() const { return _alloc; }
 
 private:
-  std::size_t get_bucket_for(const K& key, bool skip_deleted) const;
+  using _item_type = std::pair<K,T>;
+  using _item_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<_item_type>;
+  using _ctrl_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<std::int8_t>;
+
+  // control bytes that are not a tag, both have the sign bit set
+  enum : std::int8_t { _ctrl_empty = -128, _ctrl_deleted = -2 };
+
+  template<class Q>
+  std::size_t hash_of(const Q& key) const;
+  static std::int8_t tag_of(std::size_t hash) { return (std::int8_t)(hash >> (sizeof(std::size_t) * 8 - 7)); }
+  template<class Q>
+  std::size_t get_bucket_for(const Q& key, std::size_t hash) const;
+  template<class Q>
+  T* find_value(const Q& key) const;
+  template<class V>
+  void find_batch_into(const std::vector<K>& keys, V** out) const;
+  template<class KK, class... Args>
+  std::pair<T*, bool> emplace_key(KK&& key, Args&&... args);
+  std::size_t get_free_bucket_for(std::size_t hash) const;
+  void set_ctrl(std::size_t bucket, std::int8_t ctrl);
+  // i % bucket_count() for i < bucket_count() + simd_group_size, without a division
+  std::size_t wrap(std::size_t i) const { while(i >= bucket_count()) { i -= bucket_count(); } return i; }
+  bool was_never_full(std::size_t bucket) const;
+  template<class F>
+  void for_each_live_bucket(F f) const;
   void rehash(std::size_t new_size);
+  void reset_to_one_bucket();
+  void record_table() { _stats.record_table(size(), bucket_count(), _deleted_count); }
 
 private:
-  using _item_type = std::pair<K,T>;
-
   float _min_load_factor = 0.15;
   float _max_load_factor = 0.75;
   Hash _hasher;
-
-  std::vector<_item_type> _buckets;
-  std::vector<bool> _occupied;
-  std::vector<bool> _deleted;
+  Alloc _alloc;
+  // lookups are const but still counted
+  mutable Stats _stats;
+
+  std::vector<_item_type, _item_alloc_type> _buckets;
+  // one control byte per bucket followed by a copy of the first
+  // simd_group_size ones, so that a group load never has to wrap around
+  std::vector<std::int8_t, _ctrl_alloc_type> _ctrl;
   std::size_t _size;
+  std::size_t _deleted_count;
 };
 
-template<typename K, typename T, class Hash>
-OpenAddressUnorderedMap<K,T,Hash>::OpenAddressUnorderedMap(const std::size_t bucket_size) :
-_buckets(std::max<std::size_t>(bucket_size, 1)),
-_occupied(std::max<std::size_t>(bucket_size, 1), false),
-_deleted(std::max<std::size_t>(bucket_size, 1), false),
-_size(0) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::OpenAddressUnorderedMap(const std::size_t bucket_size, const Alloc& alloc) :
+_alloc(alloc),
+_buckets(std::max<std::size_t>(bucket_size, 1), _item_alloc_type(alloc)),
+_ctrl(std::max<std::size_t>(bucket_size, 1) + simd_group_size, _ctrl_empty, _ctrl_alloc_type(alloc)),
+_size(0),
+_deleted_count(0) {
+  record_table();
 }
 
-template<typename K, typename T, class Hash>
-OpenAddressUnorderedMap<K,T,Hash>::OpenAddressUnorderedMap(const OpenAddressUnorderedMap& other) :
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::OpenAddressUnorderedMap(const OpenAddressUnorderedMap& other) :
+_alloc(other._alloc),
+_stats(other._stats),
 _buckets(other._buckets),
-_occupied(other._occupied),
-_deleted(other._deleted),
-_size(other._size) {
+_ctrl(other._ctrl),
+_size(other._size),
+_deleted_count(other._deleted_count) {
 }
 
-template<typename K, typename T, class Hash>
-OpenAddressUnorderedMap<K,T,Hash>::OpenAddressUnorderedMap(OpenAddressUnorderedMap&& rvr) :
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::OpenAddressUnorderedMap(OpenAddressUnorderedMap&& rvr) :
+_alloc(rvr._alloc),
+_stats(rvr._stats),
 _buckets(std::move(rvr._buckets)),
-_occupied(std::move(rvr._occupied)),
-_deleted(std::move(rvr._deleted)),
-_size(std::move(rvr._size)) {
-  rvr._buckets.resize(1);
-  rvr._occupied.clear();
-  rvr._occupied.resize(1, false);
-  rvr._deleted.clear();
-  rvr._deleted.resize(1, false);
-  rvr._size = 0;
-}
-
-template<typename K, typename T, class Hash>
-OpenAddressUnorderedMap<K,T,Hash>::OpenAddressUnorderedMap(std::initializer_list<item_type> l) :
-_buckets(l.size()),
-_occupied(l.size(), false),
-_deleted(l.size(), false),
-_size(0) {
+_ctrl(std::move(rvr._ctrl)),
+_size(rvr._size),
+_deleted_count(rvr._deleted_count) {
+  rvr.reset_to_one_bucket();
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::OpenAddressUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc) :
+OpenAddressUnorderedMap(1, alloc) {
+  reserve(l.size());
   for(const auto& item : l) {
     operator[](std::get<0>(item)) = std::get<1>(item);
   }
 }
 
-template<typename K, typename T, class Hash>
-OpenAddressUnorderedMap<K,T,Hash>& OpenAddressUnorderedMap<K,T,Hash>::operator=(const OpenAddressUnorderedMap& other) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class InputIt, class>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::OpenAddressUnorderedMap(InputIt first, InputIt last, const Alloc& alloc) :
+OpenAddressUnorderedMap(1, alloc) {
+  insert(first, last);
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>& OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::operator=(const OpenAddressUnorderedMap& other) {
   if(this != &other) {
     _buckets = other._buckets;
-    _occupied = other._occupied;
-    _deleted = other._deleted;
+    _ctrl = other._ctrl;
     _size = other._size;
+    _deleted_count = other._deleted_count;
+    record_table();
   }
   return *this;
 }
 
-template<typename K, typename T, class Hash>
-OpenAddressUnorderedMap<K,T,Hash>& OpenAddressUnorderedMap<K,T,Hash>::operator=(OpenAddressUnorderedMap&& other) {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>& OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::operator=(OpenAddressUnorderedMap&& other) {
   if(this != &other) {
     _buckets = std::move(other._buckets);
-    _occupied = std::move(other._occupied);
-    _deleted = std::move(other._deleted);
+    _ctrl = std::move(other._ctrl);
     _size = other._size;
-    other._buckets.resize(1);
-    other._occupied.clear();
-    other._occupied.resize(1, false);
-    other._deleted.clear();
-    other._deleted.resize(1, false);
-    other._size = 0;
+    _deleted_count = other._deleted_count;
+    other.reset_to_one_bucket();
+    record_table();
   }
   return *this;
 }
 
-template<typename K, typename T, class Hash>
-T& OpenAddressUnorderedMap<K,T,Hash>::at(const K& key) {
-  // try to find the key, skipping deleted buckets
-  auto bucket = get_bucket_for(key, true);
-
-  if(bucket < 0 || !_occupied[bucket]) {
-    throw std::out_of_range("key not present");
-  }
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::reset_to_one_bucket() {
+  _buckets.clear();
+  _buckets.resize(1);
+  _ctrl.assign(1 + simd_group_size, _ctrl_empty);
+  _size = 0;
+  _deleted_count = 0;
+  record_table();
+}
 
-  return std::get<1>(_buckets[bucket]);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T* OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find(const K& key) {
+  return find_value(key);
 }
 
-template<typename K, typename T, class Hash>
-T& OpenAddressUnorderedMap<K,T,Hash>::operator[](const K& key) {
-  // use operator[](K&& key)
-  // TODO: is it ok to do this? this could make an extra copy
-  // and require K to be copy-constructible (which I think we always do)
-  // I don't like duplicating code just to add/remove std::move
-  return operator[](K(key));
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+const T* OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find(const K& key) const {
+  return find_value(key);
 }
 
-template<typename K, typename T, class Hash>
-T& OpenAddressUnorderedMap<K,T,Hash>::operator[](K&& key) {
-  // try to find a matching key, skipping deleted slots
-  auto bucket = get_bucket_for(key, true);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+bool OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::contains(const K& key) const {
+  return find_value(key) != nullptr;
+}
 
-  // if found, we are done
-  assert(bucket < bucket_count());
-  if(_occupied[bucket]) {
-    return std::get<1>(_buckets[bucket]);
-  }
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q, class H, class>
+T* OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find(const Q& key) {
+  return find_value(key);
+}
 
-  // if we get here, no element is assigned to that key
-  // (1) check if we need to rehash
-  if(load_factor() > max_load_factor()) {
-    rehash(std::max<std::size_t>(bucket_count() * 2, 1));
-  }
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q, class H, class>
+const T* OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find(const Q& key) const {
+  return find_value(key);
+}
 
-  // (2) no matter if we rehashed or not, find a place to set the key;
-  // it could be a deleted slot
-  bucket = get_bucket_for(key, false);
-  assert(bucket < bucket_count());
-  assert(!_occupied[bucket] || _deleted[bucket]);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q, class H, class>
+bool OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::contains(const Q& key) const {
+  return find_value(key) != nullptr;
+}
 
-  std::get<0>(_buckets[bucket]) = std::move(key);
-  _occupied[bucket] = true;
-  _deleted[bucket] = false;
-  _size++;
-  return std::get<1>(_buckets[bucket]);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find_batch(const std::vector<K>& keys, std::vector<T*>& out) {
+  out.resize(keys.size());
+  find_batch_into(keys, out.data());
 }
 
-template<typename K, typename T, class Hash>
-const T& OpenAddressUnorderedMap<K,T,Hash>::at(const K& key) const {
-  auto bucket = get_bucket_for(key, true);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find_batch(const std::vector<K>& keys, std::vector<const T*>& out) const {
+  out.resize(keys.size());
+  find_batch_into(keys, out.data());
+}
 
-  if(bucket < 0 || !_occupied[bucket]) {
-    throw std::out_of_range("key not present");
+// a lookup reads the control bytes of its home group and then the
+// bucket whose tag matched, usually the home bucket itself: both are
+// prefetched. The hashes are kept for the probes
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class V>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find_batch_into(const std::vector<K>& keys, V** out) const {
+  const auto bc = bucket_count();
+  std::size_t hashes[_batch_group];
+  for(std::size_t start = 0; start < keys.size(); start += _batch_group) {
+    const auto end = std::min(keys.size(), start + _batch_group);
+    for(auto i = start; i < end; ++i) {
+      hashes[i - start] = hash_of(keys[i]);
+      const auto pos = hashes[i - start] % bc;
+      __builtin_prefetch(&_ctrl[pos]);
+      __builtin_prefetch(&_buckets[pos]);
+    }
+    for(auto i = start; i < end; ++i) {
+      const auto bucket = get_bucket_for(keys[i], hashes[i - start]);
+      out[i] = bucket < bc ? const_cast<T*>(&std::get<1>(_buckets[bucket])) : nullptr;
+    }
   }
-
-  return std::get<1>(_buckets[bucket]);
 }
 
-// returns either the place where the key IS (if found)
-// or where the key should be placed (if not found)
-template<typename K, typename T, class Hash>
-std::size_t OpenAddressUnorderedMap<K,T,Hash>::get_bucket_for(const K& key, bool skip_deleted) const {
-  const auto bc = bucket_count();
-  auto start = _hasher(key) % bc;
-  auto i = start;
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class... Args>
+std::pair<T*, bool> OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::try_emplace(const K& key, Args&&... args) {
+  return emplace_key(key, std::forward<Args>(args)...);
+}
 
-  do {
-    if(!_occupied[i] ||
-       (!skip_deleted && _deleted[i]) ||
-       (!_deleted[i] && std::get<0>(_buckets[i]) == key)) {
-      return i;
-    }
-    // linear probing
-    i = (i + 1) % bc;
-  } while (i != start);
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class... Args>
+std::pair<T*, bool> OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::try_emplace(K&& key, Args&&... args) {
+  return emplace_key(std::move(key), std::forward<Args>(args)...);
+}
 
-  // table is full! this shouldn't happen ;)
-  return bc;
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class M>
+std::pair<T*, bool> OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::insert_or_assign(const K& key, M&& value) {
+  // emplace_key only uses value when it inserts
+  auto result = emplace_key(key, std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
 }
 
-template<typename K, typename T, class Hash>
-void OpenAddressUnorderedMap<K,T,Hash>::erase(const K& key) {
-  // try to find key, skipping deleted buckets
-  auto bucket = get_bucket_for(key, true);
-  assert(bucket < bucket_count());
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class M>
+std::pair<T*, bool> OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::insert_or_assign(K&& key, M&& value) {
+  auto result = emplace_key(std::move(key), std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
 
-  if(_occupied[bucket]) {
-    // _occupied[bucket] = true;
-    _deleted[bucket] = true;
-    _size--;
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::reserve(std::size_t n) {
+  const auto needed = _buckets_for(n, max_load_factor());
+  if(needed > bucket_count()) {
+    rehash(needed);
+  }
+}
 
-    // check if we need to rehash
-    if(load_factor() < min_load_factor()) {
-      rehash(std::max<std::size_t>(bucket_count() / 2, 1));
-    }
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class InputIt, class>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::insert(InputIt first, InputIt last) {
+  std::vector<_item_type> batch(first, last);
+  reserve(size() + batch.size());
+  _sort_by_bucket(batch, bucket_count(), [this](const K& key) { return hash_of(key) % bucket_count(); });
+  for(auto& item : batch) {
+    emplace_key(std::move(std::get<0>(item)), std::move(std::get<1>(item)));
   }
-  // if we get here, no element is assigned to that key
-  // we mimic the behaviour of std::unordered_map::erase and do nothing
 }
 
-template<typename K, typename T, class Hash>
-void OpenAddressUnorderedMap<K,T,Hash>::rehash(std::size_t new_size) {
-  OpenAddressUnorderedMap<K,T,Hash> tmp_map(new_size);
-  for(size_t i = 0; i < _buckets.size(); ++i) {
-    if(_occupied[i] && !_deleted[i]) {
-      auto& item = _buckets[i];
-      tmp_map[std::move(std::get<0>(item))] = std::move(std::get<1>(item));
-    }
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T& OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::at(const K& key) {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
   }
-  *this = std::move(tmp_map);
+  return *value;
 }
 
-template<typename K, typename T, class Hash>
-std::unordered_map<K,T> OpenAddressUnorderedMap<K,T,Hash>::to_std_unordered_map() const {
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+const T& OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::at(const K& key) const {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+// the key is only copied if it has to be inserted
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T& OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::operator[](const K& key) {
+  return *emplace_key(key).first;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+T& OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::operator[](K&& key) {
+  return *emplace_key(std::move(key)).first;
+}
+
+// the tag is the top 7 bits of the mixed hash
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+std::size_t OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::hash_of(const Q& key) const {
+  return _mix_hash(_hasher(key));
+}
+
+// returns the bucket holding key, or bucket_count() if not found
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+std::size_t OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::get_bucket_for(const Q& key, std::size_t hash) const {
+  const auto bc = bucket_count();
+  const auto tag = tag_of(hash);
+  auto pos = hash % bc;
+
+  // groups are probed linearly, ceil(bc / 16) of them cover every bucket
+  for(std::size_t probed = 0; probed < bc; probed += simd_group_size) {
+    const std::int8_t* group = &_ctrl[pos];
+    auto match = simd_group_match(group, tag);
+    while(match != 0) {
+      auto i = wrap(pos + __builtin_ctz(match));
+      if(std::get<0>(_buckets[i]) == key) {
+        _stats.record_probe(probed / simd_group_size + 1);
+        return i;
+      }
+      // clear the lowest set bit
+      match &= match - 1;
+    }
+    // an empty bucket means the key was never pushed past this group
+    if(simd_group_match(group, _ctrl_empty) != 0) {
+      _stats.record_probe(probed / simd_group_size + 1);
+      return bc;
+    }
+    pos = wrap(pos + simd_group_size);
+  }
+
+  _stats.record_probe((bc + simd_group_size - 1) / simd_group_size);
+  return bc;
+}
+
+// the buckets are not modified, the caller decides whether the value may be
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class Q>
+T* OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::find_value(const Q& key) const {
+  auto bucket = get_bucket_for(key, hash_of(key));
+  if(bucket == bucket_count()) {
+    return nullptr;
+  }
+  return const_cast<T*>(&std::get<1>(_buckets[bucket]));
+}
+
+// inserts (key, T(args...)) unless key is present
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class KK, class... Args>
+std::pair<T*, bool> OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::emplace_key(KK&& key, Args&&... args) {
+  const auto hash = hash_of(key);
+  auto bucket = get_bucket_for(key, hash);
+
+  // if found, we are done
+  if(bucket < bucket_count()) {
+    return std::make_pair(&std::get<1>(_buckets[bucket]), false);
+  }
+
+  // if we get here, no element is assigned to that key
+  // (1) check if we need to rehash; deleted buckets count towards the
+  // load since probes have to walk over them too. If most of the load
+  // is deleted buckets, rehashing to the same size is enough
+  if((float)(size() + _deleted_count) / bucket_count() > max_load_factor()) {
+    rehash(std::max<std::size_t>(load_factor() > max_load_factor() / 2 ? bucket_count() * 2 : bucket_count(), 1));
+  }
+
+  // (2) no matter if we rehashed or not, find a place to set the key;
+  // it could be a deleted slot
+  bucket = get_free_bucket_for(hash);
+  assert(bucket < bucket_count());
+
+  if(_ctrl[bucket] == _ctrl_deleted) {
+    _deleted_count--;
+  }
+  std::get<0>(_buckets[bucket]) = std::forward<KK>(key);
+  std::get<1>(_buckets[bucket]) = T(std::forward<Args>(args)...);
+  set_ctrl(bucket, tag_of(hash));
+  _size++;
+  record_table();
+  return std::make_pair(&std::get<1>(_buckets[bucket]), true);
+}
+
+// returns the first empty or deleted bucket on the probe sequence
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+std::size_t OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::get_free_bucket_for(std::size_t hash) const {
+  const auto bc = bucket_count();
+  auto pos = hash % bc;
+
+  for(std::size_t probed = 0; probed < bc; probed += simd_group_size) {
+    auto free = simd_group_negative(&_ctrl[pos]);
+    if(free != 0) {
+      return wrap(pos + __builtin_ctz(free));
+    }
+    pos = wrap(pos + simd_group_size);
+  }
+
+  // table is full! this shouldn't happen ;)
+  return bc;
+}
+
+// writes the control byte of a bucket and its copies past the end
+// (tables smaller than a group have more than one)
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::set_ctrl(std::size_t bucket, std::int8_t ctrl) {
+  const auto bc = bucket_count();
+  _ctrl[bucket] = ctrl;
+  for(auto i = bucket + bc; i < bc + simd_group_size; i += bc) {
+    _ctrl[i] = ctrl;
+  }
+}
+
+// whether no probe ever walked over this bucket: every group containing
+// it also contains an empty bucket, so any lookup would have stopped
+// there anyway and the bucket can become empty instead of deleted
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+bool OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::was_never_full(std::size_t bucket) const {
+  const auto bc = bucket_count();
+  if(bc < simd_group_size) {
+    return false;
+  }
+  auto after = simd_group_match(&_ctrl[bucket], _ctrl_empty);
+  auto before = simd_group_match(&_ctrl[(bucket + bc - simd_group_size) % bc], _ctrl_empty);
+  // the run of non-empty buckets around this one is shorter than a group
+  return after != 0 && before != 0 &&
+         __builtin_ctz(after) + (__builtin_clz(before) - 16) < (int)simd_group_size;
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::erase(const K& key) {
+  auto bucket = get_bucket_for(key, hash_of(key));
+
+  if(bucket < bucket_count()) {
+    if(was_never_full(bucket)) {
+      set_ctrl(bucket, _ctrl_empty);
+    } else {
+      set_ctrl(bucket, _ctrl_deleted);
+      _deleted_count++;
+    }
+    _size--;
+
+    // check if we need to rehash
+    if(load_factor() < min_load_factor()) {
+      rehash(std::max<std::size_t>(bucket_count() / 2, 1));
+    }
+    record_table();
+  }
+  // if we get here, no element is assigned to that key
+  // we mimic the behaviour of std::unordered_map::erase and do nothing
+}
+
+// keys are known to be distinct, so every element goes straight to the
+// first free bucket of its probe sequence without comparing keys
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::rehash(std::size_t new_size) {
+  _stats.record_rehash();
+  const auto start = Stats::now();
+  OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats> tmp_map(new_size, _alloc);
+  for_each_live_bucket([&](std::size_t i) {
+    auto& item = _buckets[i];
+    const auto hash = hash_of(std::get<0>(item));
+    auto bucket = tmp_map.get_free_bucket_for(hash);
+    tmp_map._buckets[bucket] = std::move(item);
+    tmp_map.set_ctrl(bucket, tag_of(hash));
+    tmp_map._size++;
+  });
+  *this = std::move(tmp_map);
+  _stats.record_rehash_time(Stats::now() - start);
+}
+
+// calls f(i) for every bucket holding an element, a whole group of
+// empty or deleted buckets at a time is skipped
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+template<class F>
+void OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::for_each_live_bucket(F f) const {
+  const auto bc = bucket_count();
+  for(std::size_t g = 0; g < bc; g += simd_group_size) {
+    auto live = ~simd_group_negative(&_ctrl[g]) & 0xFFFF;
+    // the last group reads into the copied control bytes
+    if(bc - g < simd_group_size) {
+      live &= (1u << (bc - g)) - 1;
+    }
+    while(live != 0) {
+      f(g + __builtin_ctz(live));
+      // clear the lowest set bit
+      live &= live - 1;
+    }
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+std::unordered_map<K,T> OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>::to_std_unordered_map() const {
+  std::unordered_map<K,T> m;
+  for_each_live_bucket([&](std::size_t i) {
+    const auto& item = _buckets[i];
+    m[std::get<0>(item)] = std::get<1>(item);
+  });
+  return m;
+}
+
+// unordered map with open addressing and Robin Hood hashing
+// Every element remembers its distance to its home bucket (dist). When
+// inserting, an element that is further from home than the one in the
+// bucket takes the bucket and the evicted one keeps probing ("take from
+// the rich"), so distances stay short and close to each other. That gives
+//   * lookups that stop at the first bucket whose element is closer to
+//     home than the key would be, misses do not scan a whole cluster
+//   * erase by backward shift: the following elements move one bucket
+//     back until one is already at home, no tombstones are ever created
+//     and a long-lived table with churn does not degrade
+template<typename K, typename T, class Hash = std::hash<K>, class Alloc = std::allocator<std::pair<const K,T>>>
+class RobinHoodUnorderedMap : public UnorderedMap<K,T> {
+public:
+  using item_type = typename UnorderedMap<K,T>::item_type;
+  using allocator_type = Alloc;
+
+  RobinHoodUnorderedMap(const std::size_t bucket_size = 13, const Alloc& alloc = Alloc()); // O(bucket_size)
+  RobinHoodUnorderedMap(const RobinHoodUnorderedMap& other); // O(max(other.size()))
+  RobinHoodUnorderedMap(RobinHoodUnorderedMap&& rvr); // O(1)
+  RobinHoodUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc = Alloc()); // O(|l|)
+  // the (key, value) pairs of [first, last), in a table sized for all
+  // of them up front; see insert(first, last)
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  RobinHoodUnorderedMap(InputIt first, InputIt last, const Alloc& alloc = Alloc()); // O(|last - first|)
+  RobinHoodUnorderedMap& operator=(const RobinHoodUnorderedMap& other); // O(max(size(), other.size()))
+  RobinHoodUnorderedMap& operator=(RobinHoodUnorderedMap&& other); // O(size()) to deallocate
+
+  T& at(const K& key); // O(|n|) worst case, O(1) amortized
+  const T& at(const K& key) const; // O(|n|) worst case, O(1) amortized
+
+  T& operator[](const K& key); // O(|n|) worst case, O(1) amortized
+  T& operator[](K&& key); // O(|n|) worst case, O(1) amortized
+
+  void erase(const K& key); // O(|n|) worst case, O(1) amortized
+
+  // lookups that do not throw: the value with that key, nullptr if none
+  T* find(const K& key); // O(|n|) worst case, O(1) amortized
+  const T* find(const K& key) const; // O(|n|) worst case, O(1) amortized
+  bool contains(const K& key) const; // O(|n|) worst case, O(1) amortized
+  // heterogeneous lookups, for a transparent Hash (one with an
+  // is_transparent member type such as StringHash): the key is hashed as
+  // it is and compared to the stored keys with ==, no K is ever built
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  T* find(const Q& key); // O(|n|) worst case, O(1) amortized
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  const T* find(const Q& key) const; // O(|n|) worst case, O(1) amortized
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  bool contains(const Q& key) const; // O(|n|) worst case, O(1) amortized
+
+  // inserts T(args...) under key unless the key is present; returns the
+  // value with that key and whether it was inserted. The key is only
+  // copied (or moved) into the map when it is inserted
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(const K& key, Args&&... args); // O(|n|) worst case, O(1) amortized
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(K&& key, Args&&... args); // O(|n|) worst case, O(1) amortized
+  // like try_emplace(key, value), but a present value is assigned value
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(const K& key, M&& value); // O(|n|) worst case, O(1) amortized
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(K&& key, M&& value); // O(|n|) worst case, O(1) amortized
+
+  // makes room for n elements: no insert rehashes before size() reaches n
+  void reserve(std::size_t n); // O(max(size(), n))
+  // inserts the (key, value) pairs of [first, last) whose key is not in
+  // the map yet; of repeated keys the first one wins, as with
+  // std::unordered_map::insert. The table grows at most once for the whole
+  // batch, and the batch is sorted by bucket before it goes in
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  void insert(InputIt first, InputIt last); // O(|last - first|)
+
+  std::size_t size() const { return _size; } // O(1)
+  bool empty() const { return size() == 0; } // O(1)
+
+  std::size_t bucket_count() const { return _buckets.size(); }
+  float load_factor() const { return bucket_count() > 0 ? (float)size() / bucket_count() : 0.0f; }
+  float min_load_factor() const { return _min_load_factor; }
+  float max_load_factor() const { return _max_load_factor; }
+  // longest distance from an element to its home bucket
+  std::size_t max_probe_length() const; // O(bucket_count())
+
+  std::unordered_map<K,T> to_std_unordered_map() const;
+  Alloc get_allocator() const { return _alloc; }
+
+private:
+  using _item_type = std::pair<K,T>;
+  // the distance is kept next to the element, a probe reads both at once
+  struct _slot_type {
+    _item_type item;
+    // 0 for an empty bucket, otherwise 1 + the distance of its element
+    // to the element's home bucket
+    std::uint32_t dist = 0;
+  };
+  using _slot_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<_slot_type>;
+
+  template<class Q>
+  std::size_t hash_of(const Q& key) const { return _mix_hash(_hasher(key)); }
+  std::size_t next(std::size_t i) const { return i + 1 == bucket_count() ? 0 : i + 1; }
+  template<class Q>
+  std::size_t get_bucket_for(const Q& key, std::size_t hash) const;
+  template<class Q>
+  T* find_value(const Q& key) const;
+  template<class KK, class... Args>
+  std::pair<T*, bool> emplace_key(KK&& key, Args&&... args);
+  std::size_t insert_unique(std::size_t hash, _item_type&& item);
+  void rehash(std::size_t new_size);
+  void reset_to_one_bucket();
+
+private:
+  // Robin Hood keeps probes short even when the table is quite full
+  float _min_load_factor = 0.15;
+  float _max_load_factor = 0.85;
+  Hash _hasher;
+  Alloc _alloc;
+
+  std::vector<_slot_type, _slot_alloc_type> _buckets;
+  std::size_t _size;
+};
+
+template<typename K, typename T, class Hash, class Alloc>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>::RobinHoodUnorderedMap(const std::size_t bucket_size, const Alloc& alloc) :
+_alloc(alloc),
+_buckets(std::max<std::size_t>(bucket_size, 1), _slot_alloc_type(alloc)),
+_size(0) {
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>::RobinHoodUnorderedMap(const RobinHoodUnorderedMap& other) :
+_alloc(other._alloc),
+_buckets(other._buckets),
+_size(other._size) {
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>::RobinHoodUnorderedMap(RobinHoodUnorderedMap&& rvr) :
+_alloc(rvr._alloc),
+_buckets(std::move(rvr._buckets)),
+_size(rvr._size) {
+  rvr.reset_to_one_bucket();
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>::RobinHoodUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc) :
+RobinHoodUnorderedMap(1, alloc) {
+  reserve(l.size());
+  for(const auto& item : l) {
+    operator[](std::get<0>(item)) = std::get<1>(item);
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class InputIt, class>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>::RobinHoodUnorderedMap(InputIt first, InputIt last, const Alloc& alloc) :
+RobinHoodUnorderedMap(1, alloc) {
+  insert(first, last);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>& RobinHoodUnorderedMap<K,T,Hash,Alloc>::operator=(const RobinHoodUnorderedMap& other) {
+  if(this != &other) {
+    _buckets = other._buckets;
+    _size = other._size;
+  }
+  return *this;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+RobinHoodUnorderedMap<K,T,Hash,Alloc>& RobinHoodUnorderedMap<K,T,Hash,Alloc>::operator=(RobinHoodUnorderedMap&& other) {
+  if(this != &other) {
+    _buckets = std::move(other._buckets);
+    _size = other._size;
+    other.reset_to_one_bucket();
+  }
+  return *this;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void RobinHoodUnorderedMap<K,T,Hash,Alloc>::reset_to_one_bucket() {
+  _buckets.clear();
+  _buckets.resize(1);
+  _size = 0;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+T* RobinHoodUnorderedMap<K,T,Hash,Alloc>::find(const K& key) {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+const T* RobinHoodUnorderedMap<K,T,Hash,Alloc>::find(const K& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+bool RobinHoodUnorderedMap<K,T,Hash,Alloc>::contains(const K& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q, class H, class>
+T* RobinHoodUnorderedMap<K,T,Hash,Alloc>::find(const Q& key) {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q, class H, class>
+const T* RobinHoodUnorderedMap<K,T,Hash,Alloc>::find(const Q& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q, class H, class>
+bool RobinHoodUnorderedMap<K,T,Hash,Alloc>::contains(const Q& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class... Args>
+std::pair<T*, bool> RobinHoodUnorderedMap<K,T,Hash,Alloc>::try_emplace(const K& key, Args&&... args) {
+  return emplace_key(key, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class... Args>
+std::pair<T*, bool> RobinHoodUnorderedMap<K,T,Hash,Alloc>::try_emplace(K&& key, Args&&... args) {
+  return emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class M>
+std::pair<T*, bool> RobinHoodUnorderedMap<K,T,Hash,Alloc>::insert_or_assign(const K& key, M&& value) {
+  // emplace_key only uses value when it inserts
+  auto result = emplace_key(key, std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class M>
+std::pair<T*, bool> RobinHoodUnorderedMap<K,T,Hash,Alloc>::insert_or_assign(K&& key, M&& value) {
+  auto result = emplace_key(std::move(key), std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void RobinHoodUnorderedMap<K,T,Hash,Alloc>::reserve(std::size_t n) {
+  const auto needed = _buckets_for(n, max_load_factor());
+  if(needed > bucket_count()) {
+    rehash(needed);
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class InputIt, class>
+void RobinHoodUnorderedMap<K,T,Hash,Alloc>::insert(InputIt first, InputIt last) {
+  std::vector<_item_type> batch(first, last);
+  reserve(size() + batch.size());
+  _sort_by_bucket(batch, bucket_count(), [this](const K& key) { return hash_of(key) % bucket_count(); });
+  for(auto& item : batch) {
+    emplace_key(std::move(std::get<0>(item)), std::move(std::get<1>(item)));
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+T& RobinHoodUnorderedMap<K,T,Hash,Alloc>::at(const K& key) {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+const T& RobinHoodUnorderedMap<K,T,Hash,Alloc>::at(const K& key) const {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+// the key is only copied if it has to be inserted
+template<typename K, typename T, class Hash, class Alloc>
+T& RobinHoodUnorderedMap<K,T,Hash,Alloc>::operator[](const K& key) {
+  return *emplace_key(key).first;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+T& RobinHoodUnorderedMap<K,T,Hash,Alloc>::operator[](K&& key) {
+  return *emplace_key(std::move(key)).first;
+}
+
+// returns the bucket holding key, or bucket_count() if not found
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q>
+std::size_t RobinHoodUnorderedMap<K,T,Hash,Alloc>::get_bucket_for(const Q& key, std::size_t hash) const {
+  const auto bc = bucket_count();
+  auto i = hash % bc;
+
+  // dist is 1 + the distance the key would have at bucket i; the key
+  // would have evicted any element closer to its home than that
+  for(std::uint32_t dist = 1; _buckets[i].dist >= dist; ++dist) {
+    if(_buckets[i].dist == dist && std::get<0>(_buckets[i].item) == key) {
+      return i;
+    }
+    i = next(i);
+  }
+
+  return bc;
+}
+
+// the buckets are not modified, the caller decides whether the value may be
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q>
+T* RobinHoodUnorderedMap<K,T,Hash,Alloc>::find_value(const Q& key) const {
+  auto bucket = get_bucket_for(key, hash_of(key));
+  if(bucket == bucket_count()) {
+    return nullptr;
+  }
+  return const_cast<T*>(&std::get<1>(_buckets[bucket].item));
+}
+
+// inserts (key, T(args...)) unless key is present
+template<typename K, typename T, class Hash, class Alloc>
+template<class KK, class... Args>
+std::pair<T*, bool> RobinHoodUnorderedMap<K,T,Hash,Alloc>::emplace_key(KK&& key, Args&&... args) {
+  const auto hash = hash_of(key);
+  auto bucket = get_bucket_for(key, hash);
+
+  // if found, we are done
+  if(bucket < bucket_count()) {
+    return std::make_pair(&std::get<1>(_buckets[bucket].item), false);
+  }
+
+  // if we get here, no element is assigned to that key
+  // check if we need to rehash (the new element must fit)
+  if((float)(size() + 1) / bucket_count() > max_load_factor()) {
+    rehash(std::max<std::size_t>(bucket_count() * 2, 2));
+  }
+
+  bucket = insert_unique(hash, _item_type(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<KK>(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...)));
+  _size++;
+  return std::make_pair(&std::get<1>(_buckets[bucket].item), true);
+}
+
+// places an element whose key is not in the map, evicting richer
+// elements along the way, and returns the bucket where it ended up
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t RobinHoodUnorderedMap<K,T,Hash,Alloc>::insert_unique(std::size_t hash, _item_type&& item) {
+  const auto bc = bucket_count();
+  auto i = hash % bc;
+  auto result = bc;
+  _slot_type carried;
+  carried.item = std::move(item);
+  carried.dist = 1;
+
+  while(_buckets[i].dist != 0) {
+    if(_buckets[i].dist < carried.dist) {
+      // the element here is closer to home, it gives up its bucket
+      std::swap(_buckets[i], carried);
+      if(result == bc) {
+        result = i;
+      }
+    }
+    i = next(i);
+    ++carried.dist;
+  }
+
+  _buckets[i] = std::move(carried);
+  return result == bc ? i : result;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void RobinHoodUnorderedMap<K,T,Hash,Alloc>::erase(const K& key) {
+  auto bucket = get_bucket_for(key, hash_of(key));
+
+  if(bucket < bucket_count()) {
+    // backward shift: pull every following element that is not at its
+    // home bucket one bucket closer to it
+    auto i = bucket;
+    for(auto j = next(i); _buckets[j].dist > 1; i = j, j = next(j)) {
+      _buckets[i] = std::move(_buckets[j]);
+      _buckets[i].dist--;
+    }
+    // release whatever the last bucket held
+    _buckets[i] = _slot_type();
+    _size--;
+
+    // check if we need to rehash
+    if(load_factor() < min_load_factor()) {
+      rehash(std::max<std::size_t>(bucket_count() / 2, 1));
+    }
+  }
+  // if we get here, no element is assigned to that key
+  // we mimic the behaviour of std::unordered_map::erase and do nothing
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void RobinHoodUnorderedMap<K,T,Hash,Alloc>::rehash(std::size_t new_size) {
+  RobinHoodUnorderedMap<K,T,Hash,Alloc> tmp_map(new_size, _alloc);
+  for(auto& slot : _buckets) {
+    if(slot.dist != 0) {
+      const auto hash = hash_of(std::get<0>(slot.item));
+      tmp_map.insert_unique(hash, std::move(slot.item));
+      tmp_map._size++;
+    }
+  }
+  *this = std::move(tmp_map);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t RobinHoodUnorderedMap<K,T,Hash,Alloc>::max_probe_length() const {
+  std::uint32_t longest = 0;
+  for(const auto& slot : _buckets) {
+    longest = std::max(longest, slot.dist);
+  }
+  return longest > 0 ? longest - 1 : 0;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+std::unordered_map<K,T> RobinHoodUnorderedMap<K,T,Hash,Alloc>::to_std_unordered_map() const {
+  std::unordered_map<K,T> m;
+  for(const auto& slot : _buckets) {
+    if(slot.dist != 0) {
+      m[std::get<0>(slot.item)] = std::get<1>(slot.item);
+    }
+  }
+  return m;
+}
+
+// allocator adaptor that places arrays of U on Align-byte boundaries
+// through any allocator: operator new (and so std::allocator) only
+// guarantees alignof(std::max_align_t) before C++17. Every array is
+// over-allocated by Align bytes as bytes of Alloc, and the distance back
+// to the start of that block is kept in the byte just before the array
+template<typename U, class Alloc, std::size_t Align>
+class _AlignedAlloc {
+  static_assert(Align > 0 && Align <= 256 && (Align & (Align - 1)) == 0,
+                "The alignment must be a power of two that fits the offset byte");
+  using _byte_alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<unsigned char>;
+  using _byte_traits = std::allocator_traits<_byte_alloc_type>;
+
+public:
+  using value_type = U;
+  using propagate_on_container_copy_assignment = typename std::allocator_traits<Alloc>::propagate_on_container_copy_assignment;
+  using propagate_on_container_move_assignment = typename std::allocator_traits<Alloc>::propagate_on_container_move_assignment;
+  using propagate_on_container_swap = typename std::allocator_traits<Alloc>::propagate_on_container_swap;
+  template<typename V>
+  struct rebind {
+    using other = _AlignedAlloc<V, Alloc, Align>;
+  };
+
+  explicit _AlignedAlloc(const Alloc& alloc) : _bytes(alloc) { }
+  template<typename V>
+  _AlignedAlloc(const _AlignedAlloc<V, Alloc, Align>& o) : _bytes(o._bytes) { }
+
+  U* allocate(std::size_t n) {
+    unsigned char* block = _byte_traits::allocate(_bytes, n * sizeof(U) + Align);
+    // between 1 and Align bytes in, so the offset byte is in the block
+    const std::size_t offset = Align - reinterpret_cast<std::uintptr_t>(block) % Align;
+    unsigned char* p = block + offset;
+    p[-1] = (unsigned char)(offset - 1);
+    return reinterpret_cast<U*>(p);
+  }
+
+  void deallocate(U* p, std::size_t n) {
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(p);
+    const std::size_t offset = std::size_t(bytes[-1]) + 1;
+    _byte_traits::deallocate(_bytes, bytes - offset, n * sizeof(U) + Align);
+  }
+
+  template<typename V>
+  bool operator==(const _AlignedAlloc<V, Alloc, Align>& o) const { return _bytes == o._bytes; }
+  template<typename V>
+  bool operator!=(const _AlignedAlloc<V, Alloc, Align>& o) const { return !(*this == o); }
+
+private:
+  template<typename V, class A, std::size_t N>
+  friend class _AlignedAlloc;
+
+  _byte_alloc_type _bytes;
+};
+
+// unordered map with bucketized cuckoo hashing
+// Every key has two candidate buckets, given by two hash functions, and
+// a bucket holds up to _slots elements next to a tag byte per slot. A
+// key is always in one of its two buckets, so a lookup reads exactly two
+// buckets however full the table is: the second one is prefetched while
+// the first one is searched. A bucket that fits in a cache line (tags
+// and four slots in 64 bytes, e.g. <int,int>) is padded and aligned to
+// one, so such a lookup touches at most two lines; bigger buckets keep
+// their natural alignment. Only keys whose tag matches are compared.
+// Inserts pay for that: when both buckets of a new key are full, some
+// element of them is moved to its other bucket, which may first need to
+// move one of its own elements, and so on. The shortest such chain of
+// moves is found with a breadth-first search before anything is moved
+// (as libcuckoo does) and the table grows if there is none within
+// _max_search buckets. Two choices of four slots keep the chains short
+// up to ~95% load, so the table can be kept fuller than with probing.
+// The hash has to tell keys apart: no more than 2 * _slots keys can share
+// both buckets, and growing the table does not separate equal hashes.
+// An insert that finds no room after _max_growths growths, or whose two
+// buckets are already full of keys with its hash, throws std::length_error
+// and leaves the map as it was
+template<typename K, typename T, class Hash = std::hash<K>, class Alloc = std::allocator<std::pair<const K,T>>>
+class CuckooUnorderedMap : public UnorderedMap<K,T> {
+public:
+  using item_type = typename UnorderedMap<K,T>::item_type;
+  using allocator_type = Alloc;
+
+  // bucket_size is the number of elements the table starts with room for
+  CuckooUnorderedMap(const std::size_t bucket_size = 13, const Alloc& alloc = Alloc()); // O(bucket_size)
+  CuckooUnorderedMap(const CuckooUnorderedMap& other); // O(max(other.size()))
+  CuckooUnorderedMap(CuckooUnorderedMap&& rvr); // O(1)
+  CuckooUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc = Alloc()); // O(|l|)
+  // the (key, value) pairs of [first, last), in a table sized for all
+  // of them up front; see insert(first, last)
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  CuckooUnorderedMap(InputIt first, InputIt last, const Alloc& alloc = Alloc()); // O(|last - first|)
+  CuckooUnorderedMap& operator=(const CuckooUnorderedMap& other); // O(max(size(), other.size()))
+  CuckooUnorderedMap& operator=(CuckooUnorderedMap&& other); // O(size()) to deallocate
+
+  T& at(const K& key); // O(1)
+  const T& at(const K& key) const; // O(1)
+
+  T& operator[](const K& key); // O(1) amortized
+  T& operator[](K&& key); // O(1) amortized
+
+  void erase(const K& key); // O(1) amortized
+
+  // lookups that do not throw: the value with that key, nullptr if none
+  T* find(const K& key); // O(1)
+  const T* find(const K& key) const; // O(1)
+  bool contains(const K& key) const; // O(1)
+  // heterogeneous lookups, for a transparent Hash (one with an
+  // is_transparent member type such as StringHash): the key is hashed as
+  // it is and compared to the stored keys with ==, no K is ever built
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  T* find(const Q& key); // O(1)
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  const T* find(const Q& key) const; // O(1)
+  template<class Q, class H = Hash, class = typename H::is_transparent>
+  bool contains(const Q& key) const; // O(1)
+
+  // inserts T(args...) under key unless the key is present; returns the
+  // value with that key and whether it was inserted. The key is only
+  // copied (or moved) into the map when it is inserted
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(const K& key, Args&&... args); // O(1) amortized
+  template<class... Args>
+  std::pair<T*, bool> try_emplace(K&& key, Args&&... args); // O(1) amortized
+  // like try_emplace(key, value), but a present value is assigned value
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(const K& key, M&& value); // O(1) amortized
+  template<class M>
+  std::pair<T*, bool> insert_or_assign(K&& key, M&& value); // O(1) amortized
+
+  // makes room for n elements: no insert grows the table before size()
+  // reaches n (one that finds no chain of moves still might, which is
+  // very unlikely)
+  void reserve(std::size_t n); // O(max(size(), n))
+  // inserts the (key, value) pairs of [first, last) whose key is not in
+  // the map yet; of repeated keys the first one wins, as with
+  // std::unordered_map::insert. The table grows at most once for the whole
+  // batch, and the batch is sorted by bucket before it goes in
+  template<class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+  void insert(InputIt first, InputIt last); // O(|last - first|)
+
+  std::size_t size() const { return _size; } // O(1)
+  bool empty() const { return size() == 0; } // O(1)
+
+  // buckets of slots_per_bucket elements each
+  std::size_t bucket_count() const { return _buckets.size(); }
+  static std::size_t slots_per_bucket() { return _slots; }
+  float load_factor() const { return (float)size() / (bucket_count() * _slots); }
+  float min_load_factor() const { return _min_load_factor; }
+  float max_load_factor() const { return _max_load_factor; }
+
+  std::unordered_map<K,T> to_std_unordered_map() const;
+  Alloc get_allocator() const { return _alloc; }
+
+private:
+  using _item_type = std::pair<K,T>;
+
+  static const std::size_t _slots = 4;
+  // buckets the search for a chain of moves may visit before the table
+  // is grown instead
+  static const std::size_t _max_search = 256;
+  // times a single insert may grow the table looking for room
+  static const std::size_t _max_growths = 4;
+
+  static const std::size_t _cache_line = 64;
+
+  // the tags come first, a miss never reads past them
+  struct _bucket_layout {
+    // 0 for an empty slot
+    std::uint8_t tags[_slots] = {};
+    _item_type items[_slots];
+  };
+  // a bucket that fits in a cache line never straddles two
+  struct alignas(sizeof(_bucket_layout) <= _cache_line ? _cache_line : alignof(_bucket_layout))
+  _bucket_type : _bucket_layout {
+  };
+  using _bucket_alloc_type = _AlignedAlloc<_bucket_type, Alloc, alignof(_bucket_type)>;
+
+  // a bucket reached by the search: the element in slot of the parent's
+  // bucket would move to it
+  struct _search_node {
+    std::size_t bucket;
+    std::size_t parent;
+    std::size_t slot;
+  };
+
+  template<class Q>
+  std::size_t hash_of(const Q& key) const { return _mix_hash(_hasher(key)); }
+  // the top 8 bits of the hash, never 0
+  static std::uint8_t tag_of(std::size_t hash);
+  // the two buckets come from the mixed hash and a second mix of it, and
+  // are different whenever there is more than one bucket
+  std::size_t first_bucket(std::size_t hash) const { return hash % bucket_count(); }
+  std::size_t second_bucket(std::size_t hash) const;
+  std::size_t other_bucket(std::size_t hash, std::size_t bucket) const;
+  static std::size_t buckets_for_slots(std::size_t n) { return std::max<std::size_t>((n + _slots - 1) / _slots, 1); }
+  template<class Q>
+  static _item_type* find_in(const _bucket_type& bucket, std::uint8_t tag, const Q& key);
+  template<class Q>
+  _item_type* find_item(const Q& key) const;
+  template<class Q>
+  T* find_value(const Q& key) const;
+  template<class KK, class... Args>
+  std::pair<T*, bool> emplace_key(KK&& key, Args&&... args);
+  std::size_t free_slot(std::size_t bucket) const;
+  std::size_t search_path(std::size_t hash, _search_node* nodes) const;
+  std::size_t make_room(std::size_t hash);
+  bool full_of_hash(std::size_t hash) const;
+  template<class... Args>
+  _item_type& place(std::size_t bucket, std::size_t hash, Args&&... args);
+  void rehash(std::size_t new_bucket_count);
+  void reset_to_one_bucket();
+
+private:
+  float _min_load_factor = 0.15;
+  float _max_load_factor = 0.9;
+  Hash _hasher;
+  Alloc _alloc;
+
+  std::vector<_bucket_type, _bucket_alloc_type> _buckets;
+  std::size_t _size;
+};
+
+template<typename K, typename T, class Hash, class Alloc>
+const std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::_slots;
+
+template<typename K, typename T, class Hash, class Alloc>
+const std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::_max_search;
+
+template<typename K, typename T, class Hash, class Alloc>
+const std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::_max_growths;
+
+template<typename K, typename T, class Hash, class Alloc>
+const std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::_cache_line;
+
+template<typename K, typename T, class Hash, class Alloc>
+CuckooUnorderedMap<K,T,Hash,Alloc>::CuckooUnorderedMap(const std::size_t bucket_size, const Alloc& alloc) :
+_alloc(alloc),
+_buckets(buckets_for_slots(bucket_size), _bucket_alloc_type(alloc)),
+_size(0) {
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+CuckooUnorderedMap<K,T,Hash,Alloc>::CuckooUnorderedMap(const CuckooUnorderedMap& other) :
+_alloc(other._alloc),
+_buckets(other._buckets),
+_size(other._size) {
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+CuckooUnorderedMap<K,T,Hash,Alloc>::CuckooUnorderedMap(CuckooUnorderedMap&& rvr) :
+_alloc(rvr._alloc),
+_buckets(std::move(rvr._buckets)),
+_size(rvr._size) {
+  rvr.reset_to_one_bucket();
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+CuckooUnorderedMap<K,T,Hash,Alloc>::CuckooUnorderedMap(std::initializer_list<item_type> l, const Alloc& alloc) :
+CuckooUnorderedMap(1, alloc) {
+  reserve(l.size());
+  for(const auto& item : l) {
+    operator[](std::get<0>(item)) = std::get<1>(item);
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class InputIt, class>
+CuckooUnorderedMap<K,T,Hash,Alloc>::CuckooUnorderedMap(InputIt first, InputIt last, const Alloc& alloc) :
+CuckooUnorderedMap(1, alloc) {
+  insert(first, last);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+CuckooUnorderedMap<K,T,Hash,Alloc>& CuckooUnorderedMap<K,T,Hash,Alloc>::operator=(const CuckooUnorderedMap& other) {
+  if(this != &other) {
+    _buckets = other._buckets;
+    _size = other._size;
+  }
+  return *this;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+CuckooUnorderedMap<K,T,Hash,Alloc>& CuckooUnorderedMap<K,T,Hash,Alloc>::operator=(CuckooUnorderedMap&& other) {
+  if(this != &other) {
+    _buckets = std::move(other._buckets);
+    _size = other._size;
+    other.reset_to_one_bucket();
+  }
+  return *this;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void CuckooUnorderedMap<K,T,Hash,Alloc>::reset_to_one_bucket() {
+  _buckets.clear();
+  _buckets.resize(1);
+  _size = 0;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+std::uint8_t CuckooUnorderedMap<K,T,Hash,Alloc>::tag_of(std::size_t hash) {
+  const auto tag = (std::uint8_t)(hash >> (sizeof(std::size_t) * 8 - 8));
+  return tag != 0 ? tag : 1;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::second_bucket(std::size_t hash) const {
+  const auto bc = bucket_count();
+  const auto first = first_bucket(hash);
+  auto second = _mix_hash(hash) % bc;
+  if(second == first && bc > 1) {
+    second = first + 1 == bc ? 0 : first + 1;
+  }
+  return second;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::other_bucket(std::size_t hash, std::size_t bucket) const {
+  const auto first = first_bucket(hash);
+  return bucket == first ? second_bucket(hash) : first;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q>
+typename CuckooUnorderedMap<K,T,Hash,Alloc>::_item_type* CuckooUnorderedMap<K,T,Hash,Alloc>::find_in(const _bucket_type& bucket, std::uint8_t tag, const Q& key) {
+  for(std::size_t s = 0; s < _slots; ++s) {
+    if(bucket.tags[s] == tag && std::get<0>(bucket.items[s]) == key) {
+      return const_cast<_item_type*>(&bucket.items[s]);
+    }
+  }
+  return nullptr;
+}
+
+// the item with that key in either of its buckets, nullptr if none
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q>
+typename CuckooUnorderedMap<K,T,Hash,Alloc>::_item_type* CuckooUnorderedMap<K,T,Hash,Alloc>::find_item(const Q& key) const {
+  const auto hash = hash_of(key);
+  const auto tag = tag_of(hash);
+  const _bucket_type& second = _buckets[second_bucket(hash)];
+  // both loads are in flight at once
+  __builtin_prefetch(&second);
+  auto item = find_in(_buckets[first_bucket(hash)], tag, key);
+  return item != nullptr ? item : find_in(second, tag, key);
+}
+
+// the buckets are not modified, the caller decides whether the value may be
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q>
+T* CuckooUnorderedMap<K,T,Hash,Alloc>::find_value(const Q& key) const {
+  auto item = find_item(key);
+  return item != nullptr ? &std::get<1>(*item) : nullptr;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+T* CuckooUnorderedMap<K,T,Hash,Alloc>::find(const K& key) {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+const T* CuckooUnorderedMap<K,T,Hash,Alloc>::find(const K& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+bool CuckooUnorderedMap<K,T,Hash,Alloc>::contains(const K& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q, class H, class>
+T* CuckooUnorderedMap<K,T,Hash,Alloc>::find(const Q& key) {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q, class H, class>
+const T* CuckooUnorderedMap<K,T,Hash,Alloc>::find(const Q& key) const {
+  return find_value(key);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class Q, class H, class>
+bool CuckooUnorderedMap<K,T,Hash,Alloc>::contains(const Q& key) const {
+  return find_value(key) != nullptr;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class... Args>
+std::pair<T*, bool> CuckooUnorderedMap<K,T,Hash,Alloc>::try_emplace(const K& key, Args&&... args) {
+  return emplace_key(key, std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class... Args>
+std::pair<T*, bool> CuckooUnorderedMap<K,T,Hash,Alloc>::try_emplace(K&& key, Args&&... args) {
+  return emplace_key(std::move(key), std::forward<Args>(args)...);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class M>
+std::pair<T*, bool> CuckooUnorderedMap<K,T,Hash,Alloc>::insert_or_assign(const K& key, M&& value) {
+  // emplace_key only uses value when it inserts
+  auto result = emplace_key(key, std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class M>
+std::pair<T*, bool> CuckooUnorderedMap<K,T,Hash,Alloc>::insert_or_assign(K&& key, M&& value) {
+  auto result = emplace_key(std::move(key), std::forward<M>(value));
+  if(!result.second) {
+    *result.first = std::forward<M>(value);
+  }
+  return result;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void CuckooUnorderedMap<K,T,Hash,Alloc>::reserve(std::size_t n) {
+  const auto needed = buckets_for_slots(_buckets_for(n, max_load_factor()));
+  if(needed > bucket_count()) {
+    rehash(needed);
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+template<class InputIt, class>
+void CuckooUnorderedMap<K,T,Hash,Alloc>::insert(InputIt first, InputIt last) {
+  std::vector<_item_type> batch(first, last);
+  reserve(size() + batch.size());
+  _sort_by_bucket(batch, bucket_count(), [this](const K& key) { return first_bucket(hash_of(key)); });
+  for(auto& item : batch) {
+    emplace_key(std::move(std::get<0>(item)), std::move(std::get<1>(item)));
+  }
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+T& CuckooUnorderedMap<K,T,Hash,Alloc>::at(const K& key) {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+const T& CuckooUnorderedMap<K,T,Hash,Alloc>::at(const K& key) const {
+  auto value = find_value(key);
+  if(value == nullptr) {
+    throw std::out_of_range("key not present");
+  }
+  return *value;
+}
+
+// the key is only copied if it has to be inserted
+template<typename K, typename T, class Hash, class Alloc>
+T& CuckooUnorderedMap<K,T,Hash,Alloc>::operator[](const K& key) {
+  return *emplace_key(key).first;
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+T& CuckooUnorderedMap<K,T,Hash,Alloc>::operator[](K&& key) {
+  return *emplace_key(std::move(key)).first;
+}
+
+// inserts (key, T(args...)) unless key is present
+template<typename K, typename T, class Hash, class Alloc>
+template<class KK, class... Args>
+std::pair<T*, bool> CuckooUnorderedMap<K,T,Hash,Alloc>::emplace_key(KK&& key, Args&&... args) {
+  auto value = find_value(key);
+  if(value != nullptr) {
+    return std::make_pair(value, false);
+  }
+
+  // if we get here, no element is assigned to that key
+  // check if we need to rehash (the new element must fit)
+  if((float)(size() + 1) / (bucket_count() * _slots) > max_load_factor()) {
+    rehash(bucket_count() * 2);
+  }
+
+  // the element is only built once there is a slot for it
+  const auto hash = hash_of(key);
+  auto bucket = make_room(hash);
+  for(std::size_t growths = 0; bucket == bucket_count(); ++growths) {
+    // growing moves keys whose buckets collide apart, but never keys
+    // whose hashes are equal
+    if(growths == _max_growths || full_of_hash(hash)) {
+      throw std::length_error("too many keys with the same hash");
+    }
+    rehash(bucket_count() * 2);
+    bucket = make_room(hash);
+  }
+  auto& item = place(bucket, hash, std::piecewise_construct,
+                     std::forward_as_tuple(std::forward<KK>(key)),
+                     std::forward_as_tuple(std::forward<Args>(args)...));
+  _size++;
+  return std::make_pair(&std::get<1>(item), true);
+}
+
+// the first empty slot of bucket, _slots if it is full
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::free_slot(std::size_t bucket) const {
+  const _bucket_type& b = _buckets[bucket];
+  std::size_t s = 0;
+  while(s < _slots && b.tags[s] != 0) {
+    ++s;
+  }
+  return s;
+}
+
+// breadth-first search from the two buckets of hash for a bucket with
+// an empty slot; returns its node (the chain of moves goes back through
+// the parents to one of the two buckets) or _max_search if there is none.
+// No bucket is visited twice, so no slot is part of the chain twice
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::search_path(std::size_t hash, _search_node* nodes) const {
+  const auto none = _max_search;
+  std::size_t count = 0;
+  nodes[count++] = _search_node{first_bucket(hash), none, 0};
+  if(second_bucket(hash) != nodes[0].bucket) {
+    nodes[count++] = _search_node{second_bucket(hash), none, 0};
+  }
+
+  for(std::size_t head = 0; head < count; ++head) {
+    const auto bucket = nodes[head].bucket;
+    if(free_slot(bucket) < _slots) {
+      return head;
+    }
+    for(std::size_t s = 0; s < _slots && count < _max_search; ++s) {
+      const auto next = other_bucket(hash_of(std::get<0>(_buckets[bucket].items[s])), bucket);
+      bool visited = false;
+      for(std::size_t i = 0; i < count && !visited; ++i) {
+        visited = nodes[i].bucket == next;
+      }
+      if(!visited) {
+        nodes[count++] = _search_node{next, head, s};
+      }
+    }
+  }
+  return none;
+}
+
+// returns whichever of the two buckets of hash has an empty slot, after
+// moving elements along the chain found by search_path, or bucket_count()
+// without moving anything if there is no chain
+template<typename K, typename T, class Hash, class Alloc>
+std::size_t CuckooUnorderedMap<K,T,Hash,Alloc>::make_room(std::size_t hash) {
+  _search_node nodes[_max_search];
+  auto i = search_path(hash, nodes);
+  if(i == _max_search) {
+    return bucket_count();
+  }
+
+  // the last bucket of the chain has an empty slot; every move frees
+  // the slot the next one (towards the start of the chain) fills
+  for(; nodes[i].parent != _max_search; i = nodes[i].parent) {
+    _bucket_type& from = _buckets[nodes[nodes[i].parent].bucket];
+    const auto s = nodes[i].slot;
+    const auto moved_hash = hash_of(std::get<0>(from.items[s]));
+    place(nodes[i].bucket, moved_hash, std::move(from.items[s]));
+    from.tags[s] = 0;
+  }
+  return nodes[i].bucket;
+}
+
+// whether every slot of both buckets of hash holds a key with that hash
+template<typename K, typename T, class Hash, class Alloc>
+bool CuckooUnorderedMap<K,T,Hash,Alloc>::full_of_hash(std::size_t hash) const {
+  for(auto bucket : { first_bucket(hash), second_bucket(hash) }) {
+    const _bucket_type& b = _buckets[bucket];
+    for(std::size_t s = 0; s < _slots; ++s) {
+      if(b.tags[s] == 0 || hash_of(std::get<0>(b.items[s])) != hash) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// builds an element in an empty slot of bucket, which must have one
+template<typename K, typename T, class Hash, class Alloc>
+template<class... Args>
+typename CuckooUnorderedMap<K,T,Hash,Alloc>::_item_type& CuckooUnorderedMap<K,T,Hash,Alloc>::place(std::size_t bucket, std::size_t hash, Args&&... args) {
+  const auto s = free_slot(bucket);
+  assert(s < _slots);
+  _bucket_type& b = _buckets[bucket];
+  b.items[s] = _item_type(std::forward<Args>(args)...);
+  b.tags[s] = tag_of(hash);
+  return b.items[s];
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void CuckooUnorderedMap<K,T,Hash,Alloc>::erase(const K& key) {
+  const auto hash = hash_of(key);
+  const auto tag = tag_of(hash);
+
+  for(auto bucket : { first_bucket(hash), second_bucket(hash) }) {
+    _bucket_type& b = _buckets[bucket];
+    for(std::size_t s = 0; s < _slots; ++s) {
+      if(b.tags[s] == tag && std::get<0>(b.items[s]) == key) {
+        b.tags[s] = 0;
+        // release whatever the slot held
+        b.items[s] = _item_type();
+        _size--;
+
+        // check if we need to rehash
+        if(load_factor() < min_load_factor() && bucket_count() > 1) {
+          rehash(bucket_count() / 2);
+        }
+        return;
+      }
+    }
+  }
+  // if we get here, no element is assigned to that key
+  // we mimic the behaviour of std::unordered_map::erase and do nothing
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+void CuckooUnorderedMap<K,T,Hash,Alloc>::rehash(std::size_t new_bucket_count) {
+  CuckooUnorderedMap<K,T,Hash,Alloc> tmp_map(std::max<std::size_t>(new_bucket_count, 1) * _slots, _alloc);
+  for(auto& b : _buckets) {
+    for(std::size_t s = 0; s < _slots; ++s) {
+      if(b.tags[s] != 0) {
+        const auto hash = hash_of(std::get<0>(b.items[s]));
+        // these keys all had room in one table, a bigger one is found fast
+        auto bucket = tmp_map.make_room(hash);
+        while(bucket == tmp_map.bucket_count()) {
+          tmp_map.rehash(tmp_map.bucket_count() * 2);
+          bucket = tmp_map.make_room(hash);
+        }
+        tmp_map.place(bucket, hash, std::move(b.items[s]));
+        tmp_map._size++;
+      }
+    }
+  }
+  *this = std::move(tmp_map);
+}
+
+template<typename K, typename T, class Hash, class Alloc>
+std::unordered_map<K,T> CuckooUnorderedMap<K,T,Hash,Alloc>::to_std_unordered_map() const {
   std::unordered_map<K,T> m;
-  for(size_t i = 0; i < _buckets.size(); ++i) {
-    if(_occupied[i] && !_deleted[i]) {
-      const auto& item = _buckets[i];
-      m[std::get<0>(item)] = std::get<1>(item);
+  for(const auto& b : _buckets) {
+    for(std::size_t s = 0; s < _slots; ++s) {
+      if(b.tags[s] != 0) {
+        m[std::get<0>(b.items[s])] = std::get<1>(b.items[s]);
+      }
     }
   }
   return m;
@@ -5,6 +5,10 @@
 #include <unordered_map>
 #include <sstream>
 #include <string>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstdint>
 #include "map.h"
 #include "../test_helpers.h"
 
@@ -36,7 +40,7 @@ private:
 };
 
 template<typename K, typename T,
-  template<typename Ka, typename Ta, class Hash=std::hash<Ka>> class ConcreteMap
+  template<typename...> class ConcreteMap
 >
 void test_unordered_map(TestHelper& th, Generator<K>& GenKey, Generator<T>& GenValue) {
   {
@@ -223,6 +227,610 @@ void test_unordered_map(TestHelper& th, Generator<K>& GenKey, Generator<T>& GenV
   }
 }
 
+// a key that counts how many times keys were copied
+struct CountedKey {
+  CountedKey(int v = 0) : value(v) { }
+  CountedKey(const CountedKey& o) : value(o.value) { copies++; }
+  CountedKey(CountedKey&& o) = default;
+  CountedKey& operator=(const CountedKey& o) { value = o.value; copies++; return *this; }
+  CountedKey& operator=(CountedKey&& o) = default;
+  bool operator==(const CountedKey& o) const { return value == o.value; }
+
+  int value;
+  static int copies;
+};
+
+int CountedKey::copies = 0;
+
+// to_std_unordered_map() needs std::hash
+namespace std {
+template<>
+struct hash<CountedKey> {
+  std::size_t operator()(const CountedKey& k) const { return std::hash<int>()(k.value); }
+};
+}
+
+template<template<typename...> class ConcreteMap>
+void test_lookup_api(TestHelper& th) {
+  {
+    ConcreteMap<std::string, int> m;
+    th.message("find and contains");
+    m["one"] = 1;
+    const auto& cm = m;
+    th.tassert();
+    th.tassert(m.find("one") != nullptr && *m.find("one") == 1, true, "find(\"one\") points to 1");
+    th.tassert(cm.find("two") == nullptr, true, "find(\"two\") is nullptr");
+    th.tassert(m.contains("one"), true, "Contains \"one\"");
+    th.tassert(m.contains("two"), false, "Does not contain \"two\"");
+    *m.find("one") = 11;
+    th.tassert(m.at("one"), 11, "Values can be modified through find");
+
+    th.message("try_emplace");
+    auto r1 = m.try_emplace("two", 2);
+    auto r2 = m.try_emplace("two", 22);
+    th.tassert();
+    th.tassert(r1.second, true, "First try_emplace inserts");
+    th.tassert(r2.second, false, "Second try_emplace does not");
+    th.tassert(r1.first == r2.first && *r2.first == 2, true, "Both point to the value 2");
+    th.tassert(*m.try_emplace("zero").first, 0, "No arguments value-initializes");
+
+    th.message("insert_or_assign");
+    auto r3 = m.insert_or_assign("three", 3);
+    auto r4 = m.insert_or_assign("three", 33);
+    th.tassert();
+    th.tassert(r3.second && !r4.second, true, "Inserts, then assigns");
+    th.tassert(m.at("three"), 33, "Value was assigned");
+    th.tassert(m.size(), (std::size_t)4, "Size is 4");
+  }
+
+  {
+    ConcreteMap<CountedKey, int> m;
+    th.message("Keys are only copied when inserted");
+    CountedKey k(5);
+    m[k] = 1;
+    CountedKey::copies = 0;
+    for(int i = 0; i < 10; ++i) {
+      m[k]++;
+    }
+    m.try_emplace(k, 7);
+    m.insert_or_assign(k, 8);
+    th.tassert();
+    th.tassert(CountedKey::copies, 0, "No copies for present keys");
+    m[CountedKey(6)] = 1;
+    th.tassert(CountedKey::copies, 0, "Temporaries are moved in");
+  }
+
+  {
+    ConcreteMap<std::string, int, StringHash> m;
+    th.message("Heterogeneous lookup with a transparent hash");
+    for(int i = 0; i < 100; ++i) {
+      m[std::to_string(i)] = i;
+    }
+    const char* key = "42";
+    th.tassert();
+    th.tassert(StringHash()(key), StringHash()(std::string(key)), "const char* hashes like std::string");
+    th.tassert(m.find(key) != nullptr && *m.find(key) == 42, true, "find(const char*) finds \"42\"");
+    th.tassert(m.contains("100"), false, "Does not contain \"100\"");
+  }
+}
+
+template<template<typename...> class ConcreteMap>
+void test_bulk_build(TestHelper& th) {
+  {
+    ConcreteMap<int, int> m;
+    th.message("reserve");
+    m.reserve(1000);
+    const auto buckets = m.bucket_count();
+    for(int i = 0; i < 1000; ++i) {
+      m[i * 7919] = i;
+    }
+    th.tassert();
+    th.tassert(m.bucket_count(), buckets, "1000 inserts did not rehash");
+    th.tassert(m.load_factor() > m.max_load_factor() / 2, true, "The table is not oversized");
+    m.reserve(10);
+    th.tassert(m.bucket_count(), buckets, "reserve never shrinks");
+  }
+
+  {
+    std::vector<std::pair<int, int>> items;
+    for(int i = 0; i < 5000; ++i) {
+      items.push_back(std::make_pair(i * 31, i));
+    }
+    items.push_back(std::make_pair(0, -1));
+    th.message("Range construction");
+    ConcreteMap<int, int> m(items.begin(), items.end());
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)5000, "Size is 5000");
+    th.tassert(m.at(31 * 4999), 4999, "Last key is present");
+    th.tassert(m.at(0), 0, "First of a repeated key wins");
+    th.tassert(m.load_factor() > m.max_load_factor() / 2, true, "Table was sized for the batch");
+
+    th.message("Bulk insert into a non-empty map");
+    std::unordered_map<std::string, int> more;
+    for(int i = 0; i < 3000; ++i) {
+      more[std::to_string(i)] = i;
+    }
+    ConcreteMap<std::string, int> sm = {{"0", -1}, {"x", 1}};
+    sm.insert(more.begin(), more.end());
+    th.tassert();
+    th.tassert(sm.size(), (std::size_t)3001, "Size is 3001");
+    th.tassert(sm.at("0"), -1, "Present keys are not overwritten");
+    th.tassert(sm.at("2999"), 2999, "New keys are inserted");
+    auto stdm = sm.to_std_unordered_map();
+    more["0"] = -1;
+    more["x"] = 1;
+    th.tassert(stdm == more, true, "Check complete map");
+  }
+
+  {
+    th.message("Initializer list construction sizes the table");
+    ConcreteMap<int, int> m = {{1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}, {6, 6}, {7, 7}, {8, 8}, {9, 9}, {10, 10}};
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)10, "Size is 10");
+    th.tassert(m.load_factor() > m.max_load_factor() / 2, true, "Table was sized for 10 elements");
+  }
+}
+
+// every key lands on the same home bucket with the same tag
+struct ConstantHash {
+  std::size_t operator()(int) const { return 42; }
+};
+
+void test_open_address_probing(TestHelper& th) {
+  {
+    OpenAddressUnorderedMap<int, int, ConstantHash> m;
+    th.message("Keys that all collide");
+    for(int i = 0; i < 100; ++i) {
+      m[i] = -i;
+    }
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)100, "Size is 100");
+    bool all = true;
+    for(int i = 0; i < 100; ++i) {
+      all = all && m.at(i) == -i;
+    }
+    th.tassert(all, true, "Every key is found past the others");
+    for(int i = 0; i < 100; i += 2) {
+      m.erase(i);
+    }
+    all = true;
+    for(int i = 1; i < 100; i += 2) {
+      all = all && m.at(i) == -i;
+    }
+    th.tassert(all, true, "Odd keys are found past the erased even ones");
+    th.tassert(m.to_std_unordered_map().count(0), (std::size_t)0, "Erased keys are gone");
+  }
+
+  {
+    OpenAddressUnorderedMap<int, int> m;
+    std::unordered_map<int, int> stdm;
+    th.message("Insert/erase churn on a long-lived table");
+    for(int i = 0; i < 1000; ++i) {
+      m[i] = i;
+      stdm[i] = i;
+    }
+    std::size_t buckets = m.bucket_count();
+    bool bounded = true;
+    for(int i = 1000; i < 50000; ++i) {
+      m.erase(i - 1000);
+      stdm.erase(i - 1000);
+      m[i] = i;
+      stdm[i] = i;
+      bounded = bounded && (float)(m.size() + m.deleted_count()) / m.bucket_count() <= m.max_load_factor() + 0.01f;
+    }
+    th.tassert();
+    th.tassert(bounded, true, "Deleted buckets never push the load past the maximum");
+    th.tassert(m.bucket_count() <= 2 * buckets, true, "Bucket count grew at most once");
+    th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+    m[123] = 1;
+    th.tassert(m.at(123), 1, "Reinserting an erased key starts from a new value");
+  }
+
+  {
+    OpenAddressUnorderedMap<int, int> m(1);
+    th.message("Tables smaller than a group");
+    for(int i = 0; i < 10; ++i) {
+      m[i] = i;
+    }
+    th.tassert();
+    bool all = true;
+    for(int i = 0; i < 10; ++i) {
+      all = all && m.at(i) == i;
+    }
+    th.tassert(all, true, "Every key is found");
+  }
+}
+
+void test_robin_hood(TestHelper& th) {
+  {
+    RobinHoodUnorderedMap<int, int, ConstantHash> m;
+    th.message("Keys that all collide");
+    for(int i = 0; i < 100; ++i) {
+      m[i] = -i;
+    }
+    th.tassert();
+    th.tassert(m.max_probe_length(), (std::size_t)99, "The last key is 99 buckets from home");
+    for(int i = 0; i < 100; i += 2) {
+      m.erase(i);
+    }
+    bool all = true;
+    for(int i = 1; i < 100; i += 2) {
+      all = all && m.at(i) == -i;
+    }
+    th.tassert(all, true, "Odd keys are found after erasing the even ones");
+    th.tassert(m.max_probe_length(), (std::size_t)49, "Backward shift pulled them closer to home");
+  }
+
+  {
+    RobinHoodUnorderedMap<int, int> m;
+    std::unordered_map<int, int> stdm;
+    th.message("Insert/erase churn on a long-lived table");
+    for(int i = 0; i < 1000; ++i) {
+      m[i] = i;
+      stdm[i] = i;
+    }
+    std::size_t buckets = m.bucket_count();
+    std::size_t longest = 0;
+    for(int i = 1000; i < 50000; ++i) {
+      m.erase(i - 1000);
+      stdm.erase(i - 1000);
+      m[i] = i;
+      stdm[i] = i;
+      longest = std::max(longest, m.max_probe_length());
+    }
+    th.tassert();
+    th.tassert(m.bucket_count(), buckets, "Bucket count did not change");
+    th.tassert(longest < 32, true, "Probes stayed short");
+    th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+  }
+}
+
+// every key lands in the same bucket
+struct ConstantStringHash {
+  std::size_t operator()(const std::string&) const { return 42; }
+};
+
+void test_chains(TestHelper& th) {
+  ChainedUnorderedMap<std::string, std::string, ConstantStringHash> m;
+  std::unordered_map<std::string, std::string> stdm;
+  th.message("Keys that all collide");
+  for(int i = 0; i < 200; ++i) {
+    m[std::to_string(i)] = std::string(40, 'a' + i % 26);
+    stdm[std::to_string(i)] = std::string(40, 'a' + i % 26);
+  }
+  th.tassert();
+  th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+
+  th.message("Erase the inline element and chained ones");
+  for(int i = 0; i < 200; i += 3) {
+    m.erase(std::to_string(i));
+    stdm.erase(std::to_string(i));
+  }
+  th.tassert();
+  th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+  bool all = true;
+  for(const auto& kv : stdm) {
+    all = all && m.at(kv.first) == kv.second;
+  }
+  th.tassert(all, true, "Every remaining key is found");
+
+  th.message("Copies own their chains");
+  auto copy = m;
+  m.erase("1");
+  m["new"] = "value";
+  th.tassert();
+  th.tassert(copy.to_std_unordered_map() == stdm, true, "Copy is unchanged");
+  th.tassert(m.at("new"), std::string("value"), "Original was updated");
+
+  th.message("Pooled nodes are reused");
+  for(int round = 0; round < 10; ++round) {
+    for(int i = 0; i < 100; ++i) {
+      m[std::to_string(1000 + i)] = "x";
+    }
+    for(int i = 0; i < 100; ++i) {
+      m.erase(std::to_string(1000 + i));
+    }
+  }
+  th.tassert();
+  th.tassert(m.size(), stdm.size(), "Size is back where it was");
+}
+
+void test_incremental_rehash(TestHelper& th) {
+  ChainedUnorderedMap<int, int> m;
+  std::unordered_map<int, int> stdm;
+  int next = 0;
+
+  th.message("Growing starts an incremental rehash");
+  while(!m.rehashing()) {
+    m[next] = next;
+    stdm[next] = next;
+    next++;
+  }
+  th.tassert();
+  th.tassert(m.to_std_unordered_map() == stdm, true, "Elements are split between both tables");
+  const ChainedUnorderedMap<int, int>& cm = m;
+  bool all = true;
+  for(int i = 0; i < next; ++i) {
+    all = all && cm.at(i) == i;
+  }
+  th.tassert(all, true, "Lookups find elements in both tables");
+
+  th.message("Erase and insert while rehashing");
+  for(int i = 0; i < next; i += 3) {
+    m.erase(i);
+    stdm.erase(i);
+    m[next + i] = i;
+    stdm[next + i] = i;
+  }
+  th.tassert();
+  th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+
+  th.message("Later operations finish the rehash");
+  int steps = 0;
+  while(m.rehashing()) {
+    m.at(1);
+    steps++;
+  }
+  th.tassert();
+  th.tassert(steps < (int)m.bucket_count(), true, "Every step moved some buckets");
+  th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+
+  th.message("Shrinking is incremental too");
+  for(auto& kv : stdm) {
+    m.erase(kv.first);
+  }
+  m[-1] = -1;
+  th.tassert();
+  th.tassert(m.size(), (std::size_t)1, "Size is 1");
+  th.tassert(m.at(-1), -1, "m.at(-1) == -1");
+}
+
+void test_cuckoo(TestHelper& th) {
+  {
+    CuckooUnorderedMap<int, int> m;
+    th.message("Filling the reserved table up to the max load factor");
+    const std::size_t n = 20000;
+    m.reserve(n);
+    const auto buckets = m.bucket_count();
+    for(std::size_t i = 0; i < n; ++i) {
+      m[(int)(i * 2654435761u)] = (int)i;
+    }
+    th.tassert();
+    th.tassert(m.bucket_count(), buckets, "Chains of moves were found, the table did not grow");
+    th.tassert(m.load_factor() > 0.85f, true, "Load factor is above 0.85");
+    bool all = true;
+    for(std::size_t i = 0; i < n; ++i) {
+      const int* v = m.find((int)(i * 2654435761u));
+      all = all && v != nullptr && *v == (int)i;
+    }
+    th.tassert(all, true, "Every key is found after being moved around");
+    th.tassert(m.contains(1), false, "Does not contain 1");
+
+    th.message("Erasing every other key");
+    for(std::size_t i = 0; i < n; i += 2) {
+      m.erase((int)(i * 2654435761u));
+    }
+    all = true;
+    for(std::size_t i = 0; i < n; ++i) {
+      all = all && m.contains((int)(i * 2654435761u)) == (i % 2 == 1);
+    }
+    th.tassert();
+    th.tassert(m.size(), n / 2, "Size is halved");
+    th.tassert(all, true, "Exactly the odd keys are left");
+  }
+
+  {
+    CuckooUnorderedMap<int, int> m;
+    std::unordered_map<int, int> stdm;
+    th.message("Insert/erase churn on a long-lived table");
+    for(int i = 0; i < 50000; ++i) {
+      m.erase(i - 1000);
+      stdm.erase(i - 1000);
+      m[i] = i;
+      stdm[i] = i;
+    }
+    th.tassert();
+    th.tassert(m.to_std_unordered_map() == stdm, true, "Equal maps");
+    th.tassert(CuckooUnorderedMap<int, int>::slots_per_bucket(), (std::size_t)4, "Buckets are 4-way");
+  }
+
+  {
+    CuckooUnorderedMap<int, int> m;
+    th.message("Buckets of <int, int> sit in one cache line each");
+    for(int i = 0; i < 10000; ++i) {
+      m[i] = i;
+    }
+    // 4 tag bytes and four 8-byte pairs: every value is in the first 36
+    // bytes of a 64-byte line if and only if each bucket starts one
+    bool aligned = true;
+    for(int i = 0; i < 10000; ++i) {
+      const std::size_t offset = reinterpret_cast<std::uintptr_t>(m.find(i)) % 64;
+      aligned = aligned && offset + sizeof(int) <= 36;
+    }
+    th.tassert();
+    th.tassert(aligned, true, "Every bucket starts a cache line");
+  }
+
+  {
+    CuckooUnorderedMap<int, int, ConstantHash> m;
+    th.message("Keys that all share one hash");
+    for(int i = 0; i < 8; ++i) {
+      m[i] = i;
+    }
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)8, "Two full buckets of them fit");
+    const auto buckets = m.bucket_count();
+    bool thrown = false;
+    try {
+      m[8] = 8;
+    } catch(std::length_error&) {
+      thrown = true;
+    }
+    th.tassert(thrown, true, "The ninth throws std::length_error");
+    th.tassert(m.bucket_count(), buckets, "The table did not grow for it");
+    th.tassert(m.size(), (std::size_t)8, "Size is still 8");
+    bool all = true;
+    for(int i = 0; i < 8; ++i) {
+      all = all && m.at(i) == i;
+    }
+    th.tassert(all, true, "The first eight are still found");
+    th.tassert(m.contains(8), false, "The ninth is not");
+  }
+}
+
+// tombstones the statistics of a map should report
+template<class Map>
+std::size_t tombstones_of(const Map&) { return 0; }
+
+template<typename K, typename T, class Hash, class Alloc, class Stats>
+std::size_t tombstones_of(const OpenAddressUnorderedMap<K,T,Hash,Alloc,Stats>& m) { return m.deleted_count(); }
+
+template<template<typename...> class ConcreteMap>
+void test_stats(TestHelper& th) {
+  using Map = ConcreteMap<int, int, std::hash<int>, std::allocator<std::pair<const int, int>>, MapStats>;
+  using CollidingMap = ConcreteMap<int, int, ConstantHash, std::allocator<std::pair<const int, int>>, MapStats>;
+
+  {
+    Map m;
+    th.message("Lookups, rehashes and the table are counted");
+    for(int i = 0; i < 10000; ++i) {
+      m[i] = i;
+    }
+    const auto before = m.stats().snapshot();
+    std::size_t found = 0;
+    for(int i = 0; i < 20000; ++i) {
+      found += m.contains(i);
+    }
+    const auto s = m.stats().snapshot();
+    th.tassert();
+    th.tassert(found, (std::size_t)10000, "Half of the lookups hit");
+    th.tassert(s.lookups - before.lookups, (std::uint64_t)20000, "Every lookup is counted");
+    th.tassert(s.rehash_count > 0, true, "Growing the table rehashed it");
+    th.tassert(s.rehash_ns > 0, true, "Rehashing took some time");
+    th.tassert(s.size, m.size(), "Size is reported");
+    th.tassert(s.bucket_count, m.bucket_count(), "Bucket count is reported");
+    th.tassert(s.load_factor, m.load_factor(), "Load factor is reported");
+    th.tassert((double)(s.probe_total - before.probe_total) / 20000 < 2, true, "Lookups with a good hash are short");
+  }
+
+  {
+    CollidingMap m;
+    th.message("A hash that collides shows in the histogram");
+    for(int i = 0; i < 100; ++i) {
+      m[i] = i;
+    }
+    const auto before = m.stats().snapshot();
+    for(int i = 0; i < 100; ++i) {
+      m.contains(i);
+    }
+    const auto s = m.stats().snapshot();
+    th.tassert();
+    th.tassert(s.probe_lengths[1] - before.probe_lengths[1] < 25, true, "Few lookups stop at the first place");
+    th.tassert((double)(s.probe_total - before.probe_total) / 100 > 2, true, "Lookups are long");
+    for(int i = 0; i < 100; i += 2) {
+      m.erase(i);
+    }
+    th.tassert(m.stats().snapshot().tombstones, tombstones_of(m), "Tombstones are reported");
+  }
+
+  {
+    Map m;
+    m[1] = 1;
+    m.contains(1);
+    th.message("Copies keep the statistics, assignment keeps its own");
+    Map copy(m);
+    Map assigned;
+    assigned = m;
+    th.tassert();
+    th.tassert(copy.stats().snapshot().lookups, m.stats().snapshot().lookups, "Copy counted the same lookups");
+    th.tassert(assigned.stats().snapshot().lookups, (std::uint64_t)0, "Assigned map counted none");
+    th.tassert(assigned.stats().snapshot().size, (std::size_t)1, "Assigned map reports its new size");
+  }
+
+  {
+    Map m;
+    th.message("Snapshots can be taken from another thread");
+    std::atomic<bool> done(false);
+    bool monotonic = true;
+    std::thread metrics([&] {
+      std::uint64_t last = 0;
+      while(!done.load()) {
+        const auto s = m.stats().snapshot();
+        monotonic = monotonic && s.lookups >= last;
+        last = s.lookups;
+      }
+    });
+    for(int i = 0; i < 50000; ++i) {
+      m[i] = i;
+      m.contains(i / 2);
+    }
+    done = true;
+    metrics.join();
+    th.tassert();
+    th.tassert(monotonic, true, "Lookup count never went down");
+    th.tassert(m.stats().snapshot().size, (std::size_t)50000, "Final size is reported");
+  }
+}
+
+template<template<typename...> class ConcreteMap>
+void test_find_batch(TestHelper& th) {
+  ConcreteMap<int, int> m;
+  for(int i = 0; i < 1000; ++i) {
+    m[i * 3] = i;
+  }
+
+  {
+    th.message("find_batch on batches of every size around a group");
+    bool same = true;
+    std::vector<const int*> out;
+    for(int n : {0, 1, 15, 16, 17, 100, 2000}) {
+      std::vector<int> keys;
+      for(int i = 0; i < n; ++i) {
+        keys.push_back(i * 7 % 3000);
+      }
+      static_cast<const ConcreteMap<int, int>&>(m).find_batch(keys, out);
+      same = same && out.size() == keys.size();
+      for(std::size_t i = 0; i < keys.size() && same; ++i) {
+        same = out[i] == static_cast<const ConcreteMap<int, int>&>(m).find(keys[i]);
+      }
+    }
+    th.tassert();
+    th.tassert(same, true, "Every result is what find() returns");
+  }
+
+  {
+    th.message("find_batch on a non-const map");
+    std::vector<int> keys = {3, 4, 2997, 3000};
+    std::vector<int*> out;
+    m.find_batch(keys, out);
+    th.tassert();
+    th.tassert(out[1] == nullptr && out[3] == nullptr, true, "Missing keys are nullptr");
+    *out[0] = 100;
+    *out[2] = 200;
+    th.tassert(m.at(3) + m.at(2997), 300, "Values can be modified through the results");
+  }
+
+  {
+    ConcreteMap<int, int> g;
+    th.message("find_batch while the table grows");
+    std::vector<int> keys;
+    std::vector<int*> out;
+    bool found = true;
+    for(int i = 0; i < 5000; ++i) {
+      g[i] = i;
+      keys.push_back(i);
+      if(i % 97 == 0) {
+        g.find_batch(keys, out);
+        for(int k = 0; k <= i; ++k) {
+          found = found && out[k] != nullptr && *out[k] == k;
+        }
+      }
+    }
+    th.tassert();
+    th.tassert(found, true, "Every inserted key is found");
+  }
+}
+
 int main(int argc, char const *argv[]) {
   TestHelper th;
   std::srand((unsigned int)std::time(0));
@@ -238,6 +846,24 @@ int main(int argc, char const *argv[]) {
   std::cout << "\n[[ Chained Unordered Map (string, string) ]]" << std::endl << std::endl;
   test_unordered_map<std::string, std::string, ChainedUnorderedMap>(th, stringGen, stringGen);
 
+  std::cout << "\n[[ Chained Unordered Map lookup API ]]" << std::endl << std::endl;
+  test_lookup_api<ChainedUnorderedMap>(th);
+
+  std::cout << "\n[[ Chained Unordered Map bulk build ]]" << std::endl << std::endl;
+  test_bulk_build<ChainedUnorderedMap>(th);
+
+  std::cout << "\n[[ Chained Unordered Map chains ]]" << std::endl << std::endl;
+  test_chains(th);
+
+  std::cout << "\n[[ Chained Unordered Map incremental rehash ]]" << std::endl << std::endl;
+  test_incremental_rehash(th);
+
+  std::cout << "\n[[ Chained Unordered Map statistics ]]" << std::endl << std::endl;
+  test_stats<ChainedUnorderedMap>(th);
+
+  std::cout << "\n[[ Chained Unordered Map batched lookups ]]" << std::endl << std::endl;
+  test_find_batch<ChainedUnorderedMap>(th);
+
   std::cout << "\n[[ OpenAddress Unordered Map (int, int) ]]" << std::endl << std::endl;
   test_unordered_map<int, int, OpenAddressUnorderedMap>(th, intGen, intGen);
 
@@ -247,6 +873,57 @@ int main(int argc, char const *argv[]) {
   std::cout << "\n[[ OpenAddress Unordered Map (string, string) ]]" << std::endl << std::endl;
   test_unordered_map<std::string, std::string, OpenAddressUnorderedMap>(th, stringGen, stringGen);
 
+  std::cout << "\n[[ OpenAddress Unordered Map lookup API ]]" << std::endl << std::endl;
+  test_lookup_api<OpenAddressUnorderedMap>(th);
+
+  std::cout << "\n[[ OpenAddress Unordered Map bulk build ]]" << std::endl << std::endl;
+  test_bulk_build<OpenAddressUnorderedMap>(th);
+
+  std::cout << "\n[[ OpenAddress Unordered Map probing ]]" << std::endl << std::endl;
+  test_open_address_probing(th);
+
+  std::cout << "\n[[ OpenAddress Unordered Map statistics ]]" << std::endl << std::endl;
+  test_stats<OpenAddressUnorderedMap>(th);
+
+  std::cout << "\n[[ OpenAddress Unordered Map batched lookups ]]" << std::endl << std::endl;
+  test_find_batch<OpenAddressUnorderedMap>(th);
+
+  std::cout << "\n[[ Robin Hood Unordered Map (int, int) ]]" << std::endl << std::endl;
+  test_unordered_map<int, int, RobinHoodUnorderedMap>(th, intGen, intGen);
+
+  std::cout << "\n[[ Robin Hood Unordered Map (string, int) ]]" << std::endl << std::endl;
+  test_unordered_map<std::string, int, RobinHoodUnorderedMap>(th, stringGen, intGen);
+
+  std::cout << "\n[[ Robin Hood Unordered Map (string, string) ]]" << std::endl << std::endl;
+  test_unordered_map<std::string, std::string, RobinHoodUnorderedMap>(th, stringGen, stringGen);
+
+  std::cout << "\n[[ Robin Hood Unordered Map lookup API ]]" << std::endl << std::endl;
+  test_lookup_api<RobinHoodUnorderedMap>(th);
+
+  std::cout << "\n[[ Robin Hood Unordered Map bulk build ]]" << std::endl << std::endl;
+  test_bulk_build<RobinHoodUnorderedMap>(th);
+
+  std::cout << "\n[[ Robin Hood Unordered Map probing ]]" << std::endl << std::endl;
+  test_robin_hood(th);
+
+  std::cout << "\n[[ Cuckoo Unordered Map (int, int) ]]" << std::endl << std::endl;
+  test_unordered_map<int, int, CuckooUnorderedMap>(th, intGen, intGen);
+
+  std::cout << "\n[[ Cuckoo Unordered Map (string, int) ]]" << std::endl << std::endl;
+  test_unordered_map<std::string, int, CuckooUnorderedMap>(th, stringGen, intGen);
+
+  std::cout << "\n[[ Cuckoo Unordered Map (string, string) ]]" << std::endl << std::endl;
+  test_unordered_map<std::string, std::string, CuckooUnorderedMap>(th, stringGen, stringGen);
+
+  std::cout << "\n[[ Cuckoo Unordered Map lookup API ]]" << std::endl << std::endl;
+  test_lookup_api<CuckooUnorderedMap>(th);
+
+  std::cout << "\n[[ Cuckoo Unordered Map bulk build ]]" << std::endl << std::endl;
+  test_bulk_build<CuckooUnorderedMap>(th);
+
+  std::cout << "\n[[ Cuckoo Unordered Map buckets ]]" << std::endl << std::endl;
+  test_cuckoo(th);
+
   th.summary();
   return 0;
 }
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+#include "vector.h"
+#include "mmap_vector.h"
+#include "../bench_helpers.h"
+
+struct Record {
+  std::uint64_t id;
+  double values[7];
+};
+
+// what a restart costs when the records are deserialized into a Vector
+void load_stream(const std::string& path) {
+  Vector<Record> v;
+  std::FILE* f = std::fopen(path.c_str(), "rb");
+  Record r;
+  while(std::fread(&r, sizeof(r), 1, f) == 1) {
+    v.push_back(r);
+  }
+  std::fclose(f);
+  bench_keep(v.back().id);
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 21;
+  const std::string stream_path = "/tmp/mmap_vector_bench_" + std::to_string(::getpid()) + ".bin";
+  const std::string mmap_path = "/tmp/mmap_vector_bench_" + std::to_string(::getpid()) + ".mmap";
+
+  {
+    std::FILE* f = std::fopen(stream_path.c_str(), "wb");
+    MmapVector<Record> m(mmap_path);
+    m.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+      Record r = {i, {0}};
+      std::fwrite(&r, sizeof(r), 1, f);
+      m.push_back(r);
+    }
+    std::fclose(f);
+  }
+
+  std::cout << "\n[[ reload of " << n << " 64-byte records (warm page cache) ]]" << std::endl << std::endl;
+  bh.run("fread into Vector (before)", [&] { load_stream(stream_path); });
+  bh.run("MmapVector open read-only (after)", [&] {
+    const MmapVector<Record> m(mmap_path, MmapMode::read_only);
+    bench_keep(m.back().id);
+  });
+  bh.run("MmapVector open and scan", [&] {
+    const MmapVector<Record> m(mmap_path, MmapMode::read_only);
+    std::uint64_t sum = 0;
+    for(const Record& r : m) {
+      sum += r.id;
+    }
+    bench_keep(sum);
+  });
+
+  std::remove(stream_path.c_str());
+  std::remove(mmap_path.c_str());
+  return 0;
+}
@@ -0,0 +1,545 @@
+#ifndef __STRUCTURES_MMAP_VECTOR__
+#define __STRUCTURES_MMAP_VECTOR__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "simd.h"
+#include "vector.h"
+
+// Vector of fixed-size records whose storage is a file mapped in memory.
+// The file is a small header (magic, record size, number of elements)
+// followed by the raw records, so reopening it is just an mmap: there is
+// nothing to deserialize and every process mapping the same file shares
+// its pages through the page cache.
+// Growing extends the file with ftruncate and maps it again, which (like
+// a Vector reallocation) invalidates pointers, references and iterators.
+// The default policy never gives disk space back on removals; call
+// shrink_to_fit() or pass a shrinking Growth policy.
+// Changes reach the file through the shared mapping; sync() additionally
+// waits until they are on disk.
+// A read_only vector is mapped without write permission: every member
+// that modifies it or hands out a non-const reference or pointer to its
+// records throws std::logic_error, read it through a const reference
+
+enum class MmapMode { read_write, read_only };
+
+template<typename T, class Growth = NeverShrinkGrowth>
+class MmapVector {
+  static_assert(std::is_trivially_copyable<T>::value, "MmapVector needs trivially copyable records");
+  static_assert(alignof(T) <= 64, "Records are stored 64 bytes into a page-aligned mapping");
+
+public:
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  // opens path, creating an empty vector if it does not exist yet (only in
+  // read_write mode); throws std::system_error if the file cannot be
+  // opened or mapped and std::runtime_error if it does not hold T records
+  explicit MmapVector(const std::string& path, MmapMode mode = MmapMode::read_write); // O(1)
+  MmapVector(MmapVector&& rvr); // O(1)
+  MmapVector& operator=(MmapVector&& rvr); // O(1)
+  MmapVector(const MmapVector&) = delete;
+  MmapVector& operator=(const MmapVector&) = delete;
+  virtual ~MmapVector(); // O(1)
+
+  std::size_t capacity() const; // O(1)
+  std::size_t reserve(std::size_t new_capacity); // O(1)
+  std::size_t shrink_to_fit(); // O(1)
+
+  std::size_t size() const; // O(1)
+  std::size_t resize(std::size_t new_size); // O(new_size)
+  bool empty() const; // O(1)
+  bool read_only() const; // O(1)
+
+  T& at(std::size_t i); // O(1)
+  const T& at(std::size_t i) const; // O(1)
+  T& operator[](std::size_t i); // O(1)
+  const T& operator[](std::size_t i) const; // O(1)
+  T& back(); // O(1)
+  const T& back() const; // O(1)
+  T* data(); // O(1)
+  const T* data() const; // O(1)
+
+  iterator begin(); // O(1)
+  iterator end(); // O(1)
+  const_iterator begin() const; // O(1)
+  const_iterator end() const; // O(1)
+  const_iterator cbegin() const; // O(1)
+  const_iterator cend() const; // O(1)
+  std::size_t find(const T& e) const; // O(n)
+  std::size_t count(const T& e) const; // O(n)
+  bool contains(const T& e) const; // O(n)
+
+  void push_back(const T& e); // worst case O(n), amortized O(1)
+  void insert(std::size_t i, const T& e); // worst case O(n), amortized O(1)
+  template<typename... Args>
+  T& emplace_back(Args&&... args); // worst case O(n), amortized O(1)
+  T pop_back(); // O(1)
+  T erase(std::size_t i); // O(n)
+  std::size_t erase(std::size_t first, std::size_t last); // O(n)
+  template<class Pred>
+  std::size_t erase_if(Pred pred); // O(n)
+  T swap_erase(std::size_t i); // O(1)
+  void clear(); // O(1)
+
+  void sync(); // O(n)
+  std::vector<T> to_std_vector() const; // O(n)
+
+private:
+  struct _Header {
+    std::uint64_t magic;
+    std::uint64_t record_size;
+    std::uint64_t size;
+  };
+
+  static const std::uint64_t _magic = 0x31434556504d4d43ULL; // "CMMPVEC1"
+  static const std::size_t _header_bytes = 64;
+
+  _Header* _header() const;
+  T* _arr() const;
+  void _map(std::size_t capacity);
+  void _unmap();
+  void _reallocate(std::size_t new_capacity);
+  void _set_size(std::size_t new_size);
+  void _truncate(std::size_t new_size);
+  void _close();
+  void _check_writable() const;
+
+private:
+  int _fd;
+  bool _read_only;
+  char* _base;
+  std::size_t _size;
+  std::size_t _capacity;
+};
+
+template<typename T, class Growth>
+MmapVector<T,Growth>::MmapVector(const std::string& path, MmapMode mode) :
+_fd(-1), _read_only(mode == MmapMode::read_only), _base(nullptr), _size(0), _capacity(0) {
+  _fd = _read_only ? ::open(path.c_str(), O_RDONLY) : ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if(_fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+  }
+
+  struct stat st;
+  if(::fstat(_fd, &st) != 0) {
+    int err = errno;
+    _close();
+    throw std::system_error(err, std::generic_category(), "cannot stat " + path);
+  }
+
+  const std::size_t file_bytes = (std::size_t)st.st_size;
+  if(file_bytes == 0 && !_read_only) {
+    // brand new file: write an empty header
+    if(::ftruncate(_fd, _header_bytes) != 0) {
+      int err = errno;
+      _close();
+      throw std::system_error(err, std::generic_category(), "cannot extend " + path);
+    }
+    _map(0);
+    _Header* h = _header();
+    h->magic = _magic;
+    h->record_size = sizeof(T);
+    h->size = 0;
+    return;
+  }
+
+  if(file_bytes < _header_bytes || (file_bytes - _header_bytes) % sizeof(T) != 0) {
+    _close();
+    throw std::runtime_error(path + " is not an MmapVector file of this record type");
+  }
+  _map((file_bytes - _header_bytes) / sizeof(T));
+  const _Header* h = _header();
+  if(h->magic != _magic || h->record_size != sizeof(T) || h->size > _capacity) {
+    _close();
+    throw std::runtime_error(path + " is not an MmapVector file of this record type");
+  }
+  _size = h->size;
+}
+
+template<typename T, class Growth>
+MmapVector<T,Growth>::MmapVector(MmapVector&& rvr) :
+_fd(rvr._fd), _read_only(rvr._read_only), _base(rvr._base), _size(rvr._size), _capacity(rvr._capacity) {
+  rvr._fd = -1;
+  rvr._base = nullptr;
+  rvr._size = 0;
+  rvr._capacity = 0;
+}
+
+template<typename T, class Growth>
+MmapVector<T,Growth>& MmapVector<T,Growth>::operator=(MmapVector&& rvr) {
+  if(this != &rvr) {
+    _close();
+    std::swap(_fd, rvr._fd);
+    std::swap(_read_only, rvr._read_only);
+    std::swap(_base, rvr._base);
+    std::swap(_size, rvr._size);
+    std::swap(_capacity, rvr._capacity);
+  }
+  return *this;
+}
+
+template<typename T, class Growth>
+MmapVector<T,Growth>::~MmapVector() {
+  _close();
+}
+
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::capacity() const {
+  return _capacity;
+}
+
+// the file grows to hold new_capacity records; never below size()
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::reserve(std::size_t new_capacity) {
+  _check_writable();
+  if(new_capacity < size()) {
+    return capacity();
+  }
+
+  _reallocate(new_capacity);
+  return capacity();
+}
+
+// truncates the file right after the last record
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::shrink_to_fit() {
+  _check_writable();
+  if(capacity() != size()) {
+    _reallocate(size());
+  }
+  return capacity();
+}
+
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::size() const {
+  return _size;
+}
+
+// size = capacity = new_size, new records are value-initialized
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::resize(std::size_t new_size) {
+  _check_writable();
+  const std::size_t old_size = std::min(size(), new_size);
+  _set_size(old_size);
+  _reallocate(new_size);
+  std::fill(_arr() + old_size, _arr() + new_size, T());
+  _set_size(new_size);
+  return capacity();
+}
+
+template<typename T, class Growth>
+bool MmapVector<T,Growth>::empty() const {
+  return size() == 0;
+}
+
+template<typename T, class Growth>
+bool MmapVector<T,Growth>::read_only() const {
+  return _read_only;
+}
+
+template<typename T, class Growth>
+T& MmapVector<T,Growth>::at(std::size_t i) {
+  _check_writable();
+  return _arr()[i];
+}
+
+template<typename T, class Growth>
+const T& MmapVector<T,Growth>::at(std::size_t i) const {
+  return _arr()[i];
+}
+
+template<typename T, class Growth>
+T& MmapVector<T,Growth>::operator[](std::size_t i) {
+  _check_writable();
+  return _arr()[i];
+}
+
+template<typename T, class Growth>
+const T& MmapVector<T,Growth>::operator[](std::size_t i) const {
+  return _arr()[i];
+}
+
+template<typename T, class Growth>
+T& MmapVector<T,Growth>::back() {
+  _check_writable();
+  return _arr()[size() - 1];
+}
+
+template<typename T, class Growth>
+const T& MmapVector<T,Growth>::back() const {
+  return _arr()[size() - 1];
+}
+
+template<typename T, class Growth>
+T* MmapVector<T,Growth>::data() {
+  _check_writable();
+  return _arr();
+}
+
+template<typename T, class Growth>
+const T* MmapVector<T,Growth>::data() const {
+  return _arr();
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::iterator MmapVector<T,Growth>::begin() {
+  _check_writable();
+  return _arr();
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::iterator MmapVector<T,Growth>::end() {
+  _check_writable();
+  return _arr() + size();
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::const_iterator MmapVector<T,Growth>::begin() const {
+  return _arr();
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::const_iterator MmapVector<T,Growth>::end() const {
+  return _arr() + size();
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::const_iterator MmapVector<T,Growth>::cbegin() const {
+  return begin();
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::const_iterator MmapVector<T,Growth>::cend() const {
+  return end();
+}
+
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::find(const T& e) const {
+  return simd_find(_arr(), size(), e);
+}
+
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::count(const T& e) const {
+  return simd_count(_arr(), size(), e);
+}
+
+template<typename T, class Growth>
+bool MmapVector<T,Growth>::contains(const T& e) const {
+  return find(e) != size();
+}
+
+template<typename T, class Growth>
+void MmapVector<T,Growth>::push_back(const T& e) {
+  emplace_back(e);
+}
+
+template<typename T, class Growth>
+void MmapVector<T,Growth>::insert(std::size_t i, const T& e) {
+  _check_writable();
+  assert(i <= size());
+  // copy first, e may live in the mapping that is about to move
+  T tmp = e;
+  if(size() >= capacity()) {
+    _reallocate(Growth::grow(capacity()));
+  }
+  std::memmove(_arr() + i + 1, _arr() + i, (size() - i) * sizeof(T));
+  _arr()[i] = tmp;
+  _set_size(size() + 1);
+}
+
+template<typename T, class Growth>
+template<typename... Args>
+T& MmapVector<T,Growth>::emplace_back(Args&&... args) {
+  _check_writable();
+  T tmp(std::forward<Args>(args)...);
+  if(size() >= capacity()) {
+    _reallocate(Growth::grow(capacity()));
+  }
+  _arr()[size()] = tmp;
+  _set_size(size() + 1);
+  return back();
+}
+
+template<typename T, class Growth>
+T MmapVector<T,Growth>::pop_back() {
+  return erase(size() - 1);
+}
+
+template<typename T, class Growth>
+T MmapVector<T,Growth>::erase(std::size_t i) {
+  _check_writable();
+  assert(i < size());
+  T ret = _arr()[i];
+  std::memmove(_arr() + i, _arr() + i + 1, (size() - i - 1) * sizeof(T));
+  _truncate(size() - 1);
+  return ret;
+}
+
+template<typename T, class Growth>
+std::size_t MmapVector<T,Growth>::erase(std::size_t first, std::size_t last) {
+  _check_writable();
+  assert(first <= last && last <= size());
+  std::memmove(_arr() + first, _arr() + last, (size() - last) * sizeof(T));
+  _truncate(size() - (last - first));
+  return last - first;
+}
+
+template<typename T, class Growth>
+template<class Pred>
+std::size_t MmapVector<T,Growth>::erase_if(Pred pred) {
+  _check_writable();
+  T* new_end = std::remove_if(_arr(), _arr() + size(), pred);
+  const std::size_t removed = (_arr() + size()) - new_end;
+  _truncate(new_end - _arr());
+  return removed;
+}
+
+template<typename T, class Growth>
+T MmapVector<T,Growth>::swap_erase(std::size_t i) {
+  _check_writable();
+  assert(i < size());
+  T ret = _arr()[i];
+  _arr()[i] = back();
+  _truncate(size() - 1);
+  return ret;
+}
+
+template<typename T, class Growth>
+void MmapVector<T,Growth>::clear() {
+  _check_writable();
+  _truncate(0);
+}
+
+// blocks until the records and the header are written to disk
+template<typename T, class Growth>
+void MmapVector<T,Growth>::sync() {
+  if(_base != nullptr && !_read_only &&
+     ::msync(_base, _header_bytes + capacity() * sizeof(T), MS_SYNC) != 0) {
+    throw std::system_error(errno, std::generic_category(), "msync");
+  }
+}
+
+template<typename T, class Growth>
+std::vector<T> MmapVector<T,Growth>::to_std_vector() const {
+  return std::vector<T>(_arr(), _arr() + size());
+}
+
+template<typename T, class Growth>
+typename MmapVector<T,Growth>::_Header* MmapVector<T,Growth>::_header() const {
+  return reinterpret_cast<_Header*>(_base);
+}
+
+template<typename T, class Growth>
+T* MmapVector<T,Growth>::_arr() const {
+  return reinterpret_cast<T*>(_base + _header_bytes);
+}
+
+// maps the header and capacity records of the (already sized) file
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_map(std::size_t capacity) {
+  const int prot = _read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+  void* p = ::mmap(nullptr, _header_bytes + capacity * sizeof(T), prot, MAP_SHARED, _fd, 0);
+  if(p == MAP_FAILED) {
+    int err = errno;
+    _close();
+    throw std::system_error(err, std::generic_category(), "mmap");
+  }
+  _base = static_cast<char*>(p);
+  _capacity = capacity;
+}
+
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_unmap() {
+  if(_base != nullptr) {
+    ::munmap(_base, _header_bytes + capacity() * sizeof(T));
+    _base = nullptr;
+  }
+}
+
+// resizes the file and maps it again; the records stay in the page cache,
+// so nothing is copied
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_reallocate(std::size_t new_capacity) {
+  assert(!_read_only);
+  assert(new_capacity >= size());
+  if(new_capacity == capacity()) {
+    return;
+  }
+  _unmap();
+  if(::ftruncate(_fd, _header_bytes + new_capacity * sizeof(T)) != 0) {
+    int err = errno;
+    // the file keeps its old length, so the old mapping can be restored
+    _map(_capacity);
+    throw std::system_error(err, std::generic_category(), "ftruncate");
+  }
+  _map(new_capacity);
+}
+
+// the header is updated together with the in-memory size so the file
+// always describes its own contents
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_set_size(std::size_t new_size) {
+  assert(!_read_only);
+  _size = new_size;
+  _header()->size = new_size;
+}
+
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_truncate(std::size_t new_size) {
+  assert(new_size <= size());
+  _set_size(new_size);
+
+  std::size_t new_capacity = capacity();
+  for(std::size_t next = Growth::shrink(size(), new_capacity);
+      next != new_capacity;
+      next = Growth::shrink(size(), new_capacity)) {
+    new_capacity = next;
+  }
+  if(new_capacity != capacity()) {
+    reserve(new_capacity);
+  }
+}
+
+// the mapping of a read_only vector has no write permission, writing
+// through it would crash the process
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_check_writable() const {
+  if(_read_only) {
+    throw std::logic_error("MmapVector is read-only");
+  }
+}
+
+template<typename T, class Growth>
+void MmapVector<T,Growth>::_close() {
+  _unmap();
+  if(_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+  _size = 0;
+  _capacity = 0;
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <unistd.h>
+#include "mmap_vector.h"
+#include "../test_helpers.h"
+
+struct Record {
+  std::uint32_t id;
+  float score;
+  char tag[8];
+};
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+  const std::string path = "/tmp/mmap_vector_test_" + std::to_string(::getpid());
+  std::remove(path.c_str());
+
+  {
+    th.message("Create a new file");
+    MmapVector<Record> v(path);
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)0, "Size is 0");
+    th.tassert(v.read_only(), false, "Vector is writable");
+
+    th.message("Push 1000 records");
+    for(std::uint32_t i = 0; i < 1000; ++i) {
+      Record r = {i, i * 0.5f, "rec"};
+      v.push_back(r);
+    }
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)1000, "Size is 1000");
+    th.tassert(v.capacity(), (std::size_t)1024, "Capacity is 1024");
+    th.tassert(v[999].id, (std::uint32_t)999, "v[999].id == 999");
+    th.tassert(v.back().score, 499.5f, "v.back().score == 499.5");
+
+    th.message("Erase the odd records");
+    std::size_t removed = v.erase_if([](const Record& r) { return r.id % 2 == 1; });
+    th.tassert();
+    th.tassert(removed, (std::size_t)500, "500 records removed");
+    th.tassert(v[1].id, (std::uint32_t)2, "v[1].id == 2");
+    th.tassert(v.capacity(), (std::size_t)1024, "Capacity is kept by default");
+    v.sync();
+  }
+  th.tassert();
+
+  {
+    th.message("Reopen read-write");
+    MmapVector<Record> v(path);
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)500, "Size is 500");
+    th.tassert(v[250].id, (std::uint32_t)500, "v[250].id == 500");
+    th.tassert(std::string(v[250].tag), std::string("rec"), "Tag survived");
+
+    th.message("Insert, erase and shrink_to_fit");
+    Record r = {7, 7.0f, "seven"};
+    v.insert(0, r);
+    v.insert(0, v[0]);
+    th.tassert();
+    th.tassert(v[0].id == 7 && v[1].id == 7 && v[2].id == 0, true, "Inserted at the front");
+    th.tassert(v.erase(0).id, (std::uint32_t)7, "Erased record is 7");
+    th.tassert(v.swap_erase(0).id, (std::uint32_t)7, "Swap-erased record is 7");
+    th.tassert(v[0].id, (std::uint32_t)998, "Last record moved to the front");
+    th.tassert(v.size(), (std::size_t)500, "Size is 500");
+    th.tassert(v.shrink_to_fit(), (std::size_t)500, "Capacity is 500");
+  }
+
+  {
+    th.message("Reopen read-only");
+    const MmapVector<Record> v(path, MmapMode::read_only);
+    th.tassert();
+    th.tassert(v.read_only(), true, "Vector is read-only");
+    th.tassert(v.size(), (std::size_t)500, "Size is 500");
+    th.tassert(v.capacity(), (std::size_t)500, "Capacity is 500");
+    th.tassert(v[0].id, (std::uint32_t)998, "v[0].id == 998");
+
+    th.message("Two read-only views of the same file");
+    MmapVector<Record> w(path, MmapMode::read_only);
+    th.tassert();
+    th.tassert(std::equal(v.begin(), v.end(), w.cbegin(),
+      [](const Record& a, const Record& b) { return a.id == b.id; }), true, "Same records");
+
+    th.message("Move construction");
+    MmapVector<Record> m(std::move(w));
+    th.tassert();
+    th.tassert(m.size(), (std::size_t)500, "Moved-to size is 500");
+    th.tassert(w.size(), (std::size_t)0, "Moved-from size is 0");
+  }
+
+  {
+    th.message("Opening with another record type");
+    bool threw = false;
+    try {
+      MmapVector<std::uint64_t> v(path);
+    } catch(const std::runtime_error&) {
+      threw = true;
+    }
+    th.tassert(threw, true, "Throws std::runtime_error");
+
+    th.message("Opening a missing file read-only");
+    threw = false;
+    try {
+      MmapVector<Record> v(path + ".missing", MmapMode::read_only);
+    } catch(const std::system_error&) {
+      threw = true;
+    }
+    th.tassert(threw, true, "Throws std::system_error");
+  }
+  std::remove(path.c_str());
+
+  {
+    const std::string ro_path = path + ".ro";
+    {
+      MmapVector<int, DoublingGrowth> w(ro_path);
+      for(int i = 0; i < 10; ++i) {
+        w.push_back(i);
+      }
+    }
+    th.message("Modifying a read-only vector throws");
+    MmapVector<int, DoublingGrowth> v(ro_path, MmapMode::read_only);
+    std::size_t thrown = 0;
+    const auto expect_throw = [&thrown](std::function<void()> f) {
+      try {
+        f();
+      } catch(const std::logic_error&) {
+        thrown++;
+      }
+    };
+    expect_throw([&] { v.push_back(1); });
+    expect_throw([&] { v.insert(0, 1); });
+    expect_throw([&] { v.emplace_back(1); });
+    expect_throw([&] { v.pop_back(); });
+    expect_throw([&] { v.erase(0); });
+    expect_throw([&] { v.erase(0, 2); });
+    expect_throw([&] { v.erase_if([](int x) { return x > 5; }); });
+    expect_throw([&] { v.swap_erase(0); });
+    expect_throw([&] { v.clear(); });
+    expect_throw([&] { v.resize(20); });
+    expect_throw([&] { v.reserve(100); });
+    expect_throw([&] { v.shrink_to_fit(); });
+    th.tassert();
+    th.tassert(thrown, (std::size_t)12, "Every modification throws std::logic_error");
+
+    th.message("No writable reference to a read-only vector");
+    thrown = 0;
+    expect_throw([&] { v[0] = 5; });
+    expect_throw([&] { v.at(0) = 5; });
+    expect_throw([&] { v.back() = 5; });
+    expect_throw([&] { *v.data() = 5; });
+    expect_throw([&] { *v.begin() = 5; });
+    expect_throw([&] { v.end(); });
+    th.tassert();
+    th.tassert(thrown, (std::size_t)6, "Non-const accessors throw std::logic_error");
+    const auto& cv = v;
+    th.tassert(cv.size(), (std::size_t)10, "Size is still 10");
+    th.tassert(cv[0] + cv.back(), 9, "Records are unchanged and readable through a const reference");
+    std::remove(ro_path.c_str());
+  }
+
+  std::srand((unsigned int)std::time(0));
+  {
+    MmapVector<int, DoublingGrowth> v(path);
+    std::vector<int> stdv;
+
+    th.message("Stress test push");
+    for(int i = 0; i < 5000; ++i) {
+      int r = std::rand();
+      v.push_back(r);
+      stdv.push_back(r);
+    }
+    th.tassert();
+    th.tassert(v.to_std_vector() == stdv, true, "Check complete vector");
+    th.tassert(v.contains(stdv[1234]), true, "Contains a pushed element");
+
+    th.message("Stress test delete by index");
+    for(int i = 0; i < 4000; ++i) {
+      unsigned int idx = std::rand() % v.size();
+      v.erase(idx);
+      stdv.erase(stdv.begin() + idx);
+    }
+    th.tassert();
+    th.tassert(v.to_std_vector() == stdv, true, "Check complete vector");
+    th.tassert(v.capacity() < 4096, true, "Shrinking policy gave space back");
+
+    th.message("resize and clear");
+    v.resize(3000);
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)3000, "Size is 3000");
+    th.tassert(v[2999], 0, "New elements are zero");
+    v.clear();
+    th.tassert(v.empty(), true, "Vector is empty");
+  }
+  std::remove(path.c_str());
+
+  th.summary();
+  return 0;
+}
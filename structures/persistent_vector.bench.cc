@@ -0,0 +1,81 @@
+#include <iostream>
+#include <cstddef>
+#include "vector.h"
+#include "persistent_vector.h"
+#include "../bench_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 20;
+  const std::size_t snapshots = 100;
+
+  Vector<int> vec;
+  PersistentVector<int> pv;
+  {
+    auto t = pv.transient();
+    for(std::size_t i = 0; i < n; ++i) {
+      vec.push_back((int)i);
+      t.push_back((int)i);
+    }
+    pv = t.persistent();
+  }
+
+  std::cout << "\n[[ " << snapshots << " snapshots of " << n << " ints, one write between each ]]" << std::endl << std::endl;
+  bh.run("Vector copy (before)", [&] {
+    for(std::size_t s = 0; s < snapshots; ++s) {
+      Vector<int> snapshot(vec);
+      vec[s] = (int)s;
+      bench_keep(snapshot[0]);
+    }
+  });
+  bh.run("PersistentVector copy (after)", [&] {
+    for(std::size_t s = 0; s < snapshots; ++s) {
+      PersistentVector<int> snapshot(pv);
+      pv.set(s, (int)s);
+      bench_keep(snapshot[0]);
+    }
+  });
+
+  std::cout << "\n[[ building " << n << " ints ]]" << std::endl << std::endl;
+  bh.run("Vector push_back", [=] {
+    Vector<int> v;
+    for(std::size_t i = 0; i < n; ++i) {
+      v.push_back((int)i);
+    }
+    bench_keep(v.size());
+  });
+  bh.run("PersistentVector push_back", [=] {
+    PersistentVector<int> v;
+    for(std::size_t i = 0; i < n; ++i) {
+      v.push_back((int)i);
+    }
+    bench_keep(v.size());
+  });
+  bh.run("PersistentVector transient push_back", [=] {
+    PersistentVector<int> v;
+    auto t = v.transient();
+    for(std::size_t i = 0; i < n; ++i) {
+      t.push_back((int)i);
+    }
+    v = t.persistent();
+    bench_keep(v.size());
+  });
+
+  std::cout << "\n[[ " << n << " random reads ]]" << std::endl << std::endl;
+  bh.run("Vector operator[]", [&] {
+    long long sum = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      sum += vec[(i * 2654435761u) % n];
+    }
+    bench_keep(sum);
+  });
+  bh.run("PersistentVector operator[]", [&] {
+    long long sum = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      sum += pv[(i * 2654435761u) % n];
+    }
+    bench_keep(sum);
+  });
+
+  return 0;
+}
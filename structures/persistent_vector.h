@@ -0,0 +1,441 @@
+#ifndef __STRUCTURES_PERSISTENT_VECTOR__
+#define __STRUCTURES_PERSISTENT_VECTOR__
+
+#include <cstddef>
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <initializer_list>
+#include <vector>
+
+// Persistent vector: a 32-way trie of shared nodes plus a tail leaf
+// (the radix trie of Clojure's vectors, without the relaxed balancing).
+// Copying one is O(1) and yields an independent snapshot: updates copy
+// only the O(log32 n) nodes on the path they touch and share the rest,
+// so older copies never see them.
+//   copy (snapshot)        O(1)
+//   operator[], set        O(log32 n)
+//   push_back, pop_back    O(1) amortized (tail), O(log32 n) worst case
+// Nodes are never mutated once shared, so snapshots can be handed to
+// other threads and read there while the writer keeps updating its own
+// copy; taking the snapshot (copying the vector object) must happen in
+// the writer thread, or under the lock that guards the writer's object.
+// Batches of updates go through a Transient, which owns the nodes it
+// creates and updates them in place instead of copying paths again:
+//   auto t = v.transient();
+//   for(...) t.push_back(x);
+//   v = t.persistent();
+template<typename T>
+class PersistentVector {
+private:
+  struct _Node;
+  struct _Branch;
+  struct _Leaf;
+  typedef std::shared_ptr<_Node> _node_ptr;
+  typedef std::shared_ptr<_Leaf> _leaf_ptr;
+  // transients tag their nodes with a token that is true while they can
+  // still be modified in place
+  typedef std::shared_ptr<bool> _edit_type;
+
+public:
+  class Transient;
+
+  typedef T value_type;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+
+  PersistentVector(); // O(1)
+  PersistentVector(std::initializer_list<T> l); // O(n)
+  // copies are the snapshots and cost two atomic reference count
+  // increments; moves only hand the node pointers over, the moved-from
+  // vector is left empty (construction) or with the old contents of the
+  // target (assignment)
+  PersistentVector(const PersistentVector& v) = default; // O(1)
+  PersistentVector(PersistentVector&& v); // O(1)
+  PersistentVector& operator=(const PersistentVector& v) = default; // O(1)
+  PersistentVector& operator=(PersistentVector&& v); // O(1)
+
+  std::size_t size() const; // O(1)
+  bool empty() const; // O(1)
+
+  const T& at(std::size_t i) const; // O(log32 n)
+  const T& operator[](std::size_t i) const; // O(log32 n)
+  const T& back() const; // O(1)
+
+  void set(std::size_t i, const T& e); // O(log32 n)
+  void push_back(const T& e); // O(log32 n)
+  T pop_back(); // O(log32 n)
+
+  Transient transient() const; // O(1)
+  std::vector<T> to_std_vector() const; // O(n)
+
+private:
+  static const std::size_t _bits = 5;
+  static const std::size_t _width = std::size_t(1) << _bits;
+  static const std::size_t _mask = _width - 1;
+
+  std::size_t _tail_offset() const;
+  const _Leaf& _leaf_for(std::size_t i) const;
+  _node_ptr _trie_leaf(std::size_t i) const;
+
+  static bool _editable(const _node_ptr& n, const _edit_type& edit);
+  static std::shared_ptr<_Branch> _editable_branch(const _node_ptr& n, const _edit_type& edit);
+  static _leaf_ptr _editable_leaf(const _node_ptr& n, const _edit_type& edit);
+  static _node_ptr _new_path(std::size_t shift, const _node_ptr& n, const _edit_type& edit);
+  _node_ptr _push_tail(std::size_t shift, const _node_ptr& parent, const _node_ptr& tail, const _edit_type& edit) const;
+  _node_ptr _pop_tail(std::size_t shift, const _node_ptr& n, const _edit_type& edit) const;
+  static _node_ptr _assoc(std::size_t shift, const _node_ptr& n, std::size_t i, const T& e, const _edit_type& edit);
+
+  void _set(std::size_t i, const T& e, const _edit_type& edit);
+  void _push_back(const T& e, const _edit_type& edit);
+  T _pop_back(const _edit_type& edit);
+
+private:
+  // an empty vector holds no nodes at all, a null _root or _tail reads
+  // as an empty node
+  _node_ptr _root;
+  _leaf_ptr _tail;
+  std::size_t _size;
+  std::size_t _shift;
+};
+
+template<typename T>
+struct PersistentVector<T>::_Node {
+  explicit _Node(const _edit_type& e) : edit(e) { }
+  virtual ~_Node() = default;
+  _edit_type edit;
+};
+
+template<typename T>
+struct PersistentVector<T>::_Branch : public PersistentVector<T>::_Node {
+  explicit _Branch(const _edit_type& e) : _Node(e) { }
+  _node_ptr children[_width];
+};
+
+template<typename T>
+struct PersistentVector<T>::_Leaf : public PersistentVector<T>::_Node {
+  explicit _Leaf(const _edit_type& e) : _Node(e) {
+    values.reserve(_width);
+  }
+  std::vector<T> values;
+};
+
+// batch of in-place updates over a vector; the vector it came from is
+// not affected, persistent() hands the result back as a regular vector
+// and ends the batch (the transient must not be used afterwards)
+template<typename T>
+class PersistentVector<T>::Transient {
+public:
+  Transient(Transient&&) = default;
+  Transient(const Transient&) = delete;
+  Transient& operator=(const Transient&) = delete;
+
+  std::size_t size() const { return _v.size(); } // O(1)
+  const T& operator[](std::size_t i) const { return _v[i]; } // O(log32 n)
+
+  void set(std::size_t i, const T& e) { assert(*_edit); _v._set(i, e, _edit); } // O(log32 n)
+  void push_back(const T& e) { assert(*_edit); _v._push_back(e, _edit); } // amortized O(1)
+  T pop_back() { assert(*_edit); return _v._pop_back(_edit); } // amortized O(1)
+
+  PersistentVector persistent() { // O(1)
+    assert(*_edit);
+    *_edit = false;
+    return _v;
+  }
+
+private:
+  friend class PersistentVector<T>;
+  explicit Transient(const PersistentVector& v) : _v(v), _edit(std::make_shared<bool>(true)) { }
+
+  PersistentVector _v;
+  _edit_type _edit;
+};
+
+template<typename T>
+PersistentVector<T>::PersistentVector() : _root(nullptr), _tail(nullptr), _size(0), _shift(_bits) {
+}
+
+template<typename T>
+PersistentVector<T>::PersistentVector(PersistentVector&& v) :
+_root(std::move(v._root)), _tail(std::move(v._tail)), _size(v._size), _shift(v._shift) {
+  v._size = 0;
+  v._shift = _bits;
+}
+
+template<typename T>
+PersistentVector<T>& PersistentVector<T>::operator=(PersistentVector&& v) {
+  _root.swap(v._root);
+  _tail.swap(v._tail);
+  std::swap(_size, v._size);
+  std::swap(_shift, v._shift);
+  return *this;
+}
+
+template<typename T>
+PersistentVector<T>::PersistentVector(std::initializer_list<T> l) : PersistentVector() {
+  Transient t = transient();
+  for(const T& e : l) {
+    t.push_back(e);
+  }
+  *this = t.persistent();
+}
+
+template<typename T>
+std::size_t PersistentVector<T>::size() const {
+  return _size;
+}
+
+template<typename T>
+bool PersistentVector<T>::empty() const {
+  return size() == 0;
+}
+
+// index of the first element stored in the tail
+template<typename T>
+std::size_t PersistentVector<T>::_tail_offset() const {
+  return _size < _width ? 0 : ((_size - 1) >> _bits) << _bits;
+}
+
+template<typename T>
+const typename PersistentVector<T>::_Leaf& PersistentVector<T>::_leaf_for(std::size_t i) const {
+  assert(i < size());
+  if(i >= _tail_offset()) {
+    return *_tail;
+  }
+  const _Node* n = _root.get();
+  for(std::size_t level = _shift; level > 0; level -= _bits) {
+    n = static_cast<const _Branch*>(n)->children[(i >> level) & _mask].get();
+  }
+  return *static_cast<const _Leaf*>(n);
+}
+
+// the trie leaf holding i (which must not be in the tail)
+template<typename T>
+typename PersistentVector<T>::_node_ptr PersistentVector<T>::_trie_leaf(std::size_t i) const {
+  _node_ptr n = _root;
+  for(std::size_t level = _shift; level > 0; level -= _bits) {
+    n = static_cast<const _Branch&>(*n).children[(i >> level) & _mask];
+  }
+  return n;
+}
+
+template<typename T>
+const T& PersistentVector<T>::at(std::size_t i) const {
+  return _leaf_for(i).values[i & _mask];
+}
+
+template<typename T>
+const T& PersistentVector<T>::operator[](std::size_t i) const {
+  return at(i);
+}
+
+template<typename T>
+const T& PersistentVector<T>::back() const {
+  return _tail->values.back();
+}
+
+template<typename T>
+void PersistentVector<T>::set(std::size_t i, const T& e) {
+  _set(i, e, nullptr);
+}
+
+template<typename T>
+void PersistentVector<T>::push_back(const T& e) {
+  _push_back(e, nullptr);
+}
+
+template<typename T>
+T PersistentVector<T>::pop_back() {
+  return _pop_back(nullptr);
+}
+
+template<typename T>
+typename PersistentVector<T>::Transient PersistentVector<T>::transient() const {
+  return Transient(*this);
+}
+
+template<typename T>
+std::vector<T> PersistentVector<T>::to_std_vector() const {
+  std::vector<T> v;
+  v.reserve(size());
+  // one trie walk per leaf, not per element
+  for(std::size_t i = 0; i < size(); i += _width) {
+    const _Leaf& leaf = _leaf_for(i);
+    v.insert(v.end(), leaf.values.begin(), leaf.values.end());
+  }
+  return v;
+}
+
+// a node can be modified in place only by the live transient that made it
+template<typename T>
+bool PersistentVector<T>::_editable(const _node_ptr& n, const _edit_type& edit) {
+  return edit != nullptr && n != nullptr && n->edit == edit && *edit;
+}
+
+// n itself if this transient owns it, a copy it owns otherwise
+// (an empty one for a null n)
+template<typename T>
+std::shared_ptr<typename PersistentVector<T>::_Branch>
+PersistentVector<T>::_editable_branch(const _node_ptr& n, const _edit_type& edit) {
+  if(_editable(n, edit)) {
+    return std::static_pointer_cast<_Branch>(n);
+  }
+  auto copy = std::make_shared<_Branch>(edit);
+  if(n != nullptr) {
+    const _Branch& src = static_cast<const _Branch&>(*n);
+    for(std::size_t k = 0; k < _width; ++k) {
+      copy->children[k] = src.children[k];
+    }
+  }
+  return copy;
+}
+
+template<typename T>
+typename PersistentVector<T>::_leaf_ptr
+PersistentVector<T>::_editable_leaf(const _node_ptr& n, const _edit_type& edit) {
+  if(_editable(n, edit)) {
+    return std::static_pointer_cast<_Leaf>(n);
+  }
+  auto copy = std::make_shared<_Leaf>(edit);
+  if(n != nullptr) {
+    copy->values = static_cast<const _Leaf&>(*n).values;
+  }
+  return copy;
+}
+
+// chain of single-child branches from level shift down to the leaf n
+template<typename T>
+typename PersistentVector<T>::_node_ptr
+PersistentVector<T>::_new_path(std::size_t shift, const _node_ptr& n, const _edit_type& edit) {
+  if(shift == 0) {
+    return n;
+  }
+  auto b = std::make_shared<_Branch>(edit);
+  b->children[0] = _new_path(shift - _bits, n, edit);
+  return b;
+}
+
+// hangs the full tail leaf at the end of the trie below parent
+template<typename T>
+typename PersistentVector<T>::_node_ptr
+PersistentVector<T>::_push_tail(std::size_t shift, const _node_ptr& parent, const _node_ptr& tail, const _edit_type& edit) const {
+  auto b = _editable_branch(parent, edit);
+  const std::size_t k = ((_size - 1) >> shift) & _mask;
+  if(shift == _bits) {
+    b->children[k] = tail;
+  } else if(b->children[k] != nullptr) {
+    b->children[k] = _push_tail(shift - _bits, b->children[k], tail, edit);
+  } else {
+    b->children[k] = _new_path(shift - _bits, tail, edit);
+  }
+  return b;
+}
+
+// detaches the last leaf of the trie, returns nullptr for an emptied branch
+template<typename T>
+typename PersistentVector<T>::_node_ptr
+PersistentVector<T>::_pop_tail(std::size_t shift, const _node_ptr& n, const _edit_type& edit) const {
+  const std::size_t k = ((_size - 2) >> shift) & _mask;
+  if(shift > _bits) {
+    _node_ptr child = _pop_tail(shift - _bits, static_cast<const _Branch&>(*n).children[k], edit);
+    if(child == nullptr && k == 0) {
+      return nullptr;
+    }
+    auto b = _editable_branch(n, edit);
+    b->children[k] = child;
+    return b;
+  }
+  if(k == 0) {
+    return nullptr;
+  }
+  auto b = _editable_branch(n, edit);
+  b->children[k] = nullptr;
+  return b;
+}
+
+template<typename T>
+typename PersistentVector<T>::_node_ptr
+PersistentVector<T>::_assoc(std::size_t shift, const _node_ptr& n, std::size_t i, const T& e, const _edit_type& edit) {
+  if(shift == 0) {
+    auto leaf = _editable_leaf(n, edit);
+    leaf->values[i & _mask] = e;
+    return leaf;
+  }
+  auto b = _editable_branch(n, edit);
+  const std::size_t k = (i >> shift) & _mask;
+  b->children[k] = _assoc(shift - _bits, b->children[k], i, e, edit);
+  return b;
+}
+
+template<typename T>
+void PersistentVector<T>::_set(std::size_t i, const T& e, const _edit_type& edit) {
+  assert(i < size());
+  if(i >= _tail_offset()) {
+    _tail = _editable_leaf(_tail, edit);
+    _tail->values[i & _mask] = e;
+    return;
+  }
+  _root = _assoc(_shift, _root, i, e, edit);
+}
+
+template<typename T>
+void PersistentVector<T>::_push_back(const T& e, const _edit_type& edit) {
+  // room left in the tail
+  if(_size - _tail_offset() < _width) {
+    _tail = _editable_leaf(_tail, edit);
+    _tail->values.push_back(e);
+    _size++;
+    return;
+  }
+
+  // full tail: move it into the trie, growing a level if the root is full
+  if((_size >> _bits) > (std::size_t(1) << _shift)) {
+    auto root = std::make_shared<_Branch>(edit);
+    root->children[0] = _root;
+    root->children[1] = _new_path(_shift, _tail, edit);
+    _root = root;
+    _shift += _bits;
+  } else {
+    _root = _push_tail(_shift, _root, _tail, edit);
+  }
+  _tail = std::make_shared<_Leaf>(edit);
+  _tail->values.push_back(e);
+  _size++;
+}
+
+template<typename T>
+T PersistentVector<T>::_pop_back(const _edit_type& edit) {
+  assert(!empty());
+  T ret = back();
+  if(_size == 1) {
+    _root = nullptr;
+    _tail = nullptr;
+    _size = 0;
+    _shift = _bits;
+    return ret;
+  }
+  if(_size - _tail_offset() > 1) {
+    _tail = _editable_leaf(_tail, edit);
+    _tail->values.pop_back();
+    _size--;
+    return ret;
+  }
+
+  // the tail empties: the last leaf of the trie becomes the tail
+  _leaf_ptr new_tail = std::static_pointer_cast<_Leaf>(_trie_leaf(_size - 2));
+  _node_ptr root = _pop_tail(_shift, _root, edit);
+  if(root == nullptr) {
+    root = std::make_shared<_Branch>(edit);
+  }
+  // drop a level when the root is left with a single child
+  if(_shift > _bits && static_cast<const _Branch&>(*root).children[1] == nullptr) {
+    root = static_cast<const _Branch&>(*root).children[0];
+    _shift -= _bits;
+  }
+  _root = root;
+  _tail = new_tail;
+  _size--;
+  return ret;
+}
+
+#endif
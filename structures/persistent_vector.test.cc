@@ -0,0 +1,215 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <new>
+#include "persistent_vector.h"
+#include "../test_helpers.h"
+
+// counts every allocation of the program, so that a test can check an
+// operation does not allocate
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t n) {
+  ++allocations;
+  if(void* p = std::malloc(n)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Default construction");
+    PersistentVector<int> v;
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)0, "Size is 0");
+    th.tassert(v.empty(), true, "Vector is empty");
+  }
+
+  {
+    th.message("Initializer list construction");
+    PersistentVector<std::string> v = {"a", "b", "c"};
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)3, "Size is 3");
+    th.tassert(v[1], std::string("b"), "v[1] == \"b\"");
+    th.tassert(v.back(), std::string("c"), "v.back() == \"c\"");
+  }
+
+  {
+    PersistentVector<int> v;
+    th.message("Push 5000 elements (three trie levels)");
+    for(int i = 0; i < 5000; ++i) {
+      v.push_back(i);
+    }
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)5000, "Size is 5000");
+    th.tassert(v[0] + v[31] + v[32] + v[1023] + v[1024] + v[4999], 0 + 31 + 32 + 1023 + 1024 + 4999, "Elements across levels");
+
+    th.message("Snapshot is unaffected by later updates");
+    PersistentVector<int> snapshot = v;
+    v.set(0, -1);
+    v.set(1024, -2);
+    v.set(4999, -3);
+    v.push_back(5000);
+    th.tassert();
+    th.tassert(v[0] == -1 && v[1024] == -2 && v[4999] == -3, true, "Updated vector sees the updates");
+    th.tassert(snapshot[0] == 0 && snapshot[1024] == 1024 && snapshot[4999] == 4999, true, "Snapshot keeps the old values");
+    th.tassert(snapshot.size(), (std::size_t)5000, "Snapshot keeps its size");
+
+    th.message("pop_back down to a single element");
+    while(v.size() > 1) {
+      v.pop_back();
+    }
+    th.tassert();
+    th.tassert(v[0], -1, "v[0] == -1");
+    th.tassert(snapshot.back(), 4999, "Snapshot is still complete");
+    th.tassert(v.pop_back(), -1, "Last element is -1");
+    th.tassert(v.empty(), true, "Vector is empty");
+    v.push_back(7);
+    th.tassert(v[0], 7, "Pushing after emptying works");
+  }
+
+  {
+    PersistentVector<int> v = {1, 2, 3};
+    PersistentVector<int> w = {4, 5};
+    th.message("Move construction");
+    PersistentVector<int> moved(std::move(v));
+    th.tassert();
+    th.tassert(moved.size() == 3 && moved[2] == 3, true, "Moved vector has the elements");
+    th.tassert(v.empty(), true, "Moved-from vector is empty");
+    v.push_back(9);
+    th.tassert(v[0], 9, "Moved-from vector is usable");
+
+    th.message("Move assignment");
+    moved = std::move(w);
+    th.tassert();
+    th.tassert(moved.size() == 2 && moved[1] == 5, true, "Target has the moved elements");
+    w.push_back(6);
+    th.tassert(w.back(), 6, "Moved-from vector is usable");
+  }
+
+  {
+    PersistentVector<int> v = {1, 2, 3};
+    th.message("Default construction and moves do not allocate");
+    const std::size_t before = allocations;
+    PersistentVector<int> empty;
+    PersistentVector<int> moved(std::move(v));
+    empty = std::move(moved);
+    th.tassert();
+    th.tassert(allocations - before, (std::size_t)0, "No allocation");
+    th.tassert(empty.size() == 3 && empty[0] == 1, true, "Elements moved through");
+  }
+
+  {
+    PersistentVector<int> v = {1, 2, 3};
+    th.message("Transient batch");
+    auto t = v.transient();
+    for(int i = 4; i <= 2000; ++i) {
+      t.push_back(i);
+    }
+    t.set(0, 100);
+    t.pop_back();
+    PersistentVector<int> w = t.persistent();
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)3, "Original is untouched");
+    th.tassert(v[0], 1, "Original v[0] == 1");
+    th.tassert(w.size(), (std::size_t)1999, "Result has 1999 elements");
+    th.tassert(w[0] == 100 && w[1998] == 1999, true, "Result has the updates");
+
+    th.message("Updating the result does not touch nodes built by the transient");
+    PersistentVector<int> w2 = w;
+    w2.set(500, -500);
+    th.tassert();
+    th.tassert(w[500], 501, "w[500] == 501");
+    th.tassert(w2[500], -500, "w2[500] == -500");
+  }
+
+  {
+    th.message("Readers on snapshots while the writer updates");
+    PersistentVector<long long> v;
+    for(int i = 0; i < 10000; ++i) {
+      v.push_back(i);
+    }
+    std::vector<PersistentVector<long long>> snapshots;
+    std::vector<std::thread> readers;
+    std::vector<long long> sums(4, 0);
+    for(int r = 0; r < 4; ++r) {
+      snapshots.push_back(v);
+    }
+    for(int r = 0; r < 4; ++r) {
+      readers.emplace_back([&snapshots, &sums, r] {
+        const PersistentVector<long long>& s = snapshots[r];
+        for(std::size_t i = 0; i < s.size(); ++i) {
+          sums[r] += s[i];
+        }
+      });
+    }
+    for(int i = 0; i < 10000; ++i) {
+      v.set(i, 0);
+    }
+    for(auto& r : readers) {
+      r.join();
+    }
+    th.tassert();
+    bool consistent = true;
+    for(long long s : sums) {
+      consistent = consistent && s == 49995000LL;
+    }
+    th.tassert(consistent, true, "Every reader saw the whole old version");
+    th.tassert(v[9999], 0LL, "Writer saw its own updates");
+  }
+
+  std::srand((unsigned int)std::time(0));
+  {
+    PersistentVector<int> v;
+    std::vector<int> stdv;
+    std::vector<PersistentVector<int>> versions;
+    std::vector<std::vector<int>> std_versions;
+
+    th.message("Stress test push, set and pop with snapshots");
+    for(int i = 0; i < 20000; ++i) {
+      int op = std::rand() % 10;
+      if(op < 6 || stdv.empty()) {
+        int r = std::rand();
+        v.push_back(r);
+        stdv.push_back(r);
+      } else if(op < 9) {
+        std::size_t idx = std::rand() % stdv.size();
+        int r = std::rand();
+        v.set(idx, r);
+        stdv[idx] = r;
+      } else {
+        v.pop_back();
+        stdv.pop_back();
+      }
+      if(i % 2000 == 0) {
+        versions.push_back(v);
+        std_versions.push_back(stdv);
+      }
+    }
+    th.tassert();
+    th.tassert(v.to_std_vector() == stdv, true, "Check complete vector");
+    bool all = true;
+    for(std::size_t k = 0; k < versions.size(); ++k) {
+      all = all && versions[k].to_std_vector() == std_versions[k];
+    }
+    th.tassert(all, true, "Every snapshot kept its contents");
+  }
+
+  th.summary();
+  return 0;
+}
@@ -0,0 +1,260 @@
+#ifndef __STRUCTURES_SIMD__
+#define __STRUCTURES_SIMD__
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Equality search kernels over contiguous arrays:
+//   simd_find(arr, n, v)  index of the first element == v, or n
+//   simd_count(arr, n, v) number of elements == v
+// Integral types of 1, 2, 4 or 8 bytes, float and double are compared a
+// whole register at a time (AVX2 if the compiler targets it, SSE2
+// otherwise); any other type, or a target without SSE2, falls back to
+// std::find / std::count. The instruction set is picked at compile time
+// (e.g. build with -mavx2 or -march=native for the 256-bit kernels).
+// Floating point lanes use IEEE equality just like operator== does,
+// so NaN never matches and -0.0 matches 0.0
+
+// whether T has a vectorized kernel on this target
+template<typename T>
+struct simd_searchable : std::integral_constant<bool,
+#if defined(__AVX2__) || defined(__SSE2__)
+  (std::is_integral<T>::value &&
+   (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+  std::is_same<T, float>::value ||
+  std::is_same<T, double>::value
+#else
+  false
+#endif
+> { };
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+// lane kinds: integers by width, floating point apart because
+// their equality is not bitwise
+typedef std::integral_constant<int, 1> _simd_i8;
+typedef std::integral_constant<int, 2> _simd_i16;
+typedef std::integral_constant<int, 4> _simd_i32;
+typedef std::integral_constant<int, 8> _simd_i64;
+typedef std::integral_constant<int, 32> _simd_f32;
+typedef std::integral_constant<int, 64> _simd_f64;
+
+template<typename T>
+struct _simd_kind : std::integral_constant<int,
+  std::is_same<T, float>::value ? 32 :
+  std::is_same<T, double>::value ? 64 : (int)sizeof(T)> { };
+
+#if defined(__AVX2__)
+
+typedef __m256i _simd_reg;
+typedef std::uint32_t _simd_mask;
+
+inline _simd_reg _simd_load(const void* p) {
+  return _mm256_loadu_si256(static_cast<const __m256i*>(p));
+}
+
+// one bit per byte, set where the lanes compared equal
+inline _simd_mask _simd_movemask(_simd_reg r) {
+  return (_simd_mask)_mm256_movemask_epi8(r);
+}
+
+inline _simd_reg _simd_or(_simd_reg a, _simd_reg b) {
+  return _mm256_or_si256(a, b);
+}
+
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i8) { return _mm256_set1_epi8((char)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i16) { return _mm256_set1_epi16((short)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i32) { return _mm256_set1_epi32((int)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i64) { return _mm256_set1_epi64x((long long)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_f32) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_f64) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i8) { return _mm256_cmpeq_epi8(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i16) { return _mm256_cmpeq_epi16(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i32) { return _mm256_cmpeq_epi32(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i64) { return _mm256_cmpeq_epi64(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_f32) {
+  return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+}
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_f64) {
+  return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+}
+
+#else
+
+typedef __m128i _simd_reg;
+typedef std::uint32_t _simd_mask;
+
+inline _simd_reg _simd_load(const void* p) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+// one bit per byte, set where the lanes compared equal
+inline _simd_mask _simd_movemask(_simd_reg r) {
+  return (_simd_mask)_mm_movemask_epi8(r);
+}
+
+inline _simd_reg _simd_or(_simd_reg a, _simd_reg b) {
+  return _mm_or_si128(a, b);
+}
+
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i8) { return _mm_set1_epi8((char)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i16) { return _mm_set1_epi16((short)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i32) { return _mm_set1_epi32((int)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_i64) { return _mm_set1_epi64x((long long)v); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_f32) { return _mm_castps_si128(_mm_set1_ps(v)); }
+template<typename T>
+_simd_reg _simd_splat(T v, _simd_f64) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i8) { return _mm_cmpeq_epi8(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i16) { return _mm_cmpeq_epi16(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i32) { return _mm_cmpeq_epi32(a, b); }
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_i64) {
+  // SSE2 has no 64-bit compare: both 32-bit halves have to match
+  __m128i eq32 = _mm_cmpeq_epi32(a, b);
+  return _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_f32) {
+  return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+}
+inline _simd_reg _simd_cmpeq(_simd_reg a, _simd_reg b, _simd_f64) {
+  return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+}
+
+#endif
+
+template<typename T>
+std::size_t _simd_find(const T* arr, std::size_t n, const T& value, std::true_type) {
+  typedef _simd_kind<T> kind;
+  const std::size_t lanes = sizeof(_simd_reg) / sizeof(T);
+  const _simd_reg needle = _simd_splat(value, kind());
+
+  std::size_t i = 0;
+  // four registers per iteration, checked with a single branch
+  for(; i + 4 * lanes <= n; i += 4 * lanes) {
+    _simd_reg eq0 = _simd_cmpeq(_simd_load(arr + i), needle, kind());
+    _simd_reg eq1 = _simd_cmpeq(_simd_load(arr + i + lanes), needle, kind());
+    _simd_reg eq2 = _simd_cmpeq(_simd_load(arr + i + 2 * lanes), needle, kind());
+    _simd_reg eq3 = _simd_cmpeq(_simd_load(arr + i + 3 * lanes), needle, kind());
+    if(_simd_movemask(_simd_or(_simd_or(eq0, eq1), _simd_or(eq2, eq3))) != 0) {
+      break;
+    }
+  }
+
+  for(; i + lanes <= n; i += lanes) {
+    _simd_mask mask = _simd_movemask(_simd_cmpeq(_simd_load(arr + i), needle, kind()));
+    if(mask != 0) {
+      // every lane sets sizeof(T) consecutive bits
+      return i + __builtin_ctz(mask) / sizeof(T);
+    }
+  }
+
+  // tail shorter than a register
+  for(; i < n; ++i) {
+    if(arr[i] == value) {
+      return i;
+    }
+  }
+  return n;
+}
+
+template<typename T>
+std::size_t _simd_count(const T* arr, std::size_t n, const T& value, std::true_type) {
+  typedef _simd_kind<T> kind;
+  const std::size_t lanes = sizeof(_simd_reg) / sizeof(T);
+  const _simd_reg needle = _simd_splat(value, kind());
+
+  std::size_t bits = 0;
+  std::size_t i = 0;
+  for(; i + lanes <= n; i += lanes) {
+    bits += __builtin_popcount(_simd_movemask(_simd_cmpeq(_simd_load(arr + i), needle, kind())));
+  }
+
+  // every lane sets sizeof(T) bits
+  std::size_t count = bits / sizeof(T);
+  for(; i < n; ++i) {
+    count += (arr[i] == value);
+  }
+  return count;
+}
+
+#endif
+
+template<typename T>
+std::size_t _simd_find(const T* arr, std::size_t n, const T& value, std::false_type) {
+  return std::find(arr, arr + n, value) - arr;
+}
+
+template<typename T>
+std::size_t _simd_count(const T* arr, std::size_t n, const T& value, std::false_type) {
+  return std::count(arr, arr + n, value);
+}
+
+template<typename T>
+std::size_t simd_find(const T* arr, std::size_t n, const T& value) { // O(n)
+  return _simd_find(arr, n, value, simd_searchable<T>());
+}
+
+template<typename T>
+std::size_t simd_count(const T* arr, std::size_t n, const T& value) { // O(n)
+  return _simd_count(arr, n, value, simd_searchable<T>());
+}
+
+// Control byte groups, as used by Swiss-table style hash maps: 16 signed
+// bytes are examined at once and the answer is a 16-bit mask whose bit j
+// is set when byte j qualifies
+//   simd_group_match(g, v)   bytes equal to v
+//   simd_group_negative(g)   bytes with the sign bit set
+// A group is always 16 bytes wide (one SSE2 register), also on AVX2
+const std::size_t simd_group_size = 16;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+inline std::uint32_t simd_group_match(const std::int8_t* group, std::int8_t value) { // O(1)
+  __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(value)));
+}
+
+inline std::uint32_t simd_group_negative(const std::int8_t* group) { // O(1)
+  // movemask already collects the sign bits
+  return (std::uint32_t)_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+}
+
+#else
+
+inline std::uint32_t simd_group_match(const std::int8_t* group, std::int8_t value) { // O(1)
+  std::uint32_t mask = 0;
+  for(std::size_t j = 0; j < simd_group_size; ++j) {
+    mask |= (std::uint32_t)(group[j] == value) << j;
+  }
+  return mask;
+}
+
+inline std::uint32_t simd_group_negative(const std::int8_t* group) { // O(1)
+  std::uint32_t mask = 0;
+  for(std::size_t j = 0; j < simd_group_size; ++j) {
+    mask |= (std::uint32_t)(group[j] < 0) << j;
+  }
+  return mask;
+}
+
+#endif
+
+#endif
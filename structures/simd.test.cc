@@ -0,0 +1,111 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include "simd.h"
+#include "vector.h"
+#include "../test_helpers.h"
+
+// compares the kernels against std::find / std::count on every prefix
+// length and start offset, so that tails and unaligned loads are covered
+template<typename T>
+void test_kernels(TestHelper& th, const char* name) {
+  th.message(name);
+  std::vector<T> v(200);
+  for(auto& e : v) {
+    // few distinct values, so that there are plenty of matches
+    e = (T)(std::rand() % 7);
+  }
+
+  for(std::size_t offset = 0; offset < 9; ++offset) {
+    for(std::size_t n = 0; n + offset <= v.size(); n += 3) {
+      const T* arr = v.data() + offset;
+      for(int value = 0; value < 8; ++value) {
+        std::size_t expected_find = std::find(arr, arr + n, (T)value) - arr;
+        std::size_t expected_count = std::count(arr, arr + n, (T)value);
+        th.tassert(simd_find(arr, n, (T)value), expected_find, "find", true);
+        th.tassert(simd_count(arr, n, (T)value), expected_count, "count", true);
+      }
+    }
+  }
+  th.tassert();
+}
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+  std::srand((unsigned int)std::time(0));
+
+  th.message("Arithmetic types are searchable");
+  th.tassert();
+  th.tassert(simd_searchable<std::string>::value, false, "std::string falls back");
+
+  test_kernels<char>(th, "char");
+  test_kernels<std::uint8_t>(th, "uint8_t");
+  test_kernels<std::int16_t>(th, "int16_t");
+  test_kernels<int>(th, "int");
+  test_kernels<unsigned int>(th, "unsigned int");
+  test_kernels<std::int64_t>(th, "int64_t");
+  test_kernels<std::uint64_t>(th, "uint64_t");
+  test_kernels<float>(th, "float");
+  test_kernels<double>(th, "double");
+
+  {
+    th.message("64-bit values that only differ in one half");
+    std::vector<std::uint64_t> v(16, 0x0000000100000002ULL);
+    v[11] = 0x0000000200000002ULL;
+    th.tassert();
+    th.tassert(simd_find(v.data(), v.size(), (std::uint64_t)0x0000000200000002ULL), (std::size_t)11, "Found at 11");
+    th.tassert(simd_count(v.data(), v.size(), (std::uint64_t)0x0000000200000001ULL), (std::size_t)0, "No match");
+  }
+
+  {
+    th.message("IEEE equality");
+    std::vector<double> v(10, 1.0);
+    v[3] = std::numeric_limits<double>::quiet_NaN();
+    v[7] = -0.0;
+    th.tassert();
+    th.tassert(simd_find(v.data(), v.size(), std::numeric_limits<double>::quiet_NaN()), v.size(), "NaN never matches");
+    th.tassert(simd_find(v.data(), v.size(), 0.0), (std::size_t)7, "0.0 matches -0.0");
+  }
+
+  {
+    th.message("Control byte groups");
+    std::vector<std::int8_t> g(20);
+    for(std::size_t j = 0; j < g.size(); ++j) {
+      g[j] = (std::int8_t)(j % 3 == 0 ? -128 : j);
+    }
+    g[9] = 5;
+    th.tassert();
+    th.tassert(simd_group_match(g.data(), (std::int8_t)5), (std::uint32_t)((1u << 5) | (1u << 9)), "5 at 5 and 9");
+    th.tassert(simd_group_match(g.data() + 4, (std::int8_t)-128), (std::uint32_t)((1u << 2) | (1u << 8) | (1u << 11) | (1u << 14)), "Empty bytes, unaligned");
+    th.tassert(simd_group_negative(g.data() + 1), (std::uint32_t)((1u << 2) | (1u << 5) | (1u << 11) | (1u << 14)), "Negative bytes");
+    th.tassert(simd_group_match(g.data(), (std::int8_t)16), (std::uint32_t)0, "16 is past the group");
+  }
+
+  {
+    th.message("Vector count and contains");
+    Vector<int> v = {1, 2, 3, 2, 5, 2, 7, 8, 9, 2, 11, 12, 13, 2, 15, 16, 17, 2};
+    th.tassert();
+    th.tassert(v.count(2), (std::size_t)6, "Six 2s");
+    th.tassert(v.contains(17), true, "Contains 17");
+    th.tassert(v.contains(4), false, "Does not contain 4");
+    th.tassert(v.find(17), (std::size_t)16, "17 is at 16");
+    th.tassert(v.remove(2), (std::size_t)1, "First 2 removed from 1");
+    th.tassert(v.count(2), (std::size_t)5, "Five 2s");
+  }
+
+  {
+    th.message("Vector of strings falls back");
+    Vector<std::string> v = {"a", "b", "a"};
+    th.tassert();
+    th.tassert(v.count("a"), (std::size_t)2, "Two \"a\"");
+    th.tassert(v.find("b"), (std::size_t)1, "\"b\" is at 1");
+  }
+
+  th.summary();
+  return 0;
+}
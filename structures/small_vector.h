@@ -0,0 +1,153 @@
+#ifndef __STRUCTURES_SMALL_VECTOR__
+#define __STRUCTURES_SMALL_VECTOR__
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <initializer_list>
+#include "vector.h"
+
+// storage policy of SmallVector: capacities up to N live in a buffer
+// inside the object, anything bigger on the heap. Capacity never goes
+// below N, so shrinking back to N moves the elements back inline
+template<typename T, std::size_t N, class Alloc>
+class _InlineStorage {
+public:
+  typedef std::allocator_traits<Alloc> _traits;
+
+  static std::size_t min_capacity() {
+    return N;
+  }
+
+  T* allocate(Alloc& alloc, std::size_t n) {
+    return n > N ? _traits::allocate(alloc, n) : inline_arr();
+  }
+
+  void deallocate(Alloc& alloc, T* p, std::size_t n) {
+    if(p != inline_arr()) {
+      _traits::deallocate(alloc, p, n);
+    }
+  }
+
+  T* inline_arr() {
+    return reinterpret_cast<T*>(_inline);
+  }
+
+  const T* inline_arr() const {
+    return reinterpret_cast<const T*>(_inline);
+  }
+
+private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type _inline[N];
+};
+
+// Vector with room for N elements inside the object itself; the heap is
+// only used once the sequence outgrows N. Same interface (and growth
+// policies) as Vector<T>, except that capacity() never goes below N
+template<typename T, std::size_t N = 8, class Alloc = std::allocator<T>, class Growth = DoublingGrowth>
+class SmallVector : public _VectorBase<T, Alloc, Growth, _InlineStorage<T, N, Alloc>> {
+  static_assert(N > 0, "SmallVector needs at least one inline slot");
+
+public:
+  SmallVector(); // O(1)
+  explicit SmallVector(const Alloc& alloc); // O(1)
+  SmallVector(const SmallVector& v); // O(n)
+  SmallVector(SmallVector&& rvr); // O(1) if on the heap, O(N) if inline
+  SmallVector(std::initializer_list<T> l, const Alloc& alloc = Alloc()); // O(n)
+  SmallVector& operator=(const SmallVector& v); // O(n)
+  SmallVector& operator=(SmallVector&& rvr); // O(1) if on the heap, O(N) if inline
+
+  bool is_inline() const; // O(1)
+
+private:
+  typedef _VectorBase<T, Alloc, Growth, _InlineStorage<T, N, Alloc>> _base;
+
+  void _steal(SmallVector& rvr);
+};
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>::SmallVector() : _base(Alloc(), N) {
+}
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>::SmallVector(const Alloc& alloc) : _base(alloc, N) {
+}
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>::SmallVector(std::initializer_list<T> l, const Alloc& alloc) :
+_base(l, alloc, std::max(l.size(), N)) {
+}
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>::SmallVector(const SmallVector& v) : _base(v) {
+}
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>::SmallVector(SmallVector&& rvr) : _base(rvr._alloc, N) {
+  _steal(rvr);
+}
+
+// reuses the current storage when the elements of v fit in it
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>& SmallVector<T,N,Alloc,Growth>::operator=(const SmallVector& v) {
+  if(this != &v) {
+    this->_destroy(this->_arr, this->_arr + this->_size);
+    this->_size = 0;
+    if(this->_capacity < v._size) {
+      this->_reallocate(v._capacity);
+    }
+    this->_construct_from(v._arr, v._arr + v._size, this->_arr);
+    this->_size = v._size;
+  }
+  return *this;
+}
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+SmallVector<T,N,Alloc,Growth>& SmallVector<T,N,Alloc,Growth>::operator=(SmallVector&& rvr) {
+  // correctly handles self-assignment
+  if(this != &rvr) {
+    this->_destroy(this->_arr, this->_arr + this->_size);
+    this->_deallocate(this->_arr, this->_capacity);
+    this->_arr = this->inline_arr();
+    this->_size = 0;
+    this->_capacity = N;
+    _steal(rvr);
+  }
+  return *this;
+}
+
+// takes the contents of rvr, which is left empty and inline;
+// heap storage changes hands, inline elements (or heap elements from an
+// unequal allocator) have to be moved one by one
+template<typename T, std::size_t N, class Alloc, class Growth>
+void SmallVector<T,N,Alloc,Growth>::_steal(SmallVector& rvr) {
+  assert(is_inline() && this->empty());
+  if(rvr.is_inline() || this->_alloc != rvr._alloc) {
+    this->reserve(rvr._size);
+    this->_construct_from(
+      std::make_move_iterator(rvr._arr),
+      std::make_move_iterator(rvr._arr + rvr._size),
+      this->_arr
+    );
+    this->_size = rvr._size;
+    rvr.resize(0);
+  } else {
+    this->_arr = rvr._arr;
+    this->_size = rvr._size;
+    this->_capacity = rvr._capacity;
+    rvr._arr = rvr.inline_arr();
+    rvr._size = 0;
+    rvr._capacity = N;
+  }
+}
+
+template<typename T, std::size_t N, class Alloc, class Growth>
+bool SmallVector<T,N,Alloc,Growth>::is_inline() const {
+  return this->_arr == this->inline_arr();
+}
+
+#endif
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include "small_vector.h"
+#include "../test_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Default construction");
+    SmallVector<int, 4> v;
+    th.tassert();
+    th.tassert(v.capacity(), (std::size_t)4, "Initial capacity is N");
+    th.tassert(v.is_inline(), true, "Storage is inline");
+    th.message("Destruction");
+  }
+  th.tassert();
+
+  {
+    th.message("Initializer list construction (fits inline)");
+    SmallVector<int, 4> v = {1, 2, 3};
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)3, "Size is 3");
+    th.tassert(v.is_inline(), true, "Storage is inline");
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 2, 3}, true, "STD vectors equal");
+  }
+
+  {
+    th.message("Initializer list construction (spills)");
+    SmallVector<int, 2> v = {1, 2, 3, 4};
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)4, "Size is 4");
+    th.tassert(v.is_inline(), false, "Storage is on the heap");
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 2, 3, 4}, true, "STD vectors equal");
+  }
+
+  {
+    SmallVector<std::string, 2> small = {"a", "b"};
+    SmallVector<std::string, 2> big = {"a", "b", "c", "d"};
+
+    th.message("Copy construction");
+    SmallVector<std::string, 2> small2(small);
+    SmallVector<std::string, 2> big2(big);
+    th.tassert();
+    th.tassert(small2.to_std_vector() == small.to_std_vector(), true, "Inline copy equal");
+    th.tassert(big2.to_std_vector() == big.to_std_vector(), true, "Heap copy equal");
+
+    th.message("Move construction");
+    SmallVector<std::string, 2> small3(std::move(small2));
+    SmallVector<std::string, 2> big3(std::move(big2));
+    th.tassert();
+    th.tassert(small3.to_std_vector() == small.to_std_vector(), true, "Inline move equal");
+    th.tassert(big3.to_std_vector() == big.to_std_vector(), true, "Heap move equal");
+    th.tassert(small2.empty() && small2.is_inline(), true, "Moved-from is empty and inline");
+    th.tassert(big2.empty() && big2.is_inline(), true, "Moved-from is empty and inline");
+
+    th.message("operator= (copy)");
+    small3 = big;
+    big3 = small;
+    th.tassert();
+    th.tassert(small3.to_std_vector() == big.to_std_vector(), true, "STD vectors equal");
+    th.tassert(big3.to_std_vector() == small.to_std_vector(), true, "STD vectors equal");
+
+    th.message("operator= (move)");
+    small3 = std::move(big3);
+    th.tassert();
+    th.tassert(small3.to_std_vector() == small.to_std_vector(), true, "STD vectors equal");
+  }
+
+  {
+    SmallVector<int, 2> v;
+    v.push_back(7);
+    v.push_back(8);
+    th.tassert(v.is_inline(), true, "Two pushes stay inline");
+    th.tassert(v.capacity(), (std::size_t)2, "Capacity is 2");
+
+    v.push_back(9);
+    th.tassert(v.is_inline(), false, "Third push spills to the heap");
+    th.tassert(v.capacity(), (std::size_t)4, "Capacity is 4");
+
+    th.message("Insert 1 at offset 0");
+    v.insert(0, 1);
+    th.tassert();
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 7, 8, 9}, true, "STD vectors equal");
+
+    th.message("Emplace 5 at offset 2");
+    v.emplace(2, 5);
+    th.tassert();
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 7, 5, 8, 9}, true, "STD vectors equal");
+    th.tassert(v.find(8), (std::size_t)3, "Element 8 is found at location 3");
+
+    th.message("Remove and pop");
+    v.remove(5);
+    th.tassert(v.pop_back(), 9, "Popped 9");
+    th.tassert(v.erase(0), 1, "Erased 1");
+    th.tassert(v.to_std_vector() == std::vector<int>{7, 8}, true, "STD vectors equal");
+
+    th.message("Reserving N moves back inline");
+    v.reserve(2);
+    th.tassert();
+    th.tassert(v.is_inline(), true, "Storage is inline");
+    th.tassert(v.capacity(), (std::size_t)2, "Capacity is 2");
+    th.tassert(v[0], 7, "v[0] == 7");
+
+    th.message("Resize (grow) to 6, then (shrink) to 1");
+    v.resize(6);
+    th.tassert(v.capacity(), (std::size_t)6, "Capacity is 6");
+    v.resize(1);
+    th.tassert(v.capacity(), (std::size_t)2, "Capacity is N");
+    th.tassert(v.is_inline(), true, "Storage is inline");
+    th.tassert(v[0], 7, "v[0] == 7");
+  }
+
+  {
+    SmallVector<int, 4> v = {4, 2, 3, 1};
+    th.message("std::sort through iterators (inline)");
+    std::sort(v.begin(), v.end());
+    th.tassert();
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 2, 3, 4}, true, "STD vectors equal");
+    v.push_back(0);
+    th.message("std::sort through iterators (heap)");
+    std::sort(v.begin(), v.end());
+    th.tassert();
+    th.tassert(v.data()[0], 0, "data()[0] == 0");
+  }
+
+  {
+    SmallVector<std::string, 4> v;
+    for(int i = 0; i < 12; ++i) {
+      v.push_back(std::to_string(i));
+    }
+    th.message("erase_if on the heap");
+    std::size_t removed = v.erase_if([](const std::string& s) { return s.size() == 2; });
+    th.tassert();
+    th.tassert(removed, (std::size_t)2, "2 elements removed");
+    th.tassert(v.size(), (std::size_t)10, "Size is 10");
+    th.tassert(v.back(), std::string("9"), "Survivors keep their order");
+
+    th.message("Range erase [1, 10) moves back inline");
+    th.tassert(v.erase(1, 10), (std::size_t)9, "9 elements removed");
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)1, "Size is 1");
+    th.tassert(v.is_inline(), true, "Storage is inline");
+    th.tassert(v[0], std::string("0"), "v == {0}");
+
+    th.message("swap_erase inline");
+    v.push_back("a");
+    v.push_back("b");
+    th.tassert(v.swap_erase(0), std::string("0"), "Erased element is 0");
+    th.tassert();
+    th.tassert(v[0] == "b" && v[1] == "a", true, "v == {b, a}");
+    th.tassert(v.capacity(), (std::size_t)4, "Capacity stays at N");
+  }
+
+  std::srand((unsigned int)std::time(0));
+  {
+    SmallVector<int, 8> v;
+    std::vector<int> stdv;
+
+    th.message("Stress test push");
+    for(int i = 0; i < 2000; ++i) {
+      int r = std::rand();
+      v.push_back(r);
+      stdv.push_back(r);
+      th.tassert(v.to_std_vector() == stdv, true, "Check complete vector", true);
+    }
+    th.tassert();
+
+    th.message("Stress test delete by index");
+    while(!v.empty()) {
+      unsigned int idx = std::rand() % v.size();
+      int a = v.erase(idx);
+      int b = stdv[idx];
+      stdv.erase(stdv.begin() + idx);
+      if(a != b) {
+        th.tassert(a, b, "Element returned by erase");
+      }
+      th.tassert(v.to_std_vector() == stdv, true, "Check complete vector", true);
+    }
+    th.tassert();
+    th.tassert(v.is_inline(), true, "Storage is inline again");
+  }
+
+  th.summary();
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "vector.h"
+#include "soa_vector.h"
+#include "../bench_helpers.h"
+
+// a record with one hot field and a cold payload
+struct Order {
+  std::uint32_t price;
+  std::uint32_t quantity;
+  double cold[6];
+};
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 20;
+
+  Vector<Order> aos;
+  SoAVector<std::uint32_t, std::uint32_t, double, double, double, double, double, double> soa;
+  aos.reserve(n);
+  soa.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) {
+    Order o = {(std::uint32_t)(i * 7 % 1000), (std::uint32_t)i, {0, 0, 0, 0, 0, 0}};
+    aos.push_back(o);
+    soa.push_back(o.price, o.quantity, 0, 0, 0, 0, 0, 0);
+  }
+
+  std::cout << "\n[[ sum of one field over " << n << " 56-byte records ]]" << std::endl << std::endl;
+  bh.run("Vector<Order> (before)", [&] {
+    std::uint64_t sum = 0;
+    for(const Order& o : aos) {
+      sum += o.price;
+    }
+    bench_keep(sum);
+  });
+  bh.run("SoAVector column<0> (after)", [&] {
+    std::uint64_t sum = 0;
+    for(std::uint32_t p : soa.column<0>()) {
+      sum += p;
+    }
+    bench_keep(sum);
+  });
+
+  std::cout << "\n[[ 200 lookups of a missing price ]]" << std::endl << std::endl;
+  bh.run("Vector<Order> linear search (before)", [&] {
+    std::size_t found = 0;
+    for(std::uint32_t k = 0; k < 200; ++k) {
+      for(const Order& o : aos) {
+        if(o.price == 5000 + k) {
+          found++;
+          break;
+        }
+      }
+    }
+    bench_keep(found);
+  });
+  bh.run("SoAVector find<0> (after)", [&] {
+    std::size_t found = 0;
+    for(std::uint32_t k = 0; k < 200; ++k) {
+      found += soa.find<0>(5000 + k) != soa.size();
+    }
+    bench_keep(found);
+  });
+
+  return 0;
+}
@@ -0,0 +1,261 @@
+#ifndef __STRUCTURES_SOA_VECTOR__
+#define __STRUCTURES_SOA_VECTOR__
+
+#include <cstddef>
+#include <cassert>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "vector.h"
+
+// non-owning view over a contiguous array
+template<typename T>
+class Span {
+public:
+  typedef T value_type;
+  typedef T* iterator;
+
+  Span(T* data, std::size_t size) : _data(data), _size(size) { }
+
+  std::size_t size() const { return _size; } // O(1)
+  bool empty() const { return _size == 0; } // O(1)
+  T* data() const { return _data; } // O(1)
+  T& operator[](std::size_t i) const { return _data[i]; } // O(1)
+  T* begin() const { return _data; } // O(1)
+  T* end() const { return _data + _size; } // O(1)
+
+private:
+  T* _data;
+  std::size_t _size;
+};
+
+// Structure of arrays: a sequence of records (Fields...) where every
+// field lives in its own contiguous Vector. Scanning a single field reads
+// only that column, so no cache line is wasted on the other fields and
+// the column is a plain array the compiler (or simd_find) can vectorize.
+//   column<I>()   Span over field I of every row
+//   operator[]    row proxy, a tuple of references to the fields of row i
+//                 (std::get<I>(v[i]) = x writes a single field)
+// All columns always have the same size; they grow and shrink together
+template<typename... Fields>
+class SoAVector {
+public:
+  static const std::size_t field_count = sizeof...(Fields);
+
+  typedef std::tuple<Fields...> value_type;
+  typedef std::tuple<Fields&...> reference;
+  typedef std::tuple<const Fields&...> const_reference;
+  template<std::size_t I>
+  using field_type = typename std::tuple_element<I, value_type>::type;
+
+  SoAVector(); // O(1)
+
+  std::size_t size() const; // O(1)
+  bool empty() const; // O(1)
+  std::size_t capacity() const; // O(1)
+  std::size_t reserve(std::size_t new_capacity); // O(new_capacity)
+  void clear(); // O(n)
+
+  reference operator[](std::size_t i); // O(1)
+  const_reference operator[](std::size_t i) const; // O(1)
+  reference back(); // O(1)
+  const_reference back() const; // O(1)
+
+  template<std::size_t I>
+  Span<field_type<I>> column(); // O(1)
+  template<std::size_t I>
+  Span<const field_type<I>> column() const; // O(1)
+  // first row whose field I equals e, size() if none
+  template<std::size_t I>
+  std::size_t find(const field_type<I>& e) const; // O(n)
+
+  void push_back(const Fields&... fields); // amortized O(1)
+  void push_back(const value_type& row); // amortized O(1)
+  value_type pop_back(); // amortized O(1)
+  value_type erase(std::size_t i); // O(n)
+  value_type swap_erase(std::size_t i); // amortized O(1)
+
+  std::vector<value_type> to_std_vector() const; // O(n)
+
+private:
+  typedef std::index_sequence_for<Fields...> _indices;
+
+  template<std::size_t... I>
+  reference _row(std::size_t i, std::index_sequence<I...>);
+  template<std::size_t... I>
+  const_reference _row(std::size_t i, std::index_sequence<I...>) const;
+  template<std::size_t... I>
+  void _push_back(const value_type& row, std::index_sequence<I...>);
+  template<std::size_t... I>
+  value_type _pop_back(std::index_sequence<I...>);
+  template<std::size_t... I>
+  value_type _erase(std::size_t i, std::index_sequence<I...>);
+  template<std::size_t... I>
+  value_type _swap_erase(std::size_t i, std::index_sequence<I...>);
+  template<std::size_t... I>
+  void _reserve(std::size_t new_capacity, std::index_sequence<I...>);
+
+private:
+  std::tuple<Vector<Fields>...> _columns;
+};
+
+template<typename... Fields>
+const std::size_t SoAVector<Fields...>::field_count;
+
+template<typename... Fields>
+SoAVector<Fields...>::SoAVector() {
+}
+
+template<typename... Fields>
+std::size_t SoAVector<Fields...>::size() const {
+  return std::get<0>(_columns).size();
+}
+
+template<typename... Fields>
+bool SoAVector<Fields...>::empty() const {
+  return size() == 0;
+}
+
+template<typename... Fields>
+std::size_t SoAVector<Fields...>::capacity() const {
+  return std::get<0>(_columns).capacity();
+}
+
+template<typename... Fields>
+std::size_t SoAVector<Fields...>::reserve(std::size_t new_capacity) {
+  _reserve(new_capacity, _indices());
+  return capacity();
+}
+
+template<typename... Fields>
+void SoAVector<Fields...>::clear() {
+  while(!empty()) {
+    pop_back();
+  }
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::reference SoAVector<Fields...>::operator[](std::size_t i) {
+  return _row(i, _indices());
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::const_reference SoAVector<Fields...>::operator[](std::size_t i) const {
+  return _row(i, _indices());
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::reference SoAVector<Fields...>::back() {
+  return operator[](size() - 1);
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::const_reference SoAVector<Fields...>::back() const {
+  return operator[](size() - 1);
+}
+
+template<typename... Fields>
+template<std::size_t I>
+Span<typename SoAVector<Fields...>::template field_type<I>> SoAVector<Fields...>::column() {
+  auto& c = std::get<I>(_columns);
+  return Span<field_type<I>>(c.data(), c.size());
+}
+
+template<typename... Fields>
+template<std::size_t I>
+Span<const typename SoAVector<Fields...>::template field_type<I>> SoAVector<Fields...>::column() const {
+  const auto& c = std::get<I>(_columns);
+  return Span<const field_type<I>>(c.data(), c.size());
+}
+
+template<typename... Fields>
+template<std::size_t I>
+std::size_t SoAVector<Fields...>::find(const field_type<I>& e) const {
+  return std::get<I>(_columns).find(e);
+}
+
+template<typename... Fields>
+void SoAVector<Fields...>::push_back(const Fields&... fields) {
+  // copy first, the fields may be references into our own columns
+  _push_back(value_type(fields...), _indices());
+}
+
+template<typename... Fields>
+void SoAVector<Fields...>::push_back(const value_type& row) {
+  _push_back(value_type(row), _indices());
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::value_type SoAVector<Fields...>::pop_back() {
+  return _pop_back(_indices());
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::value_type SoAVector<Fields...>::erase(std::size_t i) {
+  return _erase(i, _indices());
+}
+
+template<typename... Fields>
+typename SoAVector<Fields...>::value_type SoAVector<Fields...>::swap_erase(std::size_t i) {
+  return _swap_erase(i, _indices());
+}
+
+template<typename... Fields>
+std::vector<typename SoAVector<Fields...>::value_type> SoAVector<Fields...>::to_std_vector() const {
+  std::vector<value_type> v;
+  v.reserve(size());
+  for(std::size_t i = 0; i < size(); ++i) {
+    v.push_back(value_type(operator[](i)));
+  }
+  return v;
+}
+
+template<typename... Fields>
+template<std::size_t... I>
+typename SoAVector<Fields...>::reference SoAVector<Fields...>::_row(std::size_t i, std::index_sequence<I...>) {
+  return reference(std::get<I>(_columns)[i]...);
+}
+
+template<typename... Fields>
+template<std::size_t... I>
+typename SoAVector<Fields...>::const_reference SoAVector<Fields...>::_row(std::size_t i, std::index_sequence<I...>) const {
+  return const_reference(std::get<I>(_columns)[i]...);
+}
+
+// the (int[]){(f(I), 0)...} idiom runs f once per column, in order
+template<typename... Fields>
+template<std::size_t... I>
+void SoAVector<Fields...>::_push_back(const value_type& row, std::index_sequence<I...>) {
+  int expand[] = { (std::get<I>(_columns).push_back(std::get<I>(row)), 0)... };
+  (void)expand;
+}
+
+template<typename... Fields>
+template<std::size_t... I>
+typename SoAVector<Fields...>::value_type SoAVector<Fields...>::_pop_back(std::index_sequence<I...>) {
+  assert(!empty());
+  return value_type(std::get<I>(_columns).pop_back()...);
+}
+
+template<typename... Fields>
+template<std::size_t... I>
+typename SoAVector<Fields...>::value_type SoAVector<Fields...>::_erase(std::size_t i, std::index_sequence<I...>) {
+  assert(i < size());
+  return value_type(std::get<I>(_columns).erase(i)...);
+}
+
+template<typename... Fields>
+template<std::size_t... I>
+typename SoAVector<Fields...>::value_type SoAVector<Fields...>::_swap_erase(std::size_t i, std::index_sequence<I...>) {
+  assert(i < size());
+  return value_type(std::get<I>(_columns).swap_erase(i)...);
+}
+
+template<typename... Fields>
+template<std::size_t... I>
+void SoAVector<Fields...>::_reserve(std::size_t new_capacity, std::index_sequence<I...>) {
+  int expand[] = { (std::get<I>(_columns).reserve(new_capacity), 0)... };
+  (void)expand;
+}
+
+#endif
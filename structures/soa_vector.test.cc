@@ -0,0 +1,103 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <tuple>
+#include <numeric>
+#include <cstdlib>
+#include <ctime>
+#include "soa_vector.h"
+#include "../test_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Default construction");
+    SoAVector<int, double, std::string> v;
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)0, "Size is 0");
+    th.tassert(v.field_count, (std::size_t)3, "3 fields");
+  }
+
+  {
+    SoAVector<int, double, std::string> v;
+    th.message("push_back rows");
+    v.push_back(1, 1.5, "one");
+    v.push_back(std::make_tuple(2, 2.5, std::string("two")));
+    v.push_back(3, 3.5, "three");
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)3, "Size is 3");
+    th.tassert(std::get<2>(v[1]), std::string("two"), "Row 1 field 2 is \"two\"");
+    th.tassert(std::get<0>(v.back()), 3, "Last row field 0 is 3");
+
+    th.message("Columns are contiguous");
+    Span<int> ids = v.column<0>();
+    Span<double> values = v.column<1>();
+    th.tassert();
+    th.tassert(ids.size(), (std::size_t)3, "Column size is 3");
+    th.tassert(&ids[2] - &ids[0], (std::ptrdiff_t)2, "Ids are adjacent");
+    th.tassert(std::accumulate(values.begin(), values.end(), 0.0), 7.5, "Sum of column 1 is 7.5");
+
+    th.message("Writing through the row proxy");
+    std::get<1>(v[0]) = 10.0;
+    v[2] = std::make_tuple(30, 30.5, std::string("thirty"));
+    th.tassert();
+    th.tassert(v.column<1>()[0], 10.0, "Column 1 row 0 is 10");
+    th.tassert(std::get<2>(v[2]), std::string("thirty"), "Row 2 was replaced");
+
+    th.message("find on a column");
+    th.tassert(v.find<0>(30), (std::size_t)2, "Id 30 is in row 2");
+    th.tassert(v.find<2>("two"), (std::size_t)1, "\"two\" is in row 1");
+    th.tassert(v.find<0>(99), (std::size_t)3, "Id 99 is not there");
+
+    th.message("erase and swap_erase");
+    auto row = v.erase(0);
+    th.tassert();
+    th.tassert(std::get<2>(row), std::string("one"), "Erased row was \"one\"");
+    th.tassert(std::get<0>(v[0]), 2, "Row 0 is now 2");
+    v.push_back(4, 4.5, "four");
+    v.swap_erase(0);
+    th.tassert(std::get<0>(v[0]), 4, "Last row moved to the front");
+    th.tassert(v.size(), (std::size_t)2, "Size is 2");
+
+    th.message("const access");
+    const auto& cv = v;
+    th.tassert(std::get<0>(cv[1]), 30, "cv[1] field 0 is 30");
+    th.tassert(cv.column<2>()[1], std::string("thirty"), "cv column 2 row 1");
+
+    th.message("clear");
+    v.clear();
+    th.tassert();
+    th.tassert(v.empty(), true, "Vector is empty");
+  }
+
+  std::srand((unsigned int)std::time(0));
+  {
+    SoAVector<int, long long> v;
+    std::vector<std::tuple<int, long long>> stdv;
+
+    th.message("Stress test push, erase and pop");
+    for(int i = 0; i < 5000; ++i) {
+      int op = std::rand() % 4;
+      if(op < 2 || stdv.empty()) {
+        int a = std::rand();
+        long long b = (long long)std::rand() * 3;
+        v.push_back(a, b);
+        stdv.push_back(std::make_tuple(a, b));
+      } else if(op == 2) {
+        std::size_t idx = std::rand() % stdv.size();
+        v.erase(idx);
+        stdv.erase(stdv.begin() + idx);
+      } else {
+        v.pop_back();
+        stdv.pop_back();
+      }
+    }
+    th.tassert();
+    th.tassert(v.to_std_vector() == stdv, true, "Check complete vector");
+    th.tassert(v.column<0>().size() == v.column<1>().size(), true, "Columns have the same size");
+  }
+
+  th.summary();
+  return 0;
+}
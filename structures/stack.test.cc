@@ -7,7 +7,7 @@
 #include "vector.h"
 #include "../test_helpers.h"
 
-template<template<typename> class Base>
+template<template<typename...> class Base>
 void test_stack(TestHelper& th) {
   {
     th.message("Default construction");
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include "vector.h"
+#include "list.h"
+#include "tiered_vector.h"
+#include "../bench_helpers.h"
+
+// cheap deterministic positions so every container sees the same sequence
+inline std::size_t next_position(std::uint64_t& state, std::size_t bound) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (std::size_t)((state >> 33) % bound);
+}
+
+template<class V>
+void fill(V& v, std::size_t n) {
+  for(std::size_t i = 0; i < n; ++i) {
+    v.push_back((int)i);
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 100000;
+  const std::size_t ops = 20000;
+
+  std::cout << "\n[[ " << ops << " random insert + erase pairs in " << n << " ints ]]" << std::endl << std::endl;
+
+  bh.run("Vector (before)", [=] {
+    Vector<int> v;
+    fill(v, n);
+    std::uint64_t state = 1;
+    for(std::size_t i = 0; i < ops; ++i) {
+      v.insert(next_position(state, v.size() + 1), (int)i);
+      v.erase(next_position(state, v.size()));
+    }
+    bench_keep(v[0]);
+  });
+
+  bh.run("DoublyLinkedList (before)", [=] {
+    DoublyLinkedList<int> v;
+    fill(v, n);
+    std::uint64_t state = 1;
+    // a tenth of the operations, the walks are too slow for the full run
+    for(std::size_t i = 0; i < ops / 10; ++i) {
+      v.insert_at(next_position(state, v.size() + 1), (int)i);
+      v.remove_at(next_position(state, v.size()));
+    }
+    bench_keep(v.front());
+  });
+
+  bh.run("TieredVector (after)", [=] {
+    TieredVector<int> v;
+    fill(v, n);
+    std::uint64_t state = 1;
+    for(std::size_t i = 0; i < ops; ++i) {
+      v.insert(next_position(state, v.size() + 1), (int)i);
+      v.erase(next_position(state, v.size()));
+    }
+    bench_keep(v[0]);
+  });
+
+  std::cout << "\n[[ " << n << " indexed reads ]]" << std::endl << std::endl;
+  Vector<int> vec;
+  TieredVector<int> tiered;
+  fill(vec, n);
+  fill(tiered, n);
+  bh.run("Vector", [&] {
+    long long sum = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      sum += vec[i];
+    }
+    bench_keep(sum);
+  });
+  bh.run("TieredVector", [&] {
+    long long sum = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      sum += tiered[i];
+    }
+    bench_keep(sum);
+  });
+
+  return 0;
+}
@@ -0,0 +1,463 @@
+#ifndef __STRUCTURES_TIERED_VECTOR__
+#define __STRUCTURES_TIERED_VECTOR__
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <initializer_list>
+#include <vector>
+#include "simd.h"
+
+// Indexed sequence stored as a list of circular chunks of C slots each
+// (a tiered vector). Every chunk is full except the last one, so element
+// i is slot i % C of chunk i / C and random access stays O(1).
+// A middle insert shifts at most C elements inside its chunk and then
+// moves one element across each following chunk, which is O(1) per chunk
+// since the chunks are circular (pop_back of one, push_front of the next).
+// C is kept around sqrt(n): the chunks are rebuilt with 2C slots when n
+// grows past 4C^2 and with C/2 when it drops below C^2/4, so insert and
+// erase are O(sqrt n) (amortized, counting the O(n) rebuilds).
+// Elements are contiguous inside a chunk (in at most two runs because of
+// the wrap around), which find() scans with the SIMD kernels
+template<typename T, class Alloc = std::allocator<T>>
+class TieredVector {
+public:
+  typedef Alloc allocator_type;
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+
+  TieredVector(); // O(1)
+  explicit TieredVector(const Alloc& alloc); // O(1)
+  TieredVector(const TieredVector& v); // O(n)
+  TieredVector(TieredVector&& rvr); // O(1)
+  TieredVector(std::initializer_list<T> l, const Alloc& alloc = Alloc()); // O(n)
+  TieredVector& operator=(const TieredVector& v); // O(n)
+  TieredVector& operator=(TieredVector&& rvr); // O(1)
+  virtual ~TieredVector(); // O(n)
+
+  std::size_t size() const; // O(1)
+  bool empty() const; // O(1)
+  std::size_t chunk_size() const; // O(1)
+
+  T& at(std::size_t i); // O(1)
+  const T& at(std::size_t i) const; // O(1)
+  T& operator[](std::size_t i); // O(1)
+  const T& operator[](std::size_t i) const; // O(1)
+  T& back(); // O(1)
+  const T& back() const; // O(1)
+
+  std::size_t find(const T& e) const; // O(n)
+  bool contains(const T& e) const; // O(n)
+
+  void push_back(const T& e); // amortized O(1)
+  void push_back(T&& e); // amortized O(1)
+  void insert(std::size_t i, const T& e); // amortized O(sqrt n)
+  void insert(std::size_t i, T&& e); // amortized O(sqrt n)
+  T pop_back(); // amortized O(1)
+  T erase(std::size_t i); // amortized O(sqrt n)
+  std::size_t remove(const T& e); // O(n)
+  void clear(); // O(n)
+
+  std::vector<T> to_std_vector() const; // O(n)
+  Alloc get_allocator() const; // O(1)
+
+private:
+  // data points to chunk_size() raw slots; the live elements are the
+  // size slots starting at head, wrapping around the end
+  struct _Chunk {
+    T* data;
+    std::size_t head;
+    std::size_t size;
+  };
+
+  typedef std::allocator_traits<Alloc> _traits;
+  typedef typename _traits::template rebind_alloc<_Chunk> _chunk_alloc_type;
+
+  static const std::size_t _min_chunk_size = 16;
+
+  T* _slot(const _Chunk& c, std::size_t offset) const;
+  void _add_chunk();
+  void _pop_chunk();
+  void _chunk_insert(_Chunk& c, std::size_t offset, T&& e);
+  T _chunk_erase(_Chunk& c, std::size_t offset);
+  void _chunk_push_front(_Chunk& c, T&& e);
+  void _chunk_push_back(_Chunk& c, T&& e);
+  T _chunk_pop_front(_Chunk& c);
+  T _chunk_pop_back(_Chunk& c);
+  void _rebuild(std::size_t new_chunk_size);
+  void _steal(TieredVector& v);
+
+private:
+  Alloc _alloc;
+  std::vector<_Chunk, _chunk_alloc_type> _chunks;
+  std::size_t _chunk_size;
+  std::size_t _size;
+};
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>::TieredVector() : TieredVector(Alloc()) {
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>::TieredVector(const Alloc& alloc) :
+_alloc(alloc), _chunks(_chunk_alloc_type(alloc)), _chunk_size(_min_chunk_size), _size(0) {
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>::TieredVector(const TieredVector& v) :
+TieredVector(_traits::select_on_container_copy_construction(v._alloc)) {
+  for(std::size_t i = 0; i < v.size(); ++i) {
+    push_back(v[i]);
+  }
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>::TieredVector(TieredVector&& rvr) : TieredVector(rvr._alloc) {
+  _steal(rvr);
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>::TieredVector(std::initializer_list<T> l, const Alloc& alloc) : TieredVector(alloc) {
+  for(const T& e : l) {
+    push_back(e);
+  }
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>& TieredVector<T,Alloc>::operator=(const TieredVector& v) {
+  if(this != &v) {
+    clear();
+    for(std::size_t i = 0; i < v.size(); ++i) {
+      push_back(v[i]);
+    }
+  }
+  return *this;
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>& TieredVector<T,Alloc>::operator=(TieredVector&& rvr) {
+  if(this != &rvr) {
+    clear();
+    if(_alloc != rvr._alloc) {
+      // chunks from another allocator cannot change hands
+      for(std::size_t i = 0; i < rvr.size(); ++i) {
+        push_back(std::move(rvr[i]));
+      }
+      rvr.clear();
+    } else {
+      _steal(rvr);
+    }
+  }
+  return *this;
+}
+
+template<typename T, class Alloc>
+TieredVector<T,Alloc>::~TieredVector() {
+  clear();
+}
+
+// takes over the chunks of v, which gets the (empty) ones of *this;
+// both allocators must be equal
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_steal(TieredVector& v) {
+  _chunks.swap(v._chunks);
+  std::swap(_chunk_size, v._chunk_size);
+  std::swap(_size, v._size);
+}
+
+template<typename T, class Alloc>
+std::size_t TieredVector<T,Alloc>::size() const {
+  return _size;
+}
+
+template<typename T, class Alloc>
+bool TieredVector<T,Alloc>::empty() const {
+  return size() == 0;
+}
+
+template<typename T, class Alloc>
+std::size_t TieredVector<T,Alloc>::chunk_size() const {
+  return _chunk_size;
+}
+
+// chunk sizes are powers of two, so wrapping around is a mask
+template<typename T, class Alloc>
+T* TieredVector<T,Alloc>::_slot(const _Chunk& c, std::size_t offset) const {
+  return c.data + ((c.head + offset) & (_chunk_size - 1));
+}
+
+template<typename T, class Alloc>
+T& TieredVector<T,Alloc>::at(std::size_t i) {
+  return *_slot(_chunks[i / _chunk_size], i & (_chunk_size - 1));
+}
+
+template<typename T, class Alloc>
+const T& TieredVector<T,Alloc>::at(std::size_t i) const {
+  return *_slot(_chunks[i / _chunk_size], i & (_chunk_size - 1));
+}
+
+template<typename T, class Alloc>
+T& TieredVector<T,Alloc>::operator[](std::size_t i) {
+  return at(i);
+}
+
+template<typename T, class Alloc>
+const T& TieredVector<T,Alloc>::operator[](std::size_t i) const {
+  return at(i);
+}
+
+template<typename T, class Alloc>
+T& TieredVector<T,Alloc>::back() {
+  return at(size() - 1);
+}
+
+template<typename T, class Alloc>
+const T& TieredVector<T,Alloc>::back() const {
+  return at(size() - 1);
+}
+
+// each chunk holds at most two contiguous runs
+template<typename T, class Alloc>
+std::size_t TieredVector<T,Alloc>::find(const T& e) const {
+  for(std::size_t k = 0; k < _chunks.size(); ++k) {
+    const _Chunk& c = _chunks[k];
+    const std::size_t first_run = std::min(c.size, _chunk_size - c.head);
+    std::size_t loc = simd_find(c.data + c.head, first_run, e);
+    if(loc == first_run && first_run < c.size) {
+      loc = first_run + simd_find(c.data, c.size - first_run, e);
+    }
+    if(loc < c.size) {
+      return k * _chunk_size + loc;
+    }
+  }
+  return size();
+}
+
+template<typename T, class Alloc>
+bool TieredVector<T,Alloc>::contains(const T& e) const {
+  return find(e) != size();
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::push_back(const T& e) {
+  insert(size(), e);
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::push_back(T&& e) {
+  insert(size(), std::move(e));
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::insert(std::size_t i, const T& e) {
+  // copy first, e may be one of our own elements
+  insert(i, T(e));
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::insert(std::size_t i, T&& e) {
+  assert(i <= size());
+  if(size() + 1 > 4 * _chunk_size * _chunk_size) {
+    _rebuild(2 * _chunk_size);
+  }
+  if(_chunks.empty() || _chunks.back().size == _chunk_size) {
+    _add_chunk();
+  }
+
+  // make room in chunk i / C by handing its last element over to the
+  // next chunk, cascading up to the last (non full) one
+  const std::size_t j = i / _chunk_size;
+  for(std::size_t k = _chunks.size() - 1; k > j; --k) {
+    _chunk_push_front(_chunks[k], _chunk_pop_back(_chunks[k - 1]));
+  }
+  _chunk_insert(_chunks[j], i & (_chunk_size - 1), std::move(e));
+  _size++;
+}
+
+template<typename T, class Alloc>
+T TieredVector<T,Alloc>::pop_back() {
+  return erase(size() - 1);
+}
+
+template<typename T, class Alloc>
+T TieredVector<T,Alloc>::erase(std::size_t i) {
+  assert(i < size());
+  const std::size_t j = i / _chunk_size;
+  T ret = _chunk_erase(_chunks[j], i & (_chunk_size - 1));
+  // fill the hole with the first element of every following chunk
+  for(std::size_t k = j + 1; k < _chunks.size(); ++k) {
+    _chunk_push_back(_chunks[k - 1], _chunk_pop_front(_chunks[k]));
+  }
+  if(_chunks.back().size == 0) {
+    _pop_chunk();
+  }
+  _size--;
+
+  if(_chunk_size > _min_chunk_size && size() < _chunk_size * _chunk_size / 4) {
+    _rebuild(_chunk_size / 2);
+  }
+  return ret;
+}
+
+template<typename T, class Alloc>
+std::size_t TieredVector<T,Alloc>::remove(const T& e) {
+  std::size_t loc = find(e);
+  if(loc != size()) {
+    erase(loc);
+  }
+  return loc;
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::clear() {
+  while(!_chunks.empty()) {
+    _Chunk& c = _chunks.back();
+    for(std::size_t o = 0; o < c.size; ++o) {
+      _traits::destroy(_alloc, _slot(c, o));
+    }
+    c.size = 0;
+    _pop_chunk();
+  }
+  _size = 0;
+  _chunk_size = _min_chunk_size;
+}
+
+template<typename T, class Alloc>
+std::vector<T> TieredVector<T,Alloc>::to_std_vector() const {
+  std::vector<T> v;
+  v.reserve(size());
+  for(std::size_t i = 0; i < size(); ++i) {
+    v.push_back(at(i));
+  }
+  return v;
+}
+
+template<typename T, class Alloc>
+Alloc TieredVector<T,Alloc>::get_allocator() const {
+  return _alloc;
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_add_chunk() {
+  _Chunk c = {_traits::allocate(_alloc, _chunk_size), 0, 0};
+  _chunks.push_back(c);
+}
+
+// the last chunk must be empty
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_pop_chunk() {
+  assert(_chunks.back().size == 0);
+  _traits::deallocate(_alloc, _chunks.back().data, _chunk_size);
+  _chunks.pop_back();
+}
+
+// shifts whichever side of offset is shorter, the chunk must not be full
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_chunk_insert(_Chunk& c, std::size_t offset, T&& e) {
+  assert(c.size < _chunk_size && offset <= c.size);
+  if(offset == c.size) {
+    _chunk_push_back(c, std::move(e));
+    return;
+  }
+  if(offset == 0) {
+    _chunk_push_front(c, std::move(e));
+    return;
+  }
+
+  if(offset < c.size / 2) {
+    // open a slot before the head and slide the front one step left
+    c.head = (c.head - 1) & (_chunk_size - 1);
+    c.size++;
+    _traits::construct(_alloc, _slot(c, 0), std::move(*_slot(c, 1)));
+    for(std::size_t o = 1; o < offset; ++o) {
+      *_slot(c, o) = std::move(*_slot(c, o + 1));
+    }
+  } else {
+    _traits::construct(_alloc, _slot(c, c.size), std::move(*_slot(c, c.size - 1)));
+    for(std::size_t o = c.size - 1; o > offset; --o) {
+      *_slot(c, o) = std::move(*_slot(c, o - 1));
+    }
+    c.size++;
+  }
+  *_slot(c, offset) = std::move(e);
+}
+
+template<typename T, class Alloc>
+T TieredVector<T,Alloc>::_chunk_erase(_Chunk& c, std::size_t offset) {
+  assert(offset < c.size);
+  T ret = std::move(*_slot(c, offset));
+  if(offset < c.size / 2) {
+    for(std::size_t o = offset; o > 0; --o) {
+      *_slot(c, o) = std::move(*_slot(c, o - 1));
+    }
+    _traits::destroy(_alloc, _slot(c, 0));
+    c.head = (c.head + 1) & (_chunk_size - 1);
+  } else {
+    for(std::size_t o = offset; o + 1 < c.size; ++o) {
+      *_slot(c, o) = std::move(*_slot(c, o + 1));
+    }
+    _traits::destroy(_alloc, _slot(c, c.size - 1));
+  }
+  c.size--;
+  return ret;
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_chunk_push_front(_Chunk& c, T&& e) {
+  assert(c.size < _chunk_size);
+  c.head = (c.head - 1) & (_chunk_size - 1);
+  _traits::construct(_alloc, _slot(c, 0), std::move(e));
+  c.size++;
+}
+
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_chunk_push_back(_Chunk& c, T&& e) {
+  assert(c.size < _chunk_size);
+  _traits::construct(_alloc, _slot(c, c.size), std::move(e));
+  c.size++;
+}
+
+template<typename T, class Alloc>
+T TieredVector<T,Alloc>::_chunk_pop_front(_Chunk& c) {
+  assert(c.size > 0);
+  T ret = std::move(*_slot(c, 0));
+  _traits::destroy(_alloc, _slot(c, 0));
+  c.head = (c.head + 1) & (_chunk_size - 1);
+  c.size--;
+  return ret;
+}
+
+template<typename T, class Alloc>
+T TieredVector<T,Alloc>::_chunk_pop_back(_Chunk& c) {
+  assert(c.size > 0);
+  T ret = std::move(*_slot(c, c.size - 1));
+  _traits::destroy(_alloc, _slot(c, c.size - 1));
+  c.size--;
+  return ret;
+}
+
+// moves every element into chunks of the new size, O(n)
+template<typename T, class Alloc>
+void TieredVector<T,Alloc>::_rebuild(std::size_t new_chunk_size) {
+  TieredVector tmp(_alloc);
+  tmp._chunk_size = new_chunk_size;
+  tmp._chunks.reserve((size() + new_chunk_size - 1) / new_chunk_size + 1);
+  for(std::size_t k = 0; k < _chunks.size(); ++k) {
+    _Chunk& c = _chunks[k];
+    for(std::size_t o = 0; o < c.size; ++o) {
+      if(tmp._chunks.empty() || tmp._chunks.back().size == new_chunk_size) {
+        tmp._add_chunk();
+      }
+      tmp._chunk_push_back(tmp._chunks.back(), std::move(*_slot(c, o)));
+    }
+  }
+  tmp._size = size();
+  clear();
+  _steal(tmp);
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <ctime>
+#include "tiered_vector.h"
+#include "../test_helpers.h"
+
+int main(int argc, char const *argv[]) {
+  TestHelper th;
+
+  {
+    th.message("Default construction");
+    TieredVector<int> v;
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)0, "Size is 0");
+    th.tassert(v.chunk_size(), (std::size_t)16, "Chunk size is 16");
+    th.message("Destruction");
+  }
+  th.tassert();
+
+  {
+    th.message("Initializer list construction");
+    TieredVector<int> v = {1, 2, 3, 4};
+    th.tassert();
+    th.tassert(v.size(), (std::size_t)4, "Size is 4");
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 2, 3, 4}, true, "STD vectors equal");
+
+    th.message("Copy and move");
+    TieredVector<int> v2(v);
+    TieredVector<int> v3(std::move(v2));
+    th.tassert();
+    th.tassert(v3.to_std_vector() == v.to_std_vector(), true, "STD vectors equal");
+    th.tassert(v2.empty(), true, "Moved-from vector is empty");
+    v2 = v3;
+    th.tassert(v2.to_std_vector() == v.to_std_vector(), true, "Copy-assigned vector is equal");
+  }
+
+  {
+    TieredVector<int> v;
+    th.message("Push 40 elements (3 chunks)");
+    for(int i = 0; i < 40; ++i) {
+      v.push_back(i);
+    }
+    th.tassert();
+    th.tassert(v[39], 39, "v[39] == 39");
+
+    th.message("Insert in the middle of the first chunk");
+    v.insert(5, 100);
+    th.tassert();
+    th.tassert(v[5], 100, "v[5] == 100");
+    th.tassert(v[6], 5, "v[6] == 5");
+    th.tassert(v[16], 15, "v[16] == 15 (crossed into the second chunk)");
+    th.tassert(v.back(), 39, "Last element is 39");
+    th.tassert(v.size(), (std::size_t)41, "Size is 41");
+
+    th.message("Insert at the front and near the end of a chunk");
+    v.insert(0, -1);
+    v.insert(30, 200);
+    th.tassert();
+    th.tassert(v[0], -1, "v[0] == -1");
+    th.tassert(v[30], 200, "v[30] == 200");
+    th.tassert(v.find(200), (std::size_t)30, "find(200) == 30");
+
+    th.message("Erase from the middle");
+    th.tassert(v.erase(6), 100, "Erased element is 100");
+    th.tassert(v.erase(29), 200, "Erased element is 200");
+    th.tassert(v.erase(0), -1, "Erased element is -1");
+    th.tassert();
+    bool in_order = true;
+    for(int i = 0; i < 40; ++i) {
+      in_order = in_order && v[i] == i;
+    }
+    th.tassert(in_order, true, "Elements are back in order");
+
+    th.message("remove and contains");
+    th.tassert(v.remove(20), (std::size_t)20, "20 was at index 20");
+    th.tassert(v.contains(20), false, "20 is gone");
+    th.tassert(v.contains(21), true, "21 is still there");
+  }
+
+  {
+    TieredVector<std::string> v;
+    th.message("Chunks grow with the size");
+    for(int i = 0; i < 5000; ++i) {
+      v.push_back(std::to_string(i));
+    }
+    th.tassert();
+    th.tassert(v.chunk_size(), (std::size_t)64, "Chunk size is 64");
+    th.tassert(v[4321], std::string("4321"), "v[4321] == \"4321\"");
+
+    th.message("and shrink with it");
+    while(v.size() > 100) {
+      v.pop_back();
+    }
+    th.tassert();
+    th.tassert(v.chunk_size(), (std::size_t)16, "Chunk size is 16");
+    th.tassert(v[99], std::string("99"), "v[99] == \"99\"");
+
+    th.message("Insert of an own element");
+    v.insert(0, v[50]);
+    th.tassert();
+    th.tassert(v[0], std::string("50"), "v[0] == \"50\"");
+  }
+
+  std::srand((unsigned int)std::time(0));
+  {
+    TieredVector<int> v;
+    std::vector<int> stdv;
+
+    th.message("Stress test insert at random positions");
+    for(int i = 0; i < 5000; ++i) {
+      std::size_t idx = std::rand() % (v.size() + 1);
+      int r = std::rand();
+      v.insert(idx, r);
+      stdv.insert(stdv.begin() + idx, r);
+    }
+    th.tassert();
+    th.tassert(v.to_std_vector() == stdv, true, "Check complete vector");
+
+    th.message("Stress test delete by index");
+    for(int i = 0; i < 4900; ++i) {
+      std::size_t idx = std::rand() % v.size();
+      int a = v.erase(idx);
+      int b = stdv[idx];
+      stdv.erase(stdv.begin() + idx);
+      if(a != b) {
+        th.tassert(a, b, "Element returned by erase");
+      }
+    }
+    th.tassert();
+    th.tassert(v.to_std_vector() == stdv, true, "Check complete vector");
+  }
+
+  th.summary();
+  return 0;
+}
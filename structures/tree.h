@@ -4,16 +4,22 @@
 #include <cstddef>
 #include <cassert>
 #include <memory>
+#include <utility>
+#include <type_traits>
 #include <list>
 #include <queue>
 #include <stack>
 #include <functional>
 #include <iostream>
+#include "arena.h"
 
-template<typename T>
+template<typename T, class Alloc = std::allocator<T>>
 class BinarySearchTree {
 public:
+  typedef Alloc allocator_type;
+
   BinarySearchTree();
+  explicit BinarySearchTree(const Alloc& alloc);
   ~BinarySearchTree(); // O(n)
   // TODO: copy and move constructors
   // TODO: assignment operator
@@ -47,6 +53,13 @@ private:
     Node* right;
   };
 
+  typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> _node_alloc_type;
+  typedef std::allocator_traits<_node_alloc_type> _node_traits;
+
+  template<typename... Args>
+  Node* _new_node(Args&&... args);
+  void _delete_node(Node* n);
+
   Node** _get_node_for(const T& d) const;
   Node** _inorder_successor_of(Node *n) const;
   void _remove_node(Node** nptr);
@@ -58,29 +71,34 @@ private:
   static void _visit_nodes_postorder(Node* n, std::function<void(Node*)> f);
 
 private:
+  _node_alloc_type _node_alloc;
   Node* _root;
   std::size_t _size;
 };
 
-template<typename T>
-BinarySearchTree<T>::Node::Node(const T& d, Node* l, Node* r) : data(d), left(l), right(r) {
+template<typename T, class Alloc>
+BinarySearchTree<T,Alloc>::Node::Node(const T& d, Node* l, Node* r) : data(d), left(l), right(r) {
+}
+
+template<typename T, class Alloc>
+BinarySearchTree<T,Alloc>::Node::Node(T&& rvr, Node* l, Node* r) : data(std::move(rvr)), left(l), right(r) {
 }
 
-template<typename T>
-BinarySearchTree<T>::Node::Node(T&& rvr, Node* l, Node* r) : data(std::move(rvr)), left(l), right(r) {
+template<typename T, class Alloc>
+BinarySearchTree<T,Alloc>::BinarySearchTree() : _node_alloc(), _root(nullptr), _size(0) {
 }
 
-template<typename T>
-BinarySearchTree<T>::BinarySearchTree() : _root(nullptr), _size(0) {
+template<typename T, class Alloc>
+BinarySearchTree<T,Alloc>::BinarySearchTree(const Alloc& alloc) : _node_alloc(alloc), _root(nullptr), _size(0) {
 }
 
-template<typename T>
-BinarySearchTree<T>::~BinarySearchTree() {
+template<typename T, class Alloc>
+BinarySearchTree<T,Alloc>::~BinarySearchTree() {
   clear();
 }
 
-template<typename T>
-typename BinarySearchTree<T>::Node** BinarySearchTree<T>::_get_node_for(const T& d) const {
+template<typename T, class Alloc>
+typename BinarySearchTree<T,Alloc>::Node** BinarySearchTree<T,Alloc>::_get_node_for(const T& d) const {
   // this will return either
   // (a) pointer to (a pointer to) node holding data "d"
   // (b) pointer to (a pointer to) node where "d" would be found if inserted
@@ -100,23 +118,23 @@ typename BinarySearchTree<T>::Node** BinarySearchTree<T>::_get_node_for(const T&
   return (Node**)ptr;
 }
 
-template<typename T>
-std::size_t BinarySearchTree<T>::height() const {
+template<typename T, class Alloc>
+std::size_t BinarySearchTree<T,Alloc>::height() const {
   return _node_height(_root);
 }
 
-template<typename T>
-std::size_t BinarySearchTree<T>::size() const {
+template<typename T, class Alloc>
+std::size_t BinarySearchTree<T,Alloc>::size() const {
   return _size;
 }
 
-template<typename T>
-std::size_t BinarySearchTree<T>::_node_height(Node* n) {
+template<typename T, class Alloc>
+std::size_t BinarySearchTree<T,Alloc>::_node_height(Node* n) {
   return (n == nullptr ? 0 : 1 + std::max(_node_height(n->left), _node_height(n->right)));
 }
 
-template<typename T>
-typename BinarySearchTree<T>::Node** BinarySearchTree<T>::_inorder_successor_of(Node *n) const {
+template<typename T, class Alloc>
+typename BinarySearchTree<T,Alloc>::Node** BinarySearchTree<T,Alloc>::_inorder_successor_of(Node *n) const {
   assert(n != nullptr);
 
   if (n->right != nullptr) {
@@ -144,36 +162,55 @@ typename BinarySearchTree<T>::Node** BinarySearchTree<T>::_inorder_successor_of(
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::clear() {
-  // delete nodes in post-order
-  // left, right, self
-  _visit_nodes_postorder(_root, [](Node* n) {
-    delete n;
-  });
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::clear() {
+  // with an arena and nothing to destroy, the nodes are simply dropped:
+  // their memory goes away with the arena
+  if(!is_monotonic_allocator<_node_alloc_type>::value ||
+     !std::is_trivially_destructible<T>::value) {
+    // delete nodes in post-order
+    // left, right, self
+    _visit_nodes_postorder(_root, [this](Node* n) {
+      _delete_node(n);
+    });
+  }
 
   _size = 0;
   _root = nullptr;
 }
 
-template<typename T>
-bool BinarySearchTree<T>::empty() const {
+template<typename T, class Alloc>
+template<typename... Args>
+typename BinarySearchTree<T,Alloc>::Node* BinarySearchTree<T,Alloc>::_new_node(Args&&... args) {
+  Node* n = _node_traits::allocate(_node_alloc, 1);
+  _node_traits::construct(_node_alloc, n, std::forward<Args>(args)...);
+  return n;
+}
+
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::_delete_node(Node* n) {
+  _node_traits::destroy(_node_alloc, n);
+  _node_traits::deallocate(_node_alloc, n, 1);
+}
+
+template<typename T, class Alloc>
+bool BinarySearchTree<T,Alloc>::empty() const {
   return size() == 0;
 }
 
-template<typename T>
-void BinarySearchTree<T>::print() const {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::print() const {
   visit_inorder([](const T& e) { std::cout << e << " "; });
 }
 
-template<typename T>
-bool BinarySearchTree<T>::find(const T& o) const {
+template<typename T, class Alloc>
+bool BinarySearchTree<T,Alloc>::find(const T& o) const {
   Node** nptr = _get_node_for(o);
   return (*nptr != nullptr);
 }
 
-template<typename T>
-void BinarySearchTree<T>::insert(T&& d) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::insert(T&& d) {
   Node** nptr = _get_node_for(d);
   Node* n = *nptr;
 
@@ -181,18 +218,18 @@ void BinarySearchTree<T>::insert(T&& d) {
   // because we don't allow duplicates, otherwise
   // nptr points to the child of a leaf (&leaf->left) or (&leaf->right)
   if (n == nullptr) {
-    *nptr = new Node(std::move(d));
+    *nptr = _new_node(std::move(d));
     _size++;
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::insert(const T& d) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::insert(const T& d) {
   insert(std::move(T{d}));
 }
 
-template<typename T>
-bool BinarySearchTree<T>::remove(const T& d) {
+template<typename T, class Alloc>
+bool BinarySearchTree<T,Alloc>::remove(const T& d) {
   Node** nptr = _get_node_for(d);
   Node* n = *nptr;
 
@@ -205,22 +242,22 @@ bool BinarySearchTree<T>::remove(const T& d) {
   return false;
 }
 
-template<typename T>
-void BinarySearchTree<T>::_remove_node(Node** nptr) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::_remove_node(Node** nptr) {
   Node* n = *nptr;
 
   if (n->left == nullptr && n->right == nullptr) {
     // leaf case
-    delete n;
+    _delete_node(n);
     *nptr = nullptr;
   } else if (n->left != nullptr && n->right == nullptr) {
     // one child case (left)
     *nptr = n->left;
-    delete n;
+    _delete_node(n);
   } else if (n->right != nullptr && n->left == nullptr) {
     // one child case (right)
     *nptr = n->right;
-    delete n;
+    _delete_node(n);
   } else {
     // two children case
     // suc will have at most one (right) child, therefore the removal
@@ -231,8 +268,8 @@ void BinarySearchTree<T>::_remove_node(Node** nptr) {
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::_visit_nodes_bfs(Node* n, std::function<void(Node*)> f) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::_visit_nodes_bfs(Node* n, std::function<void(Node*)> f) {
   if (n != nullptr) {
     std::queue<Node*> q;
     q.push(n);
@@ -248,8 +285,8 @@ void BinarySearchTree<T>::_visit_nodes_bfs(Node* n, std::function<void(Node*)> f
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::_visit_nodes_inorder(Node* n, std::function<void(Node*)> f) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::_visit_nodes_inorder(Node* n, std::function<void(Node*)> f) {
   if (n != nullptr) {
     _visit_nodes_inorder(n->left, f);
     f(n);
@@ -257,8 +294,8 @@ void BinarySearchTree<T>::_visit_nodes_inorder(Node* n, std::function<void(Node*
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::_visit_nodes_preorder(Node* n, std::function<void(Node*)> f) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::_visit_nodes_preorder(Node* n, std::function<void(Node*)> f) {
   if (n != nullptr) {
     f(n);
     _visit_nodes_preorder(n->left, f);
@@ -266,8 +303,8 @@ void BinarySearchTree<T>::_visit_nodes_preorder(Node* n, std::function<void(Node
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::_visit_nodes_postorder(Node* n, std::function<void(Node*)> f) {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::_visit_nodes_postorder(Node* n, std::function<void(Node*)> f) {
   if (n != nullptr) {
     _visit_nodes_postorder(n->left, f);
     _visit_nodes_postorder(n->right, f);
@@ -275,28 +312,28 @@ void BinarySearchTree<T>::_visit_nodes_postorder(Node* n, std::function<void(Nod
   }
 }
 
-template<typename T>
-void BinarySearchTree<T>::visit_bfs(std::function<void(const T&)> f) const {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::visit_bfs(std::function<void(const T&)> f) const {
   _visit_nodes_bfs(_root, [f](Node* n) { f(n->data); });
 }
 
-template<typename T>
-void BinarySearchTree<T>::visit_preorder(std::function<void(const T&)> f) const {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::visit_preorder(std::function<void(const T&)> f) const {
   _visit_nodes_preorder(_root, [f](Node* n) { f(n->data); });
 }
 
-template<typename T>
-void BinarySearchTree<T>::visit_inorder(std::function<void(const T&)> f) const {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::visit_inorder(std::function<void(const T&)> f) const {
   _visit_nodes_inorder(_root, [f](Node* n) { f(n->data); });
 }
 
-template<typename T>
-void BinarySearchTree<T>::visit_postorder(std::function<void(const T&)> f) const {
+template<typename T, class Alloc>
+void BinarySearchTree<T,Alloc>::visit_postorder(std::function<void(const T&)> f) const {
   _visit_nodes_postorder(_root, [f](Node* n) { f(n->data); });
 }
 
-template<typename T>
-const T& BinarySearchTree<T>::inorder_successor_of(const T& d) const {
+template<typename T, class Alloc>
+const T& BinarySearchTree<T,Alloc>::inorder_successor_of(const T& d) const {
   Node** nptr = _get_node_for(d);
   assert(*nptr != nullptr);
   nptr = _inorder_successor_of(*nptr);
@@ -0,0 +1,208 @@
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "vector.h"
+#include "../bench_helpers.h"
+
+// an element type whose default constructor is not free
+struct Heavy {
+  Heavy() : _value(0) {
+    default_constructions++;
+    std::fill(_payload, _payload + 32, 0);
+  }
+  Heavy(int v) : _value(v) {
+    std::fill(_payload, _payload + 32, v);
+  }
+  Heavy(const Heavy& o) = default;
+  Heavy& operator=(const Heavy& o) = default;
+
+  static std::size_t default_constructions;
+
+private:
+  int _value;
+  int _payload[32];
+};
+
+std::size_t Heavy::default_constructions = 0;
+
+// the growth strategy Vector used before switching to raw storage:
+// every reallocation default-constructs the whole new capacity
+template<typename T>
+class ArrayNewVector {
+public:
+  ArrayNewVector() : _arr(new T[1]), _size(0), _capacity(1) { }
+  ~ArrayNewVector() { delete[] _arr; }
+
+  void push_back(const T& e) {
+    if(_size >= _capacity) {
+      T* newarr = new T[_capacity * 2];
+      std::move(_arr, _arr + _size, newarr);
+      delete[] _arr;
+      _arr = newarr;
+      _capacity *= 2;
+    }
+    _arr[_size++] = e;
+  }
+
+private:
+  T* _arr;
+  std::size_t _size;
+  std::size_t _capacity;
+};
+
+template<class V>
+void push_n(std::size_t n) {
+  V v;
+  for(std::size_t i = 0; i < n; ++i) {
+    v.push_back(Heavy((int)i));
+  }
+  bench_keep(v);
+}
+
+// std::allocator that counts how many times storage was (re)allocated
+template<typename T>
+struct CountingAllocator : std::allocator<T> {
+  template<typename U>
+  struct rebind {
+    typedef CountingAllocator<U> other;
+  };
+
+  CountingAllocator() = default;
+  template<typename U>
+  CountingAllocator(const CountingAllocator<U>&) { }
+
+  T* allocate(std::size_t n) {
+    allocations++;
+    return std::allocator<T>::allocate(n);
+  }
+
+  static std::size_t allocations;
+};
+
+template<typename T>
+std::size_t CountingAllocator<T>::allocations = 0;
+
+// grows to high, drains to low, over and over
+template<class Growth>
+void oscillate(std::size_t low, std::size_t high, std::size_t cycles) {
+  Vector<int, CountingAllocator<int>, Growth> v;
+  for(std::size_t c = 0; c < cycles; ++c) {
+    while(v.size() < high) {
+      v.push_back((int)c);
+    }
+    while(v.size() > low) {
+      v.pop_back();
+    }
+  }
+  bench_keep(v);
+}
+
+template<class Growth>
+void bench_oscillate(const BenchHelper& bh, const char* name, std::size_t low, std::size_t high, std::size_t cycles) {
+  // every run starts the count over, what is left is the last run's
+  bh.run(name, [=] {
+    CountingAllocator<int>::allocations = 0;
+    oscillate<Growth>(low, high, cycles);
+  });
+  bh.report("  reallocations per run", CountingAllocator<int>::allocations);
+}
+
+// looks up values that are mostly absent, so every search scans the array
+template<typename T>
+void bench_find(const BenchHelper& bh, const char* scalar_name, const char* simd_name) {
+  Vector<T> v;
+  for(std::size_t i = 0; i < 4096; ++i) {
+    v.push_back((T)(i * 3));
+  }
+  const std::size_t lookups = 20000;
+
+  bh.run(scalar_name, [&] {
+    std::size_t found = 0;
+    for(std::size_t i = 0; i < lookups; ++i) {
+      found += std::find(v.begin(), v.end(), (T)(i * 7 + 1)) != v.end();
+    }
+    bench_keep(found);
+  });
+  bh.run(simd_name, [&] {
+    std::size_t found = 0;
+    for(std::size_t i = 0; i < lookups; ++i) {
+      found += v.contains((T)(i * 7 + 1));
+    }
+    bench_keep(found);
+  });
+}
+
+// garbage-collection sweep: drops every other element of a fresh vector
+template<class Sweep>
+void bench_sweep(const BenchHelper& bh, const char* name, std::size_t n, Sweep sweep) {
+  bh.run(name, [=] {
+    Vector<int> v;
+    v.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+      v.push_back((int)i);
+    }
+    sweep(v);
+    bench_keep(v.size());
+  });
+}
+
+int main(int argc, char const *argv[]) {
+  BenchHelper bh;
+  const std::size_t n = 1 << 20;
+
+  std::cout << "\n[[ push_back of " << n << " Heavy elements ]]" << std::endl << std::endl;
+
+  Heavy::default_constructions = 0;
+  bh.run("new T[] growth (before)", [n] { push_n<ArrayNewVector<Heavy>>(n); });
+  bh.report("  default constructions per run", Heavy::default_constructions / 5);
+
+  Heavy::default_constructions = 0;
+  bh.run("Vector raw storage (after)", [n] { push_n<Vector<Heavy>>(n); });
+  bh.report("  default constructions per run", Heavy::default_constructions / 5);
+
+  Heavy::default_constructions = 0;
+  bh.run("std::vector (reference)", [n] { push_n<std::vector<Heavy>>(n); });
+  bh.report("  default constructions per run", Heavy::default_constructions / 5);
+
+  std::cout << "\n[[ push/pop oscillating between 0 and 4096, 2000 cycles ]]" << std::endl << std::endl;
+  bench_oscillate<DoublingGrowth>(bh, "2x, shrink at 1/4", 0, 4096, 2000);
+  bench_oscillate<OneAndAHalfGrowth>(bh, "1.5x, shrink at 4/9", 0, 4096, 2000);
+  bench_oscillate<NeverShrinkGrowth>(bh, "2x, never shrink", 0, 4096, 2000);
+
+  std::cout << "\n[[ push/pop oscillating between 200 and 1100, 20000 cycles ]]" << std::endl << std::endl;
+  bench_oscillate<DoublingGrowth>(bh, "2x, shrink at 1/4", 200, 1100, 20000);
+  bench_oscillate<OneAndAHalfGrowth>(bh, "1.5x, shrink at 4/9", 200, 1100, 20000);
+  bench_oscillate<NeverShrinkGrowth>(bh, "2x, never shrink", 200, 1100, 20000);
+
+  std::cout << "\n[[ 20000 mostly missing lookups in 4096 elements ]]" << std::endl << std::endl;
+  bench_find<int>(bh, "std::find, int", "Vector::contains, int");
+  bench_find<std::uint64_t>(bh, "std::find, uint64_t", "Vector::contains, uint64_t");
+
+  const std::size_t dead = 100000;
+  std::cout << "\n[[ sweep of the odd elements out of " << dead << " ]]" << std::endl << std::endl;
+  bench_sweep(bh, "erase(i) per element (before)", dead, [](Vector<int>& v) {
+    for(std::size_t i = 0; i < v.size(); ) {
+      if(v[i] % 2 == 1) {
+        v.erase(i);
+      } else {
+        ++i;
+      }
+    }
+  });
+  bench_sweep(bh, "erase_if (after)", dead, [](Vector<int>& v) {
+    v.erase_if([](int e) { return e % 2 == 1; });
+  });
+  bench_sweep(bh, "swap_erase per element (unordered)", dead, [](Vector<int>& v) {
+    for(std::size_t i = 0; i < v.size(); ) {
+      if(v[i] % 2 == 1) {
+        v.swap_erase(i);
+      } else {
+        ++i;
+      }
+    }
+  });
+
+  return 0;
+}
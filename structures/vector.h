@@ -5,22 +5,87 @@
 #include <cassert>
 #include <algorithm>
 #include <memory>
+#include <iterator>
+#include <utility>
 #include <initializer_list>
 #include <vector>
+#include "simd.h"
+
+// Growth policies for Vector: grow(capacity) is the capacity to move to
+// when the storage is full, shrink(size, capacity) the capacity to move to
+// after a removal (returning capacity itself keeps the storage).
+// Growing by a factor f = Num/Den and shrinking by the same factor once
+// size drops below capacity/f^2 keeps a gap between both thresholds, so
+// pushes and pops stay O(1) amortized; for f = 2 this is the classic
+// "halve when a quarter full"
+template<std::size_t Num = 2, std::size_t Den = 1, bool Shrink = true>
+struct VectorGrowth {
+  static_assert(Num > Den, "Growth factor must be bigger than 1");
+
+  static std::size_t grow(std::size_t capacity) {
+    return std::max<std::size_t>(capacity * Num / Den, capacity + 1);
+  }
+
+  static std::size_t shrink(std::size_t size, std::size_t capacity) {
+    if(Shrink && size < capacity * Den * Den / (Num * Num)) {
+      return capacity * Den / Num;
+    }
+    return capacity;
+  }
+};
+
+typedef VectorGrowth<2, 1> DoublingGrowth;
+typedef VectorGrowth<3, 2> OneAndAHalfGrowth;
+// only grows; memory is given back explicitly with shrink_to_fit()
+typedef VectorGrowth<2, 1, false> NeverShrinkGrowth;
+
+// Storage policies say where a capacity lives: allocate(alloc, n) hands out
+// room for n elements, deallocate(alloc, p, n) takes it back and no
+// capacity goes below min_capacity(). Vector keeps everything on the heap
+template<typename T, class Alloc>
+struct _HeapStorage {
+  typedef std::allocator_traits<Alloc> _traits;
+
+  static std::size_t min_capacity() {
+    return 0;
+  }
 
-template<typename T>
-class Vector {
+  T* allocate(Alloc& alloc, std::size_t n) {
+    return n > 0 ? _traits::allocate(alloc, n) : nullptr;
+  }
+
+  void deallocate(Alloc& alloc, T* p, std::size_t n) {
+    if(p != nullptr) {
+      _traits::deallocate(alloc, p, n);
+    }
+  }
+};
+
+// the part of Vector and SmallVector that does not depend on where the
+// elements live: growth, insertion, removal and search over the contiguous
+// array [_arr, _arr + _capacity). Constructors and assignments are left to
+// the containers, which know how their storage may change hands
+template<typename T, class Alloc, class Growth, class Storage>
+class _VectorBase : protected Storage {
 public:
-  Vector(); // O(1)
-  Vector(const Vector& v); // O(n)
-  Vector(Vector&& rvr); // O(1)
-  Vector(std::initializer_list<T> l); // O(n)
-  Vector& operator=(const Vector& v); // O(n)
-  Vector& operator=(Vector&& rvr); // O(1)
-  virtual ~Vector(); // O(n)
+  typedef Alloc allocator_type;
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  // storage is contiguous, so plain pointers are the (random access) iterators
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  _VectorBase& operator=(const _VectorBase&) = delete;
+  virtual ~_VectorBase(); // O(n)
 
   std::size_t capacity() const; // O(1)
   std::size_t reserve(std::size_t new_capacity); // O(new_capacity)
+  std::size_t shrink_to_fit(); // O(n)
 
   std::size_t size() const; // O(1)
   std::size_t resize(std::size_t new_size); // O(new_size)
@@ -32,133 +97,365 @@ public:
   const T& operator[](std::size_t i) const; // O(1)
   T& back(); // O(1)
   const T& back() const; // O(1)
+  T* data(); // O(1)
+  const T* data() const; // O(1)
+
+  iterator begin(); // O(1)
+  iterator end(); // O(1)
+  const_iterator begin() const; // O(1)
+  const_iterator end() const; // O(1)
+  const_iterator cbegin() const; // O(1)
+  const_iterator cend() const; // O(1)
   std::size_t find(const T& e) const; // O(n)
+  std::size_t count(const T& e) const; // O(n)
+  bool contains(const T& e) const; // O(n)
 
   void push_back(const T& e); // worst case O(n), amortized O(1)
+  void push_back(T&& e); // worst case O(n), amortized O(1)
   void insert(std::size_t i, const T& e); // worst case O(n), amortized O(1)
+  void insert(std::size_t i, T&& e); // worst case O(n), amortized O(1)
+  template<typename... Args>
+  T& emplace_back(Args&&... args); // worst case O(n), amortized O(1)
+  template<typename... Args>
+  T& emplace(std::size_t i, Args&&... args); // worst case O(n), amortized O(1)
   T pop_back(); // worst case O(n), amortized O(1)
   T erase(std::size_t i); // worst case O(n), amortized O(1)
+  std::size_t erase(std::size_t first, std::size_t last); // O(n)
+  template<class Pred>
+  std::size_t erase_if(Pred pred); // O(n)
+  T swap_erase(std::size_t i); // worst case O(n), amortized O(1)
   std::size_t remove(const T& e); // worst case O(n), amortized O(1)
 
   std::vector<T> to_std_vector() const; // O(n)
-
-private:
+  Alloc get_allocator() const; // O(1)
+
+protected:
+  typedef std::allocator_traits<Alloc> _traits;
+
+  _VectorBase(const Alloc& alloc, std::size_t capacity); // O(1)
+  _VectorBase(std::initializer_list<T> l, const Alloc& alloc, std::size_t capacity); // O(n)
+  _VectorBase(const _VectorBase& v); // O(n)
+
+  T* _allocate(std::size_t n);
+  void _deallocate(T* p, std::size_t n);
+  void _destroy(T* first, T* last);
+  template<typename It>
+  void _construct_from(It first, It last, T* dest);
+  void _reallocate(std::size_t new_capacity);
+  void _shrink(std::size_t new_capacity);
+  void _truncate(std::size_t new_size);
+
+protected:
+  Alloc _alloc;
   T* _arr;
   std::size_t _size;
   std::size_t _capacity;
 };
 
-template<typename T>
-Vector<T>::Vector() : _arr(new T[1]), _size(0), _capacity(1) {
+template<typename T, class Alloc = std::allocator<T>, class Growth = DoublingGrowth>
+class Vector : public _VectorBase<T, Alloc, Growth, _HeapStorage<T, Alloc>> {
+public:
+  Vector(); // O(1)
+  explicit Vector(const Alloc& alloc); // O(1)
+  Vector(const Vector& v); // O(n)
+  Vector(Vector&& rvr); // O(1)
+  Vector(std::initializer_list<T> l, const Alloc& alloc = Alloc()); // O(n)
+  Vector& operator=(const Vector& v); // O(n)
+  Vector& operator=(Vector&& rvr); // O(1)
+
+private:
+  typedef _VectorBase<T, Alloc, Growth, _HeapStorage<T, Alloc>> _base;
+};
+
+template<typename T, class Alloc, class Growth, class Storage>
+_VectorBase<T,Alloc,Growth,Storage>::_VectorBase(const Alloc& alloc, std::size_t capacity) :
+_alloc(alloc), _arr(_allocate(capacity)), _size(0), _capacity(capacity) {
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+_VectorBase<T,Alloc,Growth,Storage>::_VectorBase(std::initializer_list<T> l, const Alloc& alloc, std::size_t capacity) :
+_alloc(alloc), _arr(_allocate(capacity)), _size(l.size()), _capacity(capacity) {
+  assert(capacity >= l.size());
+  // no destructor runs for a constructor that throws
+  try {
+    _construct_from(l.begin(), l.end(), _arr);
+  } catch(...) {
+    _deallocate(_arr, _capacity);
+    throw;
+  }
+}
+
+// the storage itself is not copied, only the elements
+template<typename T, class Alloc, class Growth, class Storage>
+_VectorBase<T,Alloc,Growth,Storage>::_VectorBase(const _VectorBase& v) : Storage(),
+_alloc(_traits::select_on_container_copy_construction(v._alloc)),
+_arr(_allocate(v._capacity)), _size(v._size), _capacity(v._capacity) {
+  try {
+    _construct_from(v._arr, v._arr + v._size, _arr);
+  } catch(...) {
+    _deallocate(_arr, _capacity);
+    throw;
+  }
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+_VectorBase<T,Alloc,Growth,Storage>::~_VectorBase() {
+  _destroy(_arr, _arr + _size);
+  _deallocate(_arr, _capacity);
+}
+
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>::Vector() : _base(Alloc(), 1) {
 }
 
-#include <iostream>
-template<typename T>
-Vector<T>::Vector(std::initializer_list<T> l) : _arr(new T[l.size()]),
-_size(l.size()), _capacity(l.size()) {
-  // size will be > 0 (and therefore capacity) because of
-  // http://en.cppreference.com/w/cpp/language/list_initialization
-  // "If the braced-init-list is empty and T is a class type with a
-  // default constructor, value-initialization is performed."
-  std::copy(l.begin(), l.end(), _arr);
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>::Vector(const Alloc& alloc) : _base(alloc, 1) {
 }
 
-template<typename T>
-Vector<T>::Vector(const Vector& v) : _arr(new T[v._capacity]), _size(v._size), _capacity(v._capacity) {
-  std::copy(v._arr, v._arr + v._size, _arr);
+// size will be > 0 (and therefore capacity) because of
+// http://en.cppreference.com/w/cpp/language/list_initialization
+// "If the braced-init-list is empty and T is a class type with a
+// default constructor, value-initialization is performed."
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>::Vector(std::initializer_list<T> l, const Alloc& alloc) : _base(l, alloc, l.size()) {
 }
 
-template<typename T>
-Vector<T>::Vector(Vector&& rvr) : _arr(rvr._arr), _size(rvr._size), _capacity(rvr._capacity) {
-  rvr._arr = new T[1];
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>::Vector(const Vector& v) : _base(v) {
+}
+
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>::Vector(Vector&& rvr) : _base(rvr._alloc, 0) {
+  this->_arr = rvr._arr;
+  this->_size = rvr._size;
+  this->_capacity = rvr._capacity;
+  rvr._arr = rvr._allocate(1);
   rvr._size = 0;
   rvr._capacity = 1;
 }
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(const Vector& v) {
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>& Vector<T,Alloc,Growth>::operator=(const Vector& v) {
   // correctly handles self-assignment
-  T* newarr = new T[v._capacity];
-  std::copy(v._arr, v._arr + v._size, newarr);
-  delete[] _arr;
-  _arr = newarr;
-  _size = v._size;
-  _capacity = v._capacity;
+  T* newarr = this->_allocate(v._capacity);
+  try {
+    this->_construct_from(v._arr, v._arr + v._size, newarr);
+  } catch(...) {
+    this->_deallocate(newarr, v._capacity);
+    throw;
+  }
+  this->_destroy(this->_arr, this->_arr + this->_size);
+  this->_deallocate(this->_arr, this->_capacity);
+  this->_arr = newarr;
+  this->_size = v._size;
+  this->_capacity = v._capacity;
   return *this;
 }
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(Vector&& rvr) {
+template<typename T, class Alloc, class Growth>
+Vector<T,Alloc,Growth>& Vector<T,Alloc,Growth>::operator=(Vector&& rvr) {
   // correctly handles self-assignment
   if(this != &rvr) {
-    _arr = rvr._arr;
-    _size = rvr._size;
-    _capacity = rvr._capacity;
-    rvr._arr = new T[1];
+    if(this->_alloc != rvr._alloc) {
+      // storage from another allocator cannot change hands,
+      // fall back to moving element by element
+      T* newarr = this->_allocate(rvr._capacity);
+      try {
+        this->_construct_from(
+          std::make_move_iterator(rvr._arr),
+          std::make_move_iterator(rvr._arr + rvr._size),
+          newarr
+        );
+      } catch(...) {
+        this->_deallocate(newarr, rvr._capacity);
+        throw;
+      }
+      this->_destroy(this->_arr, this->_arr + this->_size);
+      this->_deallocate(this->_arr, this->_capacity);
+      this->_arr = newarr;
+      this->_size = rvr._size;
+      this->_capacity = rvr._capacity;
+      return *this;
+    }
+    this->_destroy(this->_arr, this->_arr + this->_size);
+    this->_deallocate(this->_arr, this->_capacity);
+    this->_arr = rvr._arr;
+    this->_size = rvr._size;
+    this->_capacity = rvr._capacity;
+    rvr._arr = rvr._allocate(1);
     rvr._size = 0;
     rvr._capacity = 1;
   }
   return *this;
 }
 
-template<typename T>
-Vector<T>::~Vector() {
-  delete[] _arr;
+// storage is allocated uninitialized: elements in [0, size()) are alive,
+// slots in [size(), capacity()) are raw memory and must never be read,
+// assigned to or destroyed
+template<typename T, class Alloc, class Growth, class Storage>
+T* _VectorBase<T,Alloc,Growth,Storage>::_allocate(std::size_t n) {
+  return Storage::allocate(_alloc, n);
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::_deallocate(T* p, std::size_t n) {
+  Storage::deallocate(_alloc, p, n);
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::_destroy(T* first, T* last) {
+  for(; first != last; ++first) {
+    _traits::destroy(_alloc, first);
+  }
+}
+
+// copy- or move-constructs [first, last) into raw memory at dest; if a
+// constructor throws, the elements built so far are destroyed again
+template<typename T, class Alloc, class Growth, class Storage>
+template<typename It>
+void _VectorBase<T,Alloc,Growth,Storage>::_construct_from(It first, It last, T* dest) {
+  T* const start = dest;
+  try {
+    for(; first != last; ++first, ++dest) {
+      _traits::construct(_alloc, dest, *first);
+    }
+  } catch(...) {
+    _destroy(start, dest);
+    throw;
+  }
+}
+
+// moves the live elements into fresh storage of the given capacity (never
+// less than the storage minimum), the caller guarantees new_capacity >= size()
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::_reallocate(std::size_t new_capacity) {
+  assert(new_capacity >= size());
+  new_capacity = std::max(new_capacity, Storage::min_capacity());
+  T* newarr = _allocate(new_capacity);
+  if(newarr == _arr) {
+    // the storage already holds exactly this capacity, nothing to move
+    return;
+  }
+  try {
+    _construct_from(
+      std::make_move_iterator(_arr),
+      std::make_move_iterator(_arr + size()),
+      newarr
+    );
+  } catch(...) {
+    _deallocate(newarr, new_capacity);
+    throw;
+  }
+  _destroy(_arr, _arr + size());
+  _deallocate(_arr, _capacity);
+  _arr = newarr;
+  _capacity = new_capacity;
 }
 
-template<typename T>
-std::size_t Vector<T>::size() const {
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::size() const {
   return _size;
 }
 
-template<typename T>
-std::size_t Vector<T>::capacity() const {
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::capacity() const {
   return _capacity;
 }
 
-template<typename T>
-bool Vector<T>::empty() const {
+template<typename T, class Alloc, class Growth, class Storage>
+bool _VectorBase<T,Alloc,Growth,Storage>::empty() const {
   return size() == 0;
 }
 
-template<typename T>
-T& Vector<T>::at(std::size_t i) {
+template<typename T, class Alloc, class Growth, class Storage>
+T& _VectorBase<T,Alloc,Growth,Storage>::at(std::size_t i) {
   return _arr[i];
 }
 
-template<typename T>
-const T& Vector<T>::at(std::size_t i) const {
+template<typename T, class Alloc, class Growth, class Storage>
+const T& _VectorBase<T,Alloc,Growth,Storage>::at(std::size_t i) const {
   return _arr[i];
 }
 
-template<typename T>
-const T& Vector<T>::back() const {
+template<typename T, class Alloc, class Growth, class Storage>
+T& _VectorBase<T,Alloc,Growth,Storage>::back() {
+  return _arr[size() - 1];
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+const T& _VectorBase<T,Alloc,Growth,Storage>::back() const {
   return _arr[size() - 1];
 }
 
-template<typename T>
-const T& Vector<T>::operator[](std::size_t i) const {
+template<typename T, class Alloc, class Growth, class Storage>
+T* _VectorBase<T,Alloc,Growth,Storage>::data() {
+  return _arr;
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+const T* _VectorBase<T,Alloc,Growth,Storage>::data() const {
+  return _arr;
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+typename _VectorBase<T,Alloc,Growth,Storage>::iterator _VectorBase<T,Alloc,Growth,Storage>::begin() {
+  return _arr;
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+typename _VectorBase<T,Alloc,Growth,Storage>::iterator _VectorBase<T,Alloc,Growth,Storage>::end() {
+  return _arr + size();
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+typename _VectorBase<T,Alloc,Growth,Storage>::const_iterator _VectorBase<T,Alloc,Growth,Storage>::begin() const {
+  return _arr;
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+typename _VectorBase<T,Alloc,Growth,Storage>::const_iterator _VectorBase<T,Alloc,Growth,Storage>::end() const {
+  return _arr + size();
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+typename _VectorBase<T,Alloc,Growth,Storage>::const_iterator _VectorBase<T,Alloc,Growth,Storage>::cbegin() const {
+  return begin();
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+typename _VectorBase<T,Alloc,Growth,Storage>::const_iterator _VectorBase<T,Alloc,Growth,Storage>::cend() const {
+  return end();
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+const T& _VectorBase<T,Alloc,Growth,Storage>::operator[](std::size_t i) const {
   return at(i);
 }
 
-template<typename T>
-T& Vector<T>::operator[](std::size_t i) {
+template<typename T, class Alloc, class Growth, class Storage>
+T& _VectorBase<T,Alloc,Growth,Storage>::operator[](std::size_t i) {
   return at(i);
 }
 
 // "resizes the capacity of the vector"
-template<typename T>
-std::size_t Vector<T>::reserve(std::size_t new_capacity) {
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::reserve(std::size_t new_capacity) {
   // don't resize if new capacity cannot hold current elements
   if(new_capacity < size()) {
     return capacity();
   }
 
-  T* newarr = new T[new_capacity];
-  std::move(_arr, _arr + size(), newarr);
-  delete[] _arr;
-  _arr = newarr;
-  _capacity = new_capacity;
+  _reallocate(new_capacity);
+  return capacity();
+}
+
+// gives back the unused storage, capacity = size
+// (or the storage minimum if that is bigger)
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::shrink_to_fit() {
+  if(capacity() != std::max(size(), Storage::min_capacity())) {
+    _reallocate(size());
+  }
   return capacity();
 }
 
@@ -166,47 +463,111 @@ std::size_t Vector<T>::reserve(std::size_t new_capacity) {
 // if the new size is smaller than the current, the array is truncated,
 // if the new size is bigger than the current, new elements are allocated
 // using the default constructor of T
-template<typename T>
-std::size_t Vector<T>::resize(std::size_t new_size) {
-  T* newarr = new T[new_size];
-  std::move(_arr, _arr + std::min(new_size, _size), newarr);
-  delete[] _arr;
-  _arr = newarr;
-  _size = new_size;
-  _capacity = new_size;
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::resize(std::size_t new_size) {
+  if(new_size < size()) {
+    _destroy(_arr + new_size, _arr + size());
+    _size = new_size;
+  }
+  _reallocate(new_size);
+  for(; _size < new_size; ++_size) {
+    _traits::construct(_alloc, _arr + _size);
+  }
   return capacity();
 }
 
-template<typename T>
-void Vector<T>::insert(std::size_t i, const T& e) {
+template<typename T, class Alloc, class Growth, class Storage>
+template<typename... Args>
+T& _VectorBase<T,Alloc,Growth,Storage>::emplace(std::size_t i, Args&&... args) {
   assert(i <= size());
   if(size() >= capacity()) {
-    reserve(capacity() * 2);
-  }
-
-  // shift elements if inserting in the middle,
-  // inserting at the end (offset "size") is ok
-  // undefined behaviour if i > size or i < 0
-  if(i != size()) {
+    // build the new element straight into the new storage and move the
+    // old ones around it; args may refer to our own elements, so the old
+    // storage is only released afterwards
+    const std::size_t new_capacity = Growth::grow(capacity());
+    T* newarr = _allocate(new_capacity);
+    // if a constructor throws, what was built in newarr is torn down
+    // and this vector keeps its old storage
+    bool built_new = false, built_front = false;
+    try {
+      _traits::construct(_alloc, newarr + i, std::forward<Args>(args)...);
+      built_new = true;
+      _construct_from(
+        std::make_move_iterator(_arr),
+        std::make_move_iterator(_arr + i),
+        newarr
+      );
+      built_front = true;
+      _construct_from(
+        std::make_move_iterator(_arr + i),
+        std::make_move_iterator(_arr + size()),
+        newarr + i + 1
+      );
+    } catch(...) {
+      if(built_front) {
+        _destroy(newarr, newarr + i);
+      }
+      if(built_new) {
+        _traits::destroy(_alloc, newarr + i);
+      }
+      _deallocate(newarr, new_capacity);
+      throw;
+    }
+    _destroy(_arr, _arr + size());
+    _deallocate(_arr, _capacity);
+    _arr = newarr;
+    _capacity = new_capacity;
+  } else if(i == size()) {
+    // inserting at the end (offset "size") constructs in place
+    _traits::construct(_alloc, _arr + i, std::forward<Args>(args)...);
+  } else {
+    // shift elements if inserting in the middle; the new element is built
+    // first because args may refer to an element about to be shifted
+    T tmp(std::forward<Args>(args)...);
+    // the last element moves into raw memory, so it is constructed
+    // rather than assigned; the rest of the tail is shifted in place
+    _traits::construct(_alloc, _arr + size(), std::move(_arr[size() - 1]));
     std::move_backward(
       _arr + i,
-      _arr + size(),
-      _arr + size() + 1
+      _arr + size() - 1,
+      _arr + size()
     );
+    _arr[i] = std::move(tmp);
   }
 
-  _arr[i] = e;
   _size++;
+  return _arr[i];
 }
 
-template<typename T>
-void Vector<T>::push_back(const T& e) {
-  insert(size(), e);
+template<typename T, class Alloc, class Growth, class Storage>
+template<typename... Args>
+T& _VectorBase<T,Alloc,Growth,Storage>::emplace_back(Args&&... args) {
+  return emplace(size(), std::forward<Args>(args)...);
 }
 
-template<typename T>
-T Vector<T>::erase(std::size_t i) {
-  T ret = _arr[i];
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::insert(std::size_t i, const T& e) {
+  emplace(i, e);
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::insert(std::size_t i, T&& e) {
+  emplace(i, std::move(e));
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::push_back(const T& e) {
+  emplace(size(), e);
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::push_back(T&& e) {
+  emplace(size(), std::move(e));
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+T _VectorBase<T,Alloc,Growth,Storage>::erase(std::size_t i) {
+  T ret = std::move(_arr[i]);
 
   // shift elements if removing from the middle,
   // inserting at the end (offset "size") is ok
@@ -220,29 +581,100 @@ T Vector<T>::erase(std::size_t i) {
   }
 
   _size--;
-  // the shrinking threshold constant (1/4) should be strictly smaller than the
-  // shrinking and growing constant (1/2) for the operations
-  // to be O(1) amortized
-  if(size() < capacity() / 4) {
-    reserve(capacity() / 2);
-  }
+  _traits::destroy(_alloc, _arr + size());
+  // the shrinking threshold should be strictly smaller than the
+  // shrinking and growing constant for the operations
+  // to be O(1) amortized, see VectorGrowth
+  _shrink(Growth::shrink(size(), capacity()));
 
   return ret;
 }
 
-template<typename T>
-T Vector<T>::pop_back() {
+template<typename T, class Alloc, class Growth, class Storage>
+T _VectorBase<T,Alloc,Growth,Storage>::pop_back() {
   return erase(size() - 1);
 }
 
-template<typename T>
-std::size_t Vector<T>::find(const T& e) const {
-  auto ptr = std::find(_arr, _arr + size(), e);
-  return ptr - _arr;
+// removes [first, last) shifting the tail only once
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::erase(std::size_t first, std::size_t last) {
+  assert(first <= last && last <= size());
+  std::move(_arr + last, _arr + size(), _arr + first);
+  _truncate(size() - (last - first));
+  return last - first;
+}
+
+// removes every element matching pred in a single compacting pass,
+// the survivors keep their relative order
+template<typename T, class Alloc, class Growth, class Storage>
+template<class Pred>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::erase_if(Pred pred) {
+  T* new_end = std::remove_if(_arr, _arr + size(), pred);
+  const std::size_t removed = (_arr + size()) - new_end;
+  _truncate(new_end - _arr);
+  return removed;
+}
+
+// O(1) removal that does not keep the order: the last element takes
+// the place of the removed one
+template<typename T, class Alloc, class Growth, class Storage>
+T _VectorBase<T,Alloc,Growth,Storage>::swap_erase(std::size_t i) {
+  assert(i < size());
+  T ret = std::move(_arr[i]);
+  if(i != size() - 1) {
+    _arr[i] = std::move(_arr[size() - 1]);
+  }
+  _size--;
+  _traits::destroy(_alloc, _arr + size());
+  _shrink(Growth::shrink(size(), capacity()));
+  return ret;
 }
 
-template<typename T>
-std::size_t Vector<T>::remove(const T& e) {
+// moves to the capacity the shrink policy asked for, if the storage
+// minimum lets it
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::_shrink(std::size_t new_capacity) {
+  new_capacity = std::max(new_capacity, Storage::min_capacity());
+  if(new_capacity != capacity()) {
+    reserve(new_capacity);
+  }
+}
+
+// destroys the elements past new_size and applies the shrink policy as
+// many times as needed, so a batch removal reallocates at most once
+template<typename T, class Alloc, class Growth, class Storage>
+void _VectorBase<T,Alloc,Growth,Storage>::_truncate(std::size_t new_size) {
+  assert(new_size <= size());
+  _destroy(_arr + new_size, _arr + size());
+  _size = new_size;
+
+  std::size_t new_capacity = capacity();
+  for(std::size_t next = Growth::shrink(size(), new_capacity);
+      next != new_capacity;
+      next = Growth::shrink(size(), new_capacity)) {
+    new_capacity = next;
+  }
+  _shrink(new_capacity);
+}
+
+// arithmetic element types are searched with the SIMD kernels in simd.h
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::find(const T& e) const {
+  return simd_find(_arr, size(), e);
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::count(const T& e) const {
+  return simd_count(_arr, size(), e);
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+bool _VectorBase<T,Alloc,Growth,Storage>::contains(const T& e) const {
+  return find(e) != size();
+}
+
+template<typename T, class Alloc, class Growth, class Storage>
+std::size_t _VectorBase<T,Alloc,Growth,Storage>::remove(const T& e) {
   std::size_t loc = find(e);
   if(loc != size()) {
     erase(loc);
@@ -250,9 +682,14 @@ std::size_t Vector<T>::remove(const T& e) {
   return loc;
 }
 
-template<typename T>
-std::vector<T> Vector<T>::to_std_vector() const {
+template<typename T, class Alloc, class Growth, class Storage>
+std::vector<T> _VectorBase<T,Alloc,Growth,Storage>::to_std_vector() const {
   return std::vector<T>(_arr, _arr + size());
 }
 
+template<typename T, class Alloc, class Growth, class Storage>
+Alloc _VectorBase<T,Alloc,Growth,Storage>::get_allocator() const {
+  return _alloc;
+}
+
 #endif
@@ -2,9 +2,77 @@
 #include <vector>
 #include <cstdlib>
 #include <ctime>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
 #include "vector.h"
 #include "../test_helpers.h"
 
+// counts live instances and how they came to be
+struct Counted {
+  Counted() : value(0) { defaults++; alive++; }
+  Counted(int v) : value(v) { alive++; }
+  Counted(int a, int b) : value(a + b) { alive++; }
+  Counted(const Counted& o) : value(o.value) { copies++; alive++; }
+  Counted(Counted&& o) : value(o.value) { moves++; alive++; }
+  Counted& operator=(const Counted& o) { value = o.value; copies++; return *this; }
+  Counted& operator=(Counted&& o) { value = o.value; moves++; return *this; }
+  ~Counted() { alive--; }
+
+  static void reset() { defaults = 0; copies = 0; moves = 0; }
+
+  int value;
+  static int defaults;
+  static int copies;
+  static int moves;
+  static int alive;
+};
+
+int Counted::defaults = 0;
+int Counted::copies = 0;
+int Counted::moves = 0;
+int Counted::alive = 0;
+
+// copies and moves throw once throw_after more of them have been made
+struct Throwing {
+  Throwing(int v) : value(v) { alive++; }
+  Throwing(const Throwing& o) : value(o.value) { tick(); alive++; }
+  Throwing(Throwing&& o) : value(o.value) { tick(); alive++; }
+  Throwing& operator=(const Throwing& o) = default;
+  Throwing& operator=(Throwing&& o) = default;
+  ~Throwing() { alive--; }
+
+  static void tick() {
+    if(throw_after >= 0 && throw_after-- == 0) {
+      throw std::runtime_error("Throwing");
+    }
+  }
+
+  int value;
+  static int throw_after;
+  static int alive;
+};
+
+int Throwing::throw_after = -1;
+int Throwing::alive = 0;
+
+// counts the arrays handed out and not given back yet
+template<typename T>
+struct CountingAllocator {
+  typedef T value_type;
+  CountingAllocator() = default;
+  template<typename U>
+  CountingAllocator(const CountingAllocator<U>&) { }
+  T* allocate(std::size_t n) { outstanding++; return std::allocator<T>().allocate(n); }
+  void deallocate(T* p, std::size_t n) { outstanding--; std::allocator<T>().deallocate(p, n); }
+  bool operator==(const CountingAllocator&) const { return true; }
+  bool operator!=(const CountingAllocator&) const { return false; }
+  static int outstanding;
+};
+
+template<typename T>
+int CountingAllocator<T>::outstanding = 0;
+
 int main(int argc, char const *argv[]) {
   TestHelper th;
 
@@ -186,6 +254,277 @@ int main(int argc, char const *argv[]) {
     th.tassert(v.size(), (std::size_t)1, "Size is 1");
   }
 
+  {
+    Counted::reset();
+    Vector<Counted> v;
+    th.message("Reserve 64 on an empty vector");
+    v.reserve(64);
+    th.tassert();
+    th.tassert(Counted::defaults, 0, "No element was default-constructed");
+    th.tassert(Counted::alive, 0, "No element is alive");
+
+    th.message("Push 10 elements");
+    for(int i = 0; i < 10; ++i) {
+      v.push_back(Counted(i));
+    }
+    th.tassert();
+    th.tassert(Counted::defaults, 0, "No element was default-constructed");
+    th.tassert(Counted::alive, 10, "10 elements are alive");
+
+    th.message("Erase and pop");
+    v.erase(3);
+    v.pop_back();
+    th.tassert();
+    th.tassert(Counted::alive, 8, "Removed elements were destroyed");
+
+    th.message("Resize (grow) to 12");
+    v.resize(12);
+    th.tassert();
+    th.tassert(Counted::defaults, 4, "Only the 4 new elements were default-constructed");
+    th.tassert(Counted::alive, 12, "12 elements are alive");
+
+    th.message("Resize (shrink) to 5");
+    v.resize(5);
+    th.tassert();
+    th.tassert(Counted::alive, 5, "Truncated elements were destroyed");
+  }
+  th.tassert(Counted::alive, 0, "Destruction destroys every element");
+
+  {
+    typedef Vector<Throwing, CountingAllocator<Throwing>> vector_type;
+    vector_type v = {0, 1, 2, 3};
+    const Throwing e(9);
+    const int alive = Throwing::alive;
+    th.message("A throwing constructor while growing leaks nothing");
+    // every step of the growth path: the new element, the front, the back
+    bool clean = true;
+    for(int k = 0; k < 5; ++k) {
+      Throwing::throw_after = k;
+      try {
+        v.insert(2, e);
+        clean = false;
+      } catch(std::runtime_error&) {
+        clean = clean && v.size() == 4 && v.capacity() == 4;
+        clean = clean && Throwing::alive == alive;
+        clean = clean && CountingAllocator<Throwing>::outstanding == 1;
+      }
+    }
+    th.tassert();
+    th.tassert(clean, true, "Each failed insert destroyed and freed what it built");
+
+    th.message("A throwing constructor while copying leaks nothing");
+    bool thrown = false;
+    Throwing::throw_after = 2;
+    try {
+      vector_type w(v);
+    } catch(std::runtime_error&) {
+      thrown = true;
+    }
+    vector_type w = {7};
+    Throwing::throw_after = 2;
+    try {
+      w = v;
+    } catch(std::runtime_error&) {
+      thrown = thrown && w.size() == 1 && w[0].value == 7;
+    }
+    Throwing::throw_after = 2;
+    try {
+      v.reserve(16);
+    } catch(std::runtime_error&) {
+      thrown = thrown && v.capacity() == 4;
+    }
+    Throwing::throw_after = -1;
+    th.tassert();
+    th.tassert(thrown, true, "Copy construction, copy assignment and reserve threw");
+    th.tassert(Throwing::alive, alive + 1, "No element was left behind");
+    th.tassert(CountingAllocator<Throwing>::outstanding, 2, "No array was left behind");
+  }
+  th.tassert(Throwing::alive, 0, "Destruction destroys every element");
+
+  {
+    Counted::reset();
+    Vector<Counted> v;
+    th.message("emplace_back 20 elements (with reallocations)");
+    for(int i = 0; i < 20; ++i) {
+      v.emplace_back(i, 1);
+    }
+    th.tassert();
+    th.tassert(v.back().value, 20, "v.back() == 20");
+    th.tassert(Counted::copies, 0, "No copies");
+
+    th.message("push_back and insert of rvalues");
+    Counted c(100);
+    v.push_back(std::move(c));
+    v.insert(0, Counted(-1));
+    v.insert(10, Counted(50));
+    th.tassert();
+    th.tassert(v[0].value, -1, "v[0] == -1");
+    th.tassert(v[10].value, 50, "v[10] == 50");
+    th.tassert(v.back().value, 100, "v.back() == 100");
+    th.tassert(Counted::copies, 0, "No copies");
+
+    th.message("emplace in the middle");
+    Counted& e = v.emplace(5, 7, 7);
+    th.tassert();
+    th.tassert(e.value, 14, "Returned reference is the new element");
+    th.tassert(v[5].value, 14, "v[5] == 14");
+    th.tassert(Counted::copies, 0, "No copies");
+
+    th.message("erase and pop_back move the element out");
+    Counted erased = v.erase(5);
+    Counted popped = v.pop_back();
+    th.tassert();
+    th.tassert(erased.value, 14, "Erased element is 14");
+    th.tassert(popped.value, 100, "Popped element is 100");
+    th.tassert(Counted::copies, 0, "No copies");
+
+    th.message("push_back of an own element while reallocating");
+    v.resize(v.size());
+    v.push_back(v[0]);
+    th.tassert();
+    th.tassert(v.back().value, -1, "v.back() == v[0]");
+    th.tassert(Counted::copies, 1, "Exactly one copy");
+
+    th.message("insert of an own element in the middle");
+    v.insert(1, v[3]);
+    th.tassert();
+    th.tassert(v[1].value, v[4].value, "v[1] == old v[3]");
+  }
+  th.tassert(Counted::alive, 0, "Destruction destroys every element");
+
+  {
+    Vector<int> v = {5, 3, 9, 1, 7};
+    th.message("Iterators span the elements");
+    th.tassert();
+    th.tassert(v.end() - v.begin(), (std::ptrdiff_t)5, "end() - begin() == 5");
+    th.tassert(v.data() == &v[0], true, "data() points at v[0]");
+
+    th.message("Range-for");
+    int sum = 0;
+    for(int e : v) {
+      sum += e;
+    }
+    th.tassert();
+    th.tassert(sum, 25, "Sum is 25");
+    th.tassert(std::accumulate(v.cbegin(), v.cend(), 0), 25, "std::accumulate is 25");
+
+    th.message("std::sort in place");
+    std::sort(v.begin(), v.end());
+    th.tassert();
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 3, 5, 7, 9}, true, "STD vectors equal");
+    th.tassert(std::binary_search(v.begin(), v.end(), 7), true, "std::binary_search finds 7");
+
+    th.message("Writing through iterators");
+    for(auto& e : v) {
+      e *= 2;
+    }
+    th.tassert();
+    const Vector<int>& cv = v;
+    th.tassert(*(cv.end() - 1), 18, "Last element is 18");
+  }
+
+  {
+    Vector<int, std::allocator<int>, OneAndAHalfGrowth> v;
+    th.message("1.5x growth");
+    std::vector<std::size_t> capacities;
+    for(int i = 0; i < 10; ++i) {
+      v.push_back(i);
+      if(capacities.empty() || capacities.back() != v.capacity()) {
+        capacities.push_back(v.capacity());
+      }
+    }
+    th.tassert();
+    th.tassert(capacities == std::vector<std::size_t>{1, 2, 3, 4, 6, 9, 13}, true, "Capacities are 1, 2, 3, 4, 6, 9, 13");
+
+    th.message("1.5x shrink");
+    while(v.size() > 5) {
+      v.pop_back();
+    }
+    th.tassert(v.capacity(), (std::size_t)13, "Capacity is 13 with 5 elements");
+    v.pop_back();
+    th.tassert(v.capacity(), (std::size_t)8, "Capacity is 8 with 4 elements");
+  }
+
+  {
+    Vector<int, std::allocator<int>, NeverShrinkGrowth> v;
+    th.message("Never shrink");
+    for(int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+    while(!v.empty()) {
+      v.pop_back();
+    }
+    th.tassert();
+    th.tassert(v.capacity(), (std::size_t)128, "Capacity is still 128");
+
+    th.message("shrink_to_fit");
+    v.push_back(1);
+    v.push_back(2);
+    v.shrink_to_fit();
+    th.tassert();
+    th.tassert(v.capacity(), (std::size_t)2, "Capacity is 2");
+    th.tassert(v.to_std_vector() == std::vector<int>{1, 2}, true, "STD vectors equal");
+    v.pop_back();
+    v.pop_back();
+    v.shrink_to_fit();
+    th.tassert(v.capacity(), (std::size_t)0, "Capacity is 0 when empty");
+    v.push_back(3);
+    th.tassert(v.capacity(), (std::size_t)1, "Pushing after shrinking to 0 works");
+  }
+
+  {
+    Counted::reset();
+    Vector<Counted> v;
+    for(int i = 0; i < 16; ++i) {
+      v.emplace_back(i);
+    }
+    th.message("erase_if drops the odd elements");
+    std::size_t removed = v.erase_if([](const Counted& c) { return c.value % 2 == 1; });
+    th.tassert();
+    th.tassert(removed, (std::size_t)8, "8 elements removed");
+    th.tassert(v.size(), (std::size_t)8, "Size is 8");
+    th.tassert(v.capacity(), (std::size_t)16, "Capacity is 16");
+    th.tassert(v[0].value == 0 && v[3].value == 6 && v[7].value == 14, true, "Survivors keep their order");
+    th.tassert(Counted::alive, 8, "Removed elements were destroyed");
+    th.tassert(Counted::copies, 0, "No copies");
+
+    th.message("Range erase [1, 7)");
+    removed = v.erase(1, 7);
+    th.tassert();
+    th.tassert(removed, (std::size_t)6, "6 elements removed");
+    th.tassert(v.size(), (std::size_t)2, "Size is 2");
+    th.tassert(v[0].value == 0 && v[1].value == 14, true, "v == {0, 14}");
+    th.tassert(v.capacity(), (std::size_t)8, "Capacity shrinks from 16 to 8 at once");
+    th.tassert(Counted::alive, 2, "Removed elements were destroyed");
+
+    th.message("Empty range erase");
+    th.tassert(v.erase(1, 1), (std::size_t)0, "Nothing removed");
+    th.tassert(v.size(), (std::size_t)2, "Size is 2");
+  }
+  th.tassert(Counted::alive, 0, "Destruction destroys every element");
+
+  {
+    Vector<int> v = {1, 2, 3, 4, 5};
+    th.message("swap_erase the first element");
+    int e = v.swap_erase(0);
+    th.tassert();
+    th.tassert(e, 1, "Erased element is 1");
+    th.tassert(v.to_std_vector() == std::vector<int>{5, 2, 3, 4}, true, "Last element moved to the front");
+
+    th.message("swap_erase the last element");
+    e = v.swap_erase(3);
+    th.tassert();
+    th.tassert(e, 4, "Erased element is 4");
+    th.tassert(v.to_std_vector() == std::vector<int>{5, 2, 3}, true, "STD vectors equal");
+
+    th.message("erase_if everything");
+    v.erase_if([](int) { return true; });
+    th.tassert();
+    th.tassert(v.empty(), true, "Vector is empty");
+    v.push_back(9);
+    th.tassert(v[0], 9, "Pushing afterwards works");
+  }
+
   std::srand((unsigned int)std::time(0));
   {
     Vector<int> v;
@@ -230,6 +569,25 @@ int main(int argc, char const *argv[]) {
     th.tassert();
   }
 
+  {
+    Vector<int> v;
+    std::vector<int> stdv;
+    for(int i = 0; i < 5000; ++i) {
+      int r = std::rand() % 100;
+      v.push_back(r);
+      stdv.push_back(r);
+    }
+
+    th.message("Stress test erase_if");
+    for(int threshold = 90; threshold > 0; threshold -= 10) {
+      auto pred = [threshold](int e) { return e >= threshold; };
+      v.erase_if(pred);
+      stdv.erase(std::remove_if(stdv.begin(), stdv.end(), pred), stdv.end());
+      th.tassert(v.to_std_vector() == stdv, true, "Check complete vector", true);
+    }
+    th.tassert();
+  }
+
   th.summary();
   return 0;
 }